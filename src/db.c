@@ -0,0 +1,56 @@
+/**
+ * \file        db.c
+ * \brief       Integer conversion of energies to levels in centi-dB.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include "db.h"
+
+#define DB_CDB_PER_LOG2 19728302 ///< 1000*log10(2) in Q(DB_LOG2_Q)
+
+// log2(1 + i/32) in Q16, log2(2) = 65536 closes the last segment
+static const uint16_t db_log2_lut[1 << DB_LUT_BITS] = {
+        0,  2909,  5732,  8473, 11136, 13727, 16248, 18704,
+    21098, 23433, 25711, 27936, 30109, 32234, 34312, 36346,
+    38336, 40286, 42196, 44068, 45904, 47705, 49472, 51207,
+    52911, 54584, 56229, 57845, 59434, 60997, 62534, 64047
+};
+
+/**
+ * @brief Position of the leading one of a 64-bit value greater than 0.
+ * 
+ * @param e 
+ * @return int 
+ */
+static inline int db_msb(uint64_t e)
+{
+    uint32_t hi = (uint32_t)(e >> 32);
+    return hi ? 63 - __builtin_clz(hi) : 31 - __builtin_clz((uint32_t)e);
+}
+
+int32_t db_log2_q16(uint64_t e)
+{
+    int msb = db_msb(e);
+
+    ///< Normalize the mantissa to 16 bits after the leading one
+    uint32_t m = (msb >= 16) ? (uint32_t)(e >> (msb - 16)) : (uint32_t)(e << (16 - msb));
+    m &= 0xFFFF;
+
+    uint32_t i = m >> (16 - DB_LUT_BITS);
+    uint32_t frac = m & ((1u << (16 - DB_LUT_BITS)) - 1);
+    uint32_t lo = db_log2_lut[i];
+    uint32_t hi = (i + 1 < (1u << DB_LUT_BITS)) ? db_log2_lut[i + 1] : (1u << DB_LOG2_Q);
+    uint32_t f = lo + (((hi - lo)*frac + (1u << (15 - DB_LUT_BITS))) >> (16 - DB_LUT_BITS));
+
+    return ((int32_t)msb << DB_LOG2_Q) + (int32_t)f;
+}
+
+int32_t db_energy_cdb(uint64_t e)
+{
+    if (e == 0) return DB_FLOOR_CDB;
+    int64_t cdb = (int64_t)db_log2_q16(e)*DB_CDB_PER_LOG2;
+    return (int32_t)((cdb + (1LL << (2*DB_LOG2_Q - 1))) >> (2*DB_LOG2_Q));
+}
@@ -0,0 +1,61 @@
+/**
+ * \file        decimator.c
+ * \brief       Two stage decimator (CIC + FIR).
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+
+#include "decimator.h"
+
+// Low pass at 2.6 kHz for 12 kHz, the sum of the coefficients is 1 in Q15
+static const int16_t decim_fir_h[DECIM_FIR_TAPS] = {
+        7,   -12,  -105,   -25,   450,   432, -1115, -2071,  1854,  9868,
+    14202,
+     9868,  1854, -2071, -1115,   432,   450,   -25,  -105,   -12,     7
+};
+
+void decim_reset(decim_t *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+uint32_t decim_process(decim_t *d, const int32_t *in, uint32_t n, int32_t *out)
+{
+    uint32_t num_out = 0;
+    for (uint32_t i = 0; i < n; i++){
+        ///< Integrators at the input rate, the overflow is cancelled by the combs
+        int32_t acc = in[i];
+        for (int k = 0; k < DECIM_CIC_ORDER; k++){
+            d->integ[k] = (int32_t)((uint32_t)d->integ[k] + (uint32_t)acc);
+            acc = d->integ[k];
+        }
+        if (++d->cic_phase < DECIM_CIC_R) continue;
+        d->cic_phase = 0;
+
+        ///< Combs at the CIC output rate
+        for (int k = 0; k < DECIM_CIC_ORDER; k++){
+            int32_t prev = d->comb[k];
+            d->comb[k] = acc;
+            acc = (int32_t)((uint32_t)acc - (uint32_t)prev);
+        }
+
+        ///< FIR delay line
+        d->fir_pos = (d->fir_pos + 1) % DECIM_FIR_TAPS;
+        d->fir[d->fir_pos] = acc >> DECIM_CIC_SHIFT;
+        if (++d->fir_phase < DECIM_FIR_R) continue;
+        d->fir_phase = 0;
+
+        int32_t y = 0;
+        uint8_t pos = d->fir_pos;
+        for (int k = 0; k < DECIM_FIR_TAPS; k++){
+            y += decim_fir_h[k]*d->fir[pos];
+            pos = pos ? pos - 1 : DECIM_FIR_TAPS - 1;
+        }
+        out[num_out++] = y >> DECIM_FIR_Q;
+    }
+    return num_out;
+}
@@ -0,0 +1,62 @@
+/**
+ * \file        decimator.h
+ * \brief       Two stage decimator (CIC + FIR) for the consumers of the microphone signal that work
+ *              at a lower rate than the acquisition.
+ * \details     The first stage is a CIC filter of order DECIM_CIC_ORDER that decimates by DECIM_CIC_R,
+ *              the second one is a low pass FIR (Blackman windowed sinc) that decimates by DECIM_FIR_R.
+ *              At 48 kHz the output is at 6 kHz with a passband up to 2 kHz (-2.2 dB, CIC droop
+ *              included) and the aliases into the passband attenuated more than 40 dB. It works block by block,
+ *              only its state is kept between blocks.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __DECIMATOR_H__
+#define __DECIMATOR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DECIM_CIC_ORDER 3 ///< Number of integrator and comb stages.
+#define DECIM_CIC_R 4 ///< Decimation of the CIC stage.
+#define DECIM_CIC_SHIFT 6 ///< Gain of the CIC stage, log2(DECIM_CIC_R^DECIM_CIC_ORDER).
+#define DECIM_FIR_R 2 ///< Decimation of the FIR stage.
+#define DECIM_FIR_TAPS 21 ///< Number of taps of the FIR stage.
+#define DECIM_FIR_Q 15 ///< Fractional bits of the FIR coefficients.
+#define DECIM_FACTOR (DECIM_CIC_R*DECIM_FIR_R) ///< Total decimation.
+
+/**
+ * @typedef decim_t
+ * 
+ * @brief State of the decimator.
+ * 
+ */
+typedef struct _decim_t{
+    int32_t integ[DECIM_CIC_ORDER]; ///< CIC integrators (modular arithmetic)
+    int32_t comb[DECIM_CIC_ORDER];  ///< CIC comb delays
+    uint8_t cic_phase;              ///< Input samples since the last CIC output
+    int32_t fir[DECIM_FIR_TAPS];    ///< FIR delay line (circular)
+    uint8_t fir_pos;                ///< Position of the newest sample in the delay line
+    uint8_t fir_phase;              ///< CIC outputs since the last FIR output
+}decim_t;
+
+/**
+ * @brief Clear the state of the decimator.
+ * 
+ * @param d 
+ */
+void decim_reset(decim_t *d);
+
+/**
+ * @brief Decimate a block of samples.
+ * 
+ * @param d 
+ * @param in Input samples (Q(SPL_AC_Q) codes).
+ * @param n Number of input samples.
+ * @param out Output samples, same format, it must have room for n/DECIM_FACTOR + 1 samples.
+ * @return Number of output samples.
+ */
+uint32_t decim_process(decim_t *d, const int32_t *in, uint32_t n, int32_t *out);
+
+#endif // __DECIMATOR_H__
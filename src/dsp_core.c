@@ -0,0 +1,114 @@
+/**
+ * \file        dsp_core.c
+ * \brief       Signal processing of the microphone on core1.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+
+#include "dsp_core.h"
+
+static mphone_t *dsp_mphone;            ///< Microphone processed by core1
+static volatile bool dsp_running;       ///< Core1 has been launched
+static volatile bool dsp_park_request;  ///< Core0 asks core1 to stop
+static volatile bool dsp_parked;        ///< Core1 is not touching any shared data
+static volatile bool dsp_pause_request; ///< Core0 asks core1 to wait between two blocks
+static volatile bool dsp_paused;        ///< Core1 waits between two blocks
+static bool dsp_relaunch;               ///< Core1 was reset by dsp_core_pause(), dsp_core_resume() launches it
+
+/**
+ * @brief Entry point of core1.
+ * 
+ */
+static void dsp_core_main(void)
+{
+    multicore_lockout_victim_init(); ///< Core1 runs from flash, it is paused while the flash is written
+
+    mphone_block_t block;
+    while (!dsp_park_request){
+        if (dsp_pause_request){
+            __dmb(); ///< The state of the last block is written before core0 sees the pause
+            dsp_paused = true;
+            while (dsp_pause_request && !dsp_park_request){
+                __wfe();
+            }
+            dsp_paused = false;
+            __dmb(); ///< The state reset by core0 is read after the pause ends
+        }
+        else if (mphone_pop_block(dsp_mphone, &block)){
+            mphone_process_block(dsp_mphone, &block);
+        }
+        else {
+            __wfe(); ///< Woken by the __sev() of the producer
+        }
+    }
+    dsp_parked = true;
+    while (1){
+        __wfe();
+    }
+}
+
+void dsp_core_launch(mphone_t *mphone)
+{
+    if (dsp_running) return;
+    dsp_mphone = mphone;
+    dsp_park_request = false;
+    dsp_pause_request = false;
+    dsp_paused = false;
+    dsp_parked = false;
+    dsp_running = true;
+    multicore_launch_core1(dsp_core_main);
+}
+
+void dsp_core_park(void)
+{
+    if (!dsp_running) return;
+    dsp_park_request = true;
+    __sev();
+    uint32_t start = time_us_32();
+    while (!dsp_parked && (time_us_32() - start) < DSP_CORE_PARK_TIMEOUT_US){
+        tight_loop_contents();
+    }
+    multicore_reset_core1();
+    dsp_running = false;
+}
+
+bool dsp_core_pause(void)
+{
+    if (!dsp_running) return true;
+    dsp_pause_request = true;
+    __sev();
+    uint32_t start = time_us_32();
+    while (!dsp_paused && (time_us_32() - start) < DSP_CORE_PARK_TIMEOUT_US){
+        tight_loop_contents();
+    }
+    if (dsp_paused){
+        __dmb();
+        return true;
+    }
+    multicore_reset_core1(); ///< Stuck in a block
+    dsp_running = false;
+    dsp_relaunch = true;
+    return false;
+}
+
+void dsp_core_resume(void)
+{
+    __dmb(); ///< The state reset by core0 is written before core1 goes on
+    dsp_pause_request = false;
+    if (dsp_relaunch){
+        dsp_relaunch = false;
+        dsp_core_launch(dsp_mphone);
+        return;
+    }
+    __sev();
+}
+
+bool dsp_core_is_running(void)
+{
+    return dsp_running;
+}
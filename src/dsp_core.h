@@ -0,0 +1,58 @@
+/**
+ * \file        dsp_core.h
+ * \brief       Signal processing of the microphone on core1.
+ * \details     The DMA handler on core0 pushes the descriptors of the filled blocks in the block
+ *              queue of the microphone. Core1 pops them, runs the filtering, the energy accumulation
+ *              and the statistics, and posts the results in the result queue, which is read by
+ *              program() on core0. Core1 sleeps in __wfe() while the block queue is empty.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __DSP_CORE_H__
+#define __DSP_CORE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "microphone.h"
+
+#define DSP_CORE_PARK_TIMEOUT_US 100000 ///< Maximum time to wait core1 to finish its block before the reset or the pause.
+
+/**
+ * @brief Launch the processing loop of the microphone on core1. Nothing is done if it is already running.
+ * 
+ * @param mphone Microphone whose blocks are processed.
+ */
+void dsp_core_launch(mphone_t *mphone);
+
+/**
+ * @brief Park core1: wait for the block in process to finish and put core1 in reset.
+ * It must be called before rosc_set_dormant().
+ * 
+ */
+void dsp_core_park(void);
+
+/**
+ * @brief Pause core1 between two blocks, so core0 can reset the queues and the state of the processing.
+ * If core1 does not leave its block in DSP_CORE_PARK_TIMEOUT_US it is put in reset, and launched again by dsp_core_resume().
+ * 
+ * @return false if core1 had to be reset.
+ */
+bool dsp_core_pause(void);
+
+/**
+ * @brief Resume the processing loop after dsp_core_pause().
+ * 
+ */
+void dsp_core_resume(void);
+
+/**
+ * @brief Check if core1 is running the processing loop.
+ * 
+ * @return true 
+ */
+bool dsp_core_is_running(void);
+
+#endif // __DSP_CORE_H__
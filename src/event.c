@@ -0,0 +1,78 @@
+/**
+ * \file        event.c
+ * \brief       Priority queue of the events posted by the interrupts to the main loop.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#include "event.h"
+
+///< Priority of each type of event
+static const uint8_t evq_prio[EV_NUM] = {
+    [EV_NONE] = EVQ_PRIO_LOW,
+    [EV_BUTTON] = EVQ_PRIO_MID,
+    [EV_BUTTON_RELEASE] = EVQ_PRIO_MID,
+    [EV_MPHONE_BLOCK] = EVQ_PRIO_HIGH,
+    [EV_GPS_FIX] = EVQ_PRIO_LOW,
+    [EV_LED_TICK] = EVQ_PRIO_MID,
+    [EV_LCD_TICK] = EVQ_PRIO_LOW,
+    [EV_USB_RX] = EVQ_PRIO_LOW,
+};
+
+void evq_init(evq_t *q)
+{
+    memset(q, 0, sizeof(*q));
+}
+
+bool evq_post(evq_t *q, event_t *ev)
+{
+    evq_ring_t *r = &q->ring[ev->type < EV_NUM ? evq_prio[ev->type] : EVQ_PRIO_LOW];
+    bool posted = false;
+    uint32_t irq = save_and_disable_interrupts(); ///< Several handlers post to the same ring
+    ev->time_us = time_us_32();
+    if ((uint8_t)(r->head - r->tail) < EVQ_SIZE){
+        r->ev[r->head & (EVQ_SIZE - 1)] = *ev;
+        r->head++;
+        posted = true;
+    }else{
+        r->dropped++;
+    }
+    restore_interrupts(irq);
+    return posted;
+}
+
+bool evq_pop(evq_t *q, event_t *ev)
+{
+    for (uint8_t p = 0; p < EVQ_PRIO_NUM; p++){
+        evq_ring_t *r = &q->ring[p];
+        if (r->head == r->tail) continue;
+        *ev = r->ev[r->tail & (EVQ_SIZE - 1)]; ///< The producers do not write this slot until tail passes it
+        __sync_synchronize();
+        r->tail++;
+
+        uint32_t latency = time_us_32() - ev->time_us;
+        if (latency > r->latency_max_us) r->latency_max_us = latency;
+        r->latency_sum_us += latency;
+        r->popped++;
+        return true;
+    }
+    return false;
+}
+
+void evq_print_stats(evq_t *q)
+{
+    static const char *prio[EVQ_PRIO_NUM] = {"high", "mid", "low"};
+    for (uint8_t p = 0; p < EVQ_PRIO_NUM; p++){
+        evq_ring_t *r = &q->ring[p];
+        printf("Events %s: %lu (%lu dropped), latency max %lu us, mean %lu us\n", prio[p], (unsigned long)r->popped,
+               (unsigned long)r->dropped, (unsigned long)r->latency_max_us,
+               (unsigned long)(r->popped ? r->latency_sum_us/r->popped : 0));
+    }
+}
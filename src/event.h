@@ -0,0 +1,151 @@
+/**
+ * \file        event.h
+ * \brief       Priority queue of the events posted by the interrupts to the main loop.
+ * \details     Each priority has its own ring of events; the producers are the interrupt
+ *              handlers of core0 and the consumer is the main loop, which pops the oldest event of
+ *              the highest priority. An event carries its type, the time it was posted and a
+ *              payload, so two events of the same type are two entries, not one merged flag. Post
+ *              and pop run with the interrupts disabled for a few instructions. A full ring drops
+ *              the new event and counts it. The latency of each priority, from the post to the pop,
+ *              is measured.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __EVENT_H__
+#define __EVENT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EVQ_SIZE 8 ///< Events of each priority, power of 2
+
+/**
+ * @brief Types of event, with their payload in event_t.
+ *
+ */
+typedef enum{
+    EV_NONE,
+    EV_BUTTON,          ///< The button was pressed, the debouncer is running (gpio, mask)
+    EV_BUTTON_RELEASE,  ///< The debouncer has seen the button released
+    EV_MPHONE_BLOCK,    ///< The DMA has filled a block of the microphone, core1 may have posted a result (block_us)
+    EV_GPS_FIX,         ///< The GPS parser has published a fix, or the valid one must be aged (published)
+    EV_LED_TICK,        ///< The alarm of the LED has expired
+    EV_LCD_TICK,        ///< Refresh of the LCD
+    EV_USB_RX,          ///< The USB has received characters (export requests)
+    EV_NUM
+}event_type_t;
+
+/**
+ * @brief Priorities, the high ones are popped first.
+ *
+ */
+typedef enum{
+    EVQ_PRIO_HIGH,  ///< Data that can be overwritten: the blocks of the microphone
+    EVQ_PRIO_MID,   ///< The user and the state of the system: button, LED
+    EVQ_PRIO_LOW,   ///< Display, GPS and USB
+    EVQ_PRIO_NUM
+}evq_prio_t;
+
+/**
+ * @brief An event and its payload.
+ *
+ */
+typedef struct{
+    uint8_t type;       ///< event_type_t
+    uint32_t time_us;   ///< time_us_32() when it was posted
+    union{
+        struct{
+            uint8_t gpio;
+            uint32_t mask;
+        }button;                ///< EV_BUTTON
+        uint32_t block_us;      ///< EV_MPHONE_BLOCK: time stamp of the block
+        bool published;         ///< EV_GPS_FIX: a new fix, false if only its age must be checked
+    };
+}event_t;
+
+/**
+ * @brief Ring of the events of a priority.
+ *
+ */
+typedef struct{
+    event_t ev[EVQ_SIZE];
+    volatile uint8_t head;  ///< Written by the producers
+    volatile uint8_t tail;  ///< Written by the consumer
+    uint32_t dropped;       ///< Events lost because the ring was full
+    uint32_t popped;        ///< Events popped
+    uint32_t latency_max_us;    ///< Longest time from the post to the pop
+    uint64_t latency_sum_us;    ///< For the mean
+}evq_ring_t;
+
+/**
+ * @typedef evq_t
+ *
+ * @brief Queue of the events, a ring per priority.
+ *
+ */
+typedef struct{
+    evq_ring_t ring[EVQ_PRIO_NUM];
+}evq_t;
+
+/**
+ * @brief Initialize the queue, empty and with its statistics cleared.
+ *
+ * @param q
+ */
+void evq_init(evq_t *q);
+
+/**
+ * @brief Post an event, from an interrupt handler or the main loop. The time is stamped here.
+ *
+ * @param q
+ * @param ev Type and payload
+ * @return false if the ring of its priority is full and the event was dropped.
+ */
+bool evq_post(evq_t *q, event_t *ev);
+
+/**
+ * @brief Post an event without payload.
+ *
+ * @param q
+ * @param type event_type_t
+ * @return false if it was dropped.
+ */
+static inline bool evq_post_type(evq_t *q, uint8_t type)
+{
+    event_t ev = {.type = type};
+    return evq_post(q, &ev);
+}
+
+/**
+ * @brief Pop the oldest event of the highest priority, and account its latency.
+ *
+ * @param q
+ * @param ev
+ * @return false if the queue is empty.
+ */
+bool evq_pop(evq_t *q, event_t *ev);
+
+/**
+ * @brief Check if there are events, e.g. with the interrupts disabled before __wfi().
+ *
+ * @param q
+ * @return true if there are no events.
+ */
+static inline bool evq_empty(evq_t *q)
+{
+    for (uint8_t p = 0; p < EVQ_PRIO_NUM; p++){
+        if (q->ring[p].head != q->ring[p].tail) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Print the events popped and dropped and the latency of each priority.
+ *
+ * @param q
+ */
+void evq_print_stats(evq_t *q);
+
+#endif // __EVENT_H__
@@ -0,0 +1,341 @@
+/**
+ * \file        flash_log.c
+ * \brief       Append-only record log over a ring of flash sectors.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+#include "flash_log.h"
+#include "record.h"
+
+/**
+ * @brief Flash operation run by flash_safe_execute(), with the other core and the interrupts stopped.
+ *
+ */
+typedef struct{
+    uint32_t offset;        ///< Flash-based address of the sector or the page
+    const uint8_t *page;    ///< Page to program, after the erase if erase is set
+    bool erase;             ///< Erase the sector before programming its first page
+}flog_op_t;
+
+static uint8_t flog_buf[FLASH_PAGE_SIZE] __attribute__((aligned(4))); ///< Page being programmed
+
+static void flog_flash_op(void *param)
+{
+    flog_op_t *op = (flog_op_t *)param;
+    if (op->erase){
+        flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+    }
+    flash_range_program(op->offset, op->page, FLASH_PAGE_SIZE);
+}
+
+/**
+ * @brief Program flog_buf in a page. Only the bits at 1 in the flash can be cleared, so a programmed
+ * page can be programmed again with the erased words it still has.
+ *
+ * @param sector
+ * @param page
+ * @param erase Erase the sector before, only with page 0.
+ * @return true if the operation was done.
+ */
+static bool flog_program(uint8_t sector, uint8_t page, bool erase)
+{
+    flog_op_t op = {FLOG_OFFSET + sector*FLASH_SECTOR_SIZE + page*FLASH_PAGE_SIZE, flog_buf, erase};
+    return flash_safe_execute(flog_flash_op, &op, FLOG_TIMEOUT_MS) == PICO_OK;
+}
+
+/**
+ * @brief Program a sector header.
+ *
+ * @param sector
+ * @param erase_count
+ * @param seq FLOG_FREE to prepare the sector, its sequence number to open it.
+ * @param erase Erase the sector before.
+ * @return true if the operation was done.
+ */
+static bool flog_program_sector(uint8_t sector, uint32_t erase_count, uint32_t seq, bool erase)
+{
+    flog_sector_t hdr = {FLOG_MAGIC, erase_count, seq};
+    memset(flog_buf, 0xFF, sizeof(flog_buf));
+    memcpy(flog_buf, &hdr, sizeof(hdr));
+    return flog_program(sector, 0, erase);
+}
+
+static uint16_t flog_page_crc(const uint8_t *bytes)
+{
+    return bytes[FLOG_CRC_OFFSET] | (uint16_t)bytes[FLOG_CRC_OFFSET + 1] << 8;
+}
+
+/**
+ * @brief The CRC of a sealed page matches its bytes, a page not sealed can not be checked.
+ *
+ */
+static bool flog_page_ok(const uint8_t *bytes)
+{
+    uint16_t crc = flog_page_crc(bytes);
+    return crc == FLOG_CRC_FREE || crc == rec_crc16(bytes, FLOG_CRC_OFFSET);
+}
+
+/**
+ * @brief Seal a page with the CRC of its bytes, nothing can be added to it after.
+ *
+ * @return true if the page is sealed.
+ */
+static bool flog_seal(uint8_t sector, uint8_t page)
+{
+    const uint8_t *bytes = (const uint8_t *)flog_page(sector, page);
+    if (flog_page_crc(bytes) != FLOG_CRC_FREE) return true;
+    uint16_t crc = rec_crc16(bytes, FLOG_CRC_OFFSET);
+    memset(flog_buf, 0xFF, sizeof(flog_buf));
+    flog_buf[FLOG_CRC_OFFSET] = (uint8_t)crc;
+    flog_buf[FLOG_CRC_OFFSET + 1] = (uint8_t)(crc >> 8);
+    return flog_program(sector, page, false);
+}
+
+/**
+ * @brief Walk the records of a page.
+ *
+ * @param size Length of a record.
+ * @param bytes Page.
+ * @param n Records found.
+ * @return Offset after the last record, at a byte that is not FLOG_EMPTY if a record could not be read.
+ */
+static uint16_t flog_page_used(flog_size_t size, const uint8_t *bytes, uint32_t *n)
+{
+    uint16_t off = sizeof(flog_page_t);
+    *n = 0;
+    while (off < FLOG_CRC_OFFSET && bytes[off] != FLOG_EMPTY){
+        size_t len = size(bytes + off, FLOG_CRC_OFFSET - off);
+        if (!len) break;
+        off += len;
+        (*n)++;
+    }
+    return off;
+}
+
+/**
+ * @brief Key of a sector for the search of the head: its sequence number, 0 if it is not opened.
+ *
+ */
+static uint32_t flog_sector_key(uint8_t sector)
+{
+    const flog_sector_t *hdr = flog_sector(sector);
+    return (hdr->magic != FLOG_MAGIC || hdr->seq == FLOG_FREE) ? 0 : hdr->seq;
+}
+
+/**
+ * @brief Find the last started page of a sector and the free space of that page.
+ * The started pages are the first ones of the sector, so the last one is found by binary search.
+ *
+ * @param size Length of a record.
+ * @param sector
+ * @param page Last started page.
+ * @param pos Offset of the free space of the page, FLOG_CRC_OFFSET if nothing can be added to it.
+ * @param next_index Index of the record after the last one of the sector.
+ * @return false if the sector has no records.
+ */
+static bool flog_scan_sector(flog_size_t size, uint8_t sector, uint8_t *page, uint16_t *pos, uint32_t *next_index)
+{
+    if (flog_page(sector, 1)->index == FLOG_FREE) return false;
+    uint8_t p = 1, hi = FLOG_PAGES - 1; ///< Page p is started, the pages after hi are not
+    while (p < hi){
+        uint8_t mid = (p + hi + 1)/2;
+        if (flog_page(sector, mid)->index != FLOG_FREE) p = mid;
+        else hi = mid - 1;
+    }
+    const uint8_t *bytes = (const uint8_t *)flog_page(sector, p);
+    uint32_t n;
+    uint16_t off = flog_page_used(size, bytes, &n);
+    ///< A sealed page, or one with a record that can not be read, is not written again
+    bool full = off >= FLOG_CRC_OFFSET || bytes[off] != FLOG_EMPTY || flog_page_crc(bytes) != FLOG_CRC_FREE;
+    *page = p;
+    *pos = full ? FLOG_CRC_OFFSET : off;
+    *next_index = flog_page(sector, p)->index + n;
+    return true;
+}
+
+/**
+ * @brief Count the records from the first page of the tail sector.
+ *
+ * @param log
+ */
+static void flog_count(flog_t *log)
+{
+    uint32_t first = flog_page(log->tail, 1)->index;
+    log->count = (first == FLOG_FREE) ? 0 : log->next_index - first;
+}
+
+void flog_init(flog_t *log, flog_size_t size)
+{
+    log->size = size;
+    log->head = FLOG_NUM_SECTORS - 1; ///< An empty log is a full sector before the first one
+    log->tail = 0;
+    log->page = FLOG_PAGES;
+    log->pos = 0;
+    log->seq = 0;
+    log->next_index = 0;
+    log->count = 0;
+
+    ///< Along the ring the keys grow from the tail to the head, followed by the prepared and the never
+    ///< used sectors (key 0). So the head is the last sector with a key not below the one of sector 0.
+    uint32_t key0 = flog_sector_key(0);
+    uint8_t lo = 0, hi = FLOG_NUM_SECTORS - 1;
+    while (lo < hi){
+        uint8_t mid = (lo + hi + 1)/2;
+        if (flog_sector_key(mid) >= key0) lo = mid;
+        else hi = mid - 1;
+    }
+    uint32_t seq = flog_sector_key(lo);
+    if (!seq) return; ///< Nothing opened
+    log->head = lo;
+    log->seq = seq;
+
+    ///< The tail is the first opened sector after the prepared ones
+    log->tail = (log->head + 1) % FLOG_NUM_SECTORS;
+    while (!flog_sector_key(log->tail)){
+        log->tail = (log->tail + 1) % FLOG_NUM_SECTORS;
+    }
+
+    ///< The records are contiguous from the tail to the head
+    if (!flog_scan_sector(size, log->head, &log->page, &log->pos, &log->next_index)){
+        log->page = 1; ///< The head was opened but has no records yet
+        log->pos = 0;
+        if (log->head != log->tail){
+            uint8_t page;
+            uint16_t pos;
+            flog_scan_sector(size, (log->head + FLOG_NUM_SECTORS - 1) % FLOG_NUM_SECTORS, &page, &pos, &log->next_index);
+        }
+    }
+    flog_count(log);
+}
+
+bool flog_append(flog_t *log, const void *data, uint16_t len)
+{
+    if (len == 0 || len > FLOG_RECORD_SIZE) return false;
+
+    uint8_t page = log->page;
+    uint16_t pos = log->pos;
+    bool start = flog_starts_page(log, len);
+    if (start && pos){ ///< The page is complete, its CRC protects it from now on
+        if (!flog_seal(log->head, page)) return false;
+        page++;
+    }
+    memset(flog_buf, 0xFF, sizeof(flog_buf));
+    if (start){
+        if (page >= FLOG_PAGES){ ///< Open the next sector, flog_maintain() has prepared it
+            uint8_t next = (log->head + 1) % FLOG_NUM_SECTORS;
+            const flog_sector_t *hdr = flog_sector(next);
+            if (hdr->magic != FLOG_MAGIC || hdr->seq != FLOG_FREE) return false;
+            if (!flog_program_sector(next, hdr->erase_count, log->seq + 1, false)) return false;
+            if (!log->count) log->tail = next;
+            log->head = next;
+            log->seq++;
+            log->page = page = 1;
+            log->pos = 0;
+            memset(flog_buf, 0xFF, sizeof(flog_buf));
+        }
+        flog_page_t hdr = {log->next_index};
+        memcpy(flog_buf, &hdr, sizeof(hdr));
+        pos = sizeof(hdr);
+    }
+
+    ///< The bytes at 0xFF leave the records already programmed in the page untouched
+    memcpy(flog_buf + pos, data, len);
+    if (!flog_program(log->head, page, false)) return false;
+
+    log->page = page;
+    log->pos = pos + len;
+    log->next_index++;
+    log->count++;
+    return true;
+}
+
+bool flog_maintain(flog_t *log)
+{
+    uint8_t next = (log->head + 1) % FLOG_NUM_SECTORS;
+    const flog_sector_t *hdr = flog_sector(next);
+    if (hdr->magic == FLOG_MAGIC && hdr->seq == FLOG_FREE) return true; ///< Already prepared
+
+    uint32_t erase_count = (hdr->magic == FLOG_MAGIC) ? hdr->erase_count + 1 : 1;
+    bool reclaim = log->count && next == log->tail; ///< The ring is full, the oldest sector is reclaimed
+    if (!flog_program_sector(next, erase_count, FLOG_FREE, true)) return false;
+    if (reclaim){
+        log->tail = (log->tail + 1) % FLOG_NUM_SECTORS;
+        flog_count(log);
+    }
+    return true;
+}
+
+/**
+ * @brief Start an iterator at the beginning of a page.
+ *
+ */
+static void flog_iter_start(flog_t *log, flog_iter_t *it, uint8_t sector, uint8_t page, uint32_t index)
+{
+    it->sector = sector;
+    it->page = page;
+    it->pos = 0;
+    it->index = index;
+    it->end = log->next_index;
+    it->pages = 0;
+    it->damaged = 0;
+    it->size = log->size;
+}
+
+void flog_first(flog_t *log, flog_iter_t *it)
+{
+    flog_iter_start(log, it, log->tail, 1, log->next_index - log->count);
+}
+
+void flog_last_page(flog_t *log, flog_iter_t *it)
+{
+    flog_iter_start(log, it, log->head, log->page, log->pos ? flog_page(log->head, log->page)->index : log->next_index);
+}
+
+static void flog_next_page(flog_iter_t *it)
+{
+    it->pos = 0;
+    it->pages++;
+    if (++it->page >= FLOG_PAGES){
+        it->page = 1;
+        it->sector = (it->sector + 1) % FLOG_NUM_SECTORS;
+    }
+}
+
+const uint8_t *flog_next(flog_iter_t *it, uint16_t *len, bool *page_start)
+{
+    while ((int32_t)(it->end - it->index) > 0 && it->pages < FLOG_NUM_SECTORS*FLOG_PAGES){
+        const uint8_t *bytes = (const uint8_t *)flog_page(it->sector, it->page);
+        if (!it->pos){ ///< Start of a page, its header gives the index of its first record
+            uint32_t index = ((const flog_page_t *)bytes)->index;
+            if (index == FLOG_FREE) return NULL; ///< Nothing was written after
+            if (!flog_page_ok(bytes)){
+                it->damaged++;
+                flog_next_page(it);
+                continue;
+            }
+            it->index = index; ///< The records of a damaged page before are skipped
+            it->pos = sizeof(flog_page_t);
+            continue;
+        }
+        size_t n = 0;
+        if (it->pos < FLOG_CRC_OFFSET && bytes[it->pos] != FLOG_EMPTY){
+            n = it->size(bytes + it->pos, FLOG_CRC_OFFSET - it->pos);
+            if (!n) it->damaged++; ///< The rest of the page can not be read
+        }
+        if (!n){ ///< End of the page
+            flog_next_page(it);
+            continue;
+        }
+        *page_start = (it->pos == sizeof(flog_page_t));
+        *len = (uint16_t)n;
+        const uint8_t *data = bytes + it->pos;
+        it->pos += n;
+        it->index++;
+        return data;
+    }
+    return NULL;
+}
@@ -0,0 +1,199 @@
+/**
+ * \file        flash_log.h
+ * \brief       Append-only record log over a ring of flash sectors.
+ * \details     The last FLOG_NUM_SECTORS sectors of the flash are a ring. The first page of each
+ *              sector is its header: magic, erase count and sequence number. The sequence number
+ *              is programmed when the sector is opened, so the newest sector has the highest one.
+ *              The other pages hold records packed behind a page header with the index of their
+ *              first record (a record never starts with 0xFF, the free space). The length of a
+ *              record comes from its own fields, through the flog_size_t function given to
+ *              flog_init(). A commit programs the page again with the new record and 0xFF
+ *              elsewhere, which leaves the records already there untouched. A page is sealed with
+ *              a CRC16 of its bytes in its last two when the next one is started, so the page
+ *              being written is the only one a reader can not check. Sectors are erased by
+ *              flog_maintain(), which keeps the sector after the head erased (reclaiming the
+ *              oldest one), so every sector is erased once per turn of the ring.
+ *              Capacity with the records of the tracker without optional fields (record.h):
+ *              about 27 per page and 400 per sector, against the 50 records of 12 bytes the
+ *              single sector of the format before held, and about 6000 in the 15 sectors of the
+ *              ring with records.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __FLASH_LOG_H__
+#define __FLASH_LOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#define FLOG_NUM_SECTORS 16 ///< Sectors of the ring, at the end of the flash.
+#define FLOG_OFFSET (PICO_FLASH_SIZE_BYTES - FLOG_NUM_SECTORS*FLASH_SECTOR_SIZE) ///< Flash-based address of the ring
+#define FLOG_PAGES (FLASH_SECTOR_SIZE/FLASH_PAGE_SIZE) ///< Pages of a sector, the first one is the header
+#define FLOG_MAGIC 0x32474F4C ///< "LOG2", the sector header is valid: the sectors of other formats are erased when reached
+#define FLOG_FREE 0xFFFFFFFF ///< Erased word: the sequence number or the index are not programmed
+#define FLOG_TIMEOUT_MS 500 ///< Timeout for the other core to stop before a flash operation.
+
+/**
+ * @brief Header of a sector, in its first page.
+ *
+ */
+typedef struct{
+    uint32_t magic;         ///< FLOG_MAGIC
+    uint32_t erase_count;   ///< Erases of the sector
+    uint32_t seq;           ///< Sequence number, FLOG_FREE while the sector is not opened
+}flog_sector_t;
+
+/**
+ * @brief Header of a record page.
+ *
+ */
+typedef struct{
+    uint32_t index;         ///< Index of the first record of the page since the log was created, FLOG_FREE if the page is free
+}flog_page_t;
+
+#define FLOG_EMPTY 0xFF ///< First byte of the free space of a page
+#define FLOG_CRC_OFFSET (FLASH_PAGE_SIZE - 2) ///< CRC16 of the bytes before it, little endian, programmed when the page is sealed
+#define FLOG_CRC_FREE 0xFFFF ///< CRC of a page not sealed
+#define FLOG_RECORD_SIZE (FLOG_CRC_OFFSET - sizeof(flog_page_t)) ///< Maximum bytes of a record
+
+/**
+ * @brief Length of the record at data.
+ *
+ * @param data
+ * @param avail Bytes of the page from data.
+ * @return Bytes of the record, 0 if it is not a record or it does not end within avail.
+ */
+typedef size_t (*flog_size_t)(const uint8_t *data, size_t avail);
+
+/**
+ * @typedef flog_t
+ *
+ * @brief Position of the log in RAM, rebuilt from the headers by flog_init().
+ *
+ */
+typedef struct _flog_t{
+    uint8_t head;           ///< Sector being written
+    uint8_t tail;           ///< Oldest sector with records
+    uint8_t page;           ///< Page being written in the head sector, FLOG_PAGES if the sector is full
+    uint16_t pos;           ///< Offset of the free space of the page, 0 if the page is not started
+    uint32_t seq;           ///< Sequence number of the head sector
+    uint32_t next_index;    ///< Index of the next record
+    uint32_t count;         ///< Records in the log
+    flog_size_t size;       ///< Length of a record
+}flog_t;
+
+/**
+ * @brief Position of a reader of the log.
+ *
+ */
+typedef struct{
+    uint8_t sector;
+    uint8_t page;
+    uint16_t pos;           ///< Offset of the next record in the page, 0 before the page header is read
+    uint32_t index;         ///< Index of the next record, from the header of its page
+    uint32_t end;           ///< Index of the record after the last one of the log
+    uint16_t pages;         ///< Pages visited, bounds the reading of a damaged log
+    uint16_t damaged;       ///< Pages skipped: wrong CRC or a record that could not be read
+    flog_size_t size;
+}flog_iter_t;
+
+/**
+ * @brief Find the head and the tail of the log from the sector and page headers, by binary search. 
+ * It does not erase.
+ *
+ * @param log
+ * @param size Length of a record, to find the free space of the page being written.
+ */
+void flog_init(flog_t *log, flog_size_t size);
+
+/**
+ * @brief Tell if a record would start a new page, a reader of the log can only start at those.
+ *
+ * @param log
+ * @param len Bytes of the record.
+ * @return true if the record does not fit in the page being written.
+ */
+static inline bool flog_starts_page(flog_t *log, uint16_t len)
+{
+    return log->pos == 0 || (uint32_t)log->pos + len > FLOG_CRC_OFFSET;
+}
+
+/**
+ * @brief Append a record to the page being written, or to the next one if it does not fit (the page
+ * is sealed first). It never erases: when the head sector is full the next one must have been
+ * prepared by flog_maintain().
+ *
+ * @param log
+ * @param data
+ * @param len Bytes of the record, 1 to FLOG_RECORD_SIZE.
+ * @return false if there is no prepared page or the flash could not be programmed.
+ */
+bool flog_append(flog_t *log, const void *data, uint16_t len);
+
+/**
+ * @brief Prepare the sector after the head: erase it (reclaiming the oldest records if it has some)
+ * and program its header. Call it when there is no measurement in progress (boot, WAIT).
+ *
+ * @param log
+ * @return false if the flash could not be erased.
+ */
+bool flog_maintain(flog_t *log);
+
+/**
+ * @brief Start reading the log from its oldest record.
+ *
+ * @param log
+ * @param it
+ */
+void flog_first(flog_t *log, flog_iter_t *it);
+
+/**
+ * @brief Start reading the log from the first record of the page being written, to reach the newest
+ * records without reading the whole log.
+ *
+ * @param log
+ * @param it
+ */
+void flog_last_page(flog_t *log, flog_iter_t *it);
+
+/**
+ * @brief Read the next record of the log. The pages with a wrong CRC are skipped, their records
+ * are lost and counted in it->damaged.
+ *
+ * @param it
+ * @param len Bytes of the record.
+ * @param page_start Set if the record is the first one of its page.
+ * @return Pointer to the record in the XIP flash, NULL at the end of the log.
+ */
+const uint8_t *flog_next(flog_iter_t *it, uint16_t *len, bool *page_start);
+
+/**
+ * @brief Pointer to a sector header in the XIP flash.
+ *
+ * @param sector
+ * @return const flog_sector_t*
+ */
+static inline const flog_sector_t *flog_sector(uint8_t sector)
+{
+    return (const flog_sector_t *)(XIP_BASE + FLOG_OFFSET + sector*FLASH_SECTOR_SIZE);
+}
+
+/**
+ * @brief Pointer to a page header in the XIP flash.
+ *
+ * @param sector
+ * @param page
+ * @return const flog_page_t*
+ */
+static inline const flog_page_t *flog_page(uint8_t sector, uint8_t page)
+{
+    return (const flog_page_t *)(XIP_BASE + FLOG_OFFSET + sector*FLASH_SECTOR_SIZE + page*FLASH_PAGE_SIZE);
+}
+
+#endif // __FLASH_LOG_H__
@@ -0,0 +1,91 @@
+/**
+ * \file        fmt.c
+ * \brief       Fixed width integer formatting for the LCD and the console, without printf.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include "fmt.h"
+
+static const uint32_t fmt_pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+/**
+ * @brief Digits of value written backwards before end, at least min of them (leading zeros).
+ *
+ * @return Number of digits.
+ */
+static uint8_t fmt_digits(char *end, uint32_t value, uint8_t min)
+{
+    uint8_t n = 0;
+    do{
+        *--end = '0' + value % 10;
+        value /= 10;
+        n++;
+    }while (value || n < min);
+    return n;
+}
+
+/**
+ * @brief Write the characters of a number in the field: padding, sign, and the characters.
+ *
+ */
+static uint8_t fmt_field(char *buf, const char *str, uint8_t len, char sign, uint8_t width, char pad)
+{
+    uint8_t total = len + (sign != 0);
+    uint8_t i = 0;
+    if (width && total > width){ ///< Does not fit
+        while (i < width) buf[i++] = '*';
+        buf[i] = '\0';
+        return i;
+    }
+    if (sign && pad == '0') buf[i++] = sign; ///< -0042
+    while (i + total - (sign && pad == '0') < width) buf[i++] = pad;
+    if (sign && pad != '0') buf[i++] = sign; ///<   -42
+    for (uint8_t j = 0; j < len; j++) buf[i++] = str[j];
+    buf[i] = '\0';
+    return i;
+}
+
+uint8_t fmt_uint(char *buf, uint32_t value, uint8_t width, char pad)
+{
+    char tmp[10];
+    uint8_t n = fmt_digits(tmp + sizeof(tmp), value, 1);
+    return fmt_field(buf, tmp + sizeof(tmp) - n, n, 0, width, pad);
+}
+
+uint8_t fmt_int(char *buf, int32_t value, uint8_t width)
+{
+    char tmp[10];
+    uint32_t abs_value = value < 0 ? -(uint32_t)value : (uint32_t)value;
+    uint8_t n = fmt_digits(tmp + sizeof(tmp), abs_value, 1);
+    return fmt_field(buf, tmp + sizeof(tmp) - n, n, value < 0 ? '-' : 0, width, ' ');
+}
+
+uint8_t fmt_fixed(char *buf, int32_t value, uint8_t frac, uint8_t shown, uint8_t width)
+{
+    char tmp[20];
+    char *end = tmp + sizeof(tmp);
+    uint32_t abs_value = value < 0 ? -(uint32_t)value : (uint32_t)value;
+    if (frac > 9) frac = 9;
+    if (shown > frac) shown = frac;
+    uint8_t n = 0;
+    if (shown){
+        n = fmt_digits(end, abs_value % fmt_pow10[frac] / fmt_pow10[frac - shown], shown);
+        tmp[sizeof(tmp) - ++n] = '.';
+    }
+    n += fmt_digits(end - n, abs_value / fmt_pow10[frac], 1);
+    return fmt_field(buf, end - n, n, value < 0 ? '-' : 0, width, ' ');
+}
+
+uint8_t fmt_time(char *buf, uint32_t seconds)
+{
+    uint32_t t = seconds % 86400;
+    fmt_uint(buf, t/3600, 2, '0');
+    buf[2] = ':';
+    fmt_uint(buf + 3, t/60 % 60, 2, '0');
+    buf[5] = ':';
+    fmt_uint(buf + 6, t % 60, 2, '0');
+    return 8;
+}
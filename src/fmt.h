@@ -0,0 +1,64 @@
+/**
+ * \file        fmt.h
+ * \brief       Fixed width integer formatting for the LCD and the console, without printf.
+ * \details     Integers, fixed point values (microdegrees, centi-dB) and times of the day are
+ *              written right aligned in a field of a given width, padded on the left. A value
+ *              that does not fit is written as '*' over the whole field, so the output never
+ *              exceeds the width and the lines of the LCD keep their layout. No floating point,
+ *              no division wider than 32 bits. Portable C, it is also built by the host tools.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __FMT_H__
+#define __FMT_H__
+
+#include <stdint.h>
+
+#define FMT_MAX 24 ///< Longest field, with its terminator: width 0 writes what the value needs (up to 23 characters)
+
+/**
+ * @brief Write an unsigned integer.
+ *
+ * @param buf At least max(width, 10) + 1 characters.
+ * @param value
+ * @param width Characters of the field, 0 for the digits of the value.
+ * @param pad ' ' or '0'.
+ * @return Characters written, without the terminator.
+ */
+uint8_t fmt_uint(char *buf, uint32_t value, uint8_t width, char pad);
+
+/**
+ * @brief Write a signed integer, the sign before the digits and after the spaces.
+ *
+ * @param buf At least max(width, 11) + 1 characters.
+ * @param value
+ * @param width Characters of the field, 0 for the characters of the value.
+ * @return Characters written, without the terminator.
+ */
+uint8_t fmt_int(char *buf, int32_t value, uint8_t width);
+
+/**
+ * @brief Write a fixed point value, e.g. microdegrees (frac 6) or centi-dB (frac 2).
+ * The decimals not shown are truncated, a negative value keeps its sign even if it shows 0.
+ *
+ * @param buf At least max(width, 12 + shown) + 1 characters.
+ * @param value
+ * @param frac Decimals of value (value/10^frac is the number).
+ * @param shown Decimals written, up to frac.
+ * @param width Characters of the field, 0 for the characters of the value.
+ * @return Characters written, without the terminator.
+ */
+uint8_t fmt_fixed(char *buf, int32_t value, uint8_t frac, uint8_t shown, uint8_t width);
+
+/**
+ * @brief Write the time of the day of a time stamp in s as hh:mm:ss.
+ *
+ * @param buf At least 9 characters.
+ * @param seconds
+ * @return 8
+ */
+uint8_t fmt_time(char *buf, uint32_t seconds);
+
+#endif // __FMT_H__
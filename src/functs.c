@@ -31,6 +31,9 @@
 #include "gps.h"
 #include "microphone.h"
 #include "liquid_crystal_i2c.h"
+#include "dsp_core.h"
+#include "usb_export.h"
+#include "fmt.h"
 
 // I2C pins
 #define PIN_SDA 14
@@ -42,7 +45,7 @@
 
 #define SYSTEM_CLK_HZ 48*MHZ
 #define SYSTEM_CLK_KHZ 6500
-#define ADC_SAMPLE_RATE_HZ MPHONE_SIZE_BUFFER/10
+#define ADC_SAMPLE_RATE_HZ 48000 ///< Full audio bandwidth, the weighting filters have coefficients for this rate
 
 #define LCD_EN_GPIO 12
 #define MPHONE_EN_GPIO 13
@@ -54,16 +57,20 @@
 
 system_t gSystem;  ///< Global variable that stores the state of the system
 led_rgb_t gLed;         ///< Global variable that stores the led information
-flags_t gFlags;         ///< Global variable that stores the flags of the interruptions pending
+evq_t gEvents;          ///< Global variable that stores the events posted by the interruptions
 gpio_button_t gButton;  ///< Global variable that stores the button information
 mphone_t gMphone;       ///< Global variable that stores the microphone information
 gps_t gGps; ///< Global variable the structure of the GPS
 lcd_t gLcd; ///< Global variable the structure of the LCD
+uexp_t gExport; ///< Global variable of the receiver of the USB export requests
+static swt_timer_t sLcdRefresh; ///< Periodic timer of the LCD refresh
 
 void initGlobalVariables(void)
 {
-    //Initialize the flags
-    gFlags.W = 0;
+    //Initialize the event queue and the timers, on one hardware alarm
+    evq_init(&gEvents);
+    swt_init();
+    swt_timer_init(&sLcdRefresh, lcd_refresh_handler, NULL);
 
     //Initialize the modules
     led_init(&gLed, 18, 1000000); //Led on green
@@ -72,6 +79,8 @@ void initGlobalVariables(void)
     led_init(&gLed, LED_GPIO, 1000000);
     button_init(&gButton, BUTTON_GPIO);
     mphone_init(&gMphone, MPHONE_GPIO, ADC_SAMPLE_RATE_HZ, MPHONE_EN_GPIO);
+    uexp_init(&gExport);
+    stdio_set_chars_available_callback(usb_rx_callback, NULL); ///< Export requests of the host
   
     ///< Set the system state to DORMANT
     gSystem.state = DORMANT; 
@@ -164,244 +173,385 @@ void clock_config(void)
     }
 }
 
-void program(void)
+// -------------------------------------------------------------
+// ---------------- Services and transitions of program() ------
+// -------------------------------------------------------------
+
+static mphone_result_t sResult; ///< Result popped by the last EV_MPHONE_BLOCK
+static bool sResultValid;       ///< sResult holds a result of that event
+
+/**
+ * @brief Copy the last fix decoded from the GPS and check it.
+ * 
+ */
+static void service_gps(const event_t *ev)
 {
-    if (gFlags.B.wait){ ///< The system is waiting for the GPS to be hooked
-        gFlags.B.wait = 0;
-        printf_usb("WAIT \n");
-        gLed.time = 1000000;    ///< 1s
-        gLed.state = 1;         ///< Led on
-        led_setup_red(&gLed);   ///< Red led
-        mphone_configure_dma(&gMphone); ///< Configure the DMA for the microphone
-        lcd_refresh_handler();
-    }
-    if (gFlags.B.meas){ ///< Start the measurement
-        gFlags.B.meas = 0;
-        printf_usb("MEASURE \n");
-        gLed.time = 10000000;       ///< 10s
-        led_setup_yellow(&gLed);    ///< Yellow led
-        gMphone.dma_time = time_us_32(); ///< Start the DMA transfer
-        mphone_dma_trigger(&gMphone);   ///< Start the DMA for the microphone
-    }
-    if (gFlags.B.error){ ///< An anomaly has occurred
-        gFlags.B.error = 0;
-        printf_usb("ERROR \n");
-        gLed.time = 3000000;    ///< 3s
-        led_setup_red(&gLed);   ///< Red led
-    }
-    if (gFlags.B.mphone_dma){ ///< The DMA has finished and the microphone has a new SPL
-        gFlags.B.mphone_dma = 0;
-        printf_usb("Microphone interruption\n");
-        mphone_calculate_spl(&gMphone); ///< Calculate the Sound Pressure Level
-        gSystem.state = DONE;       ///< The system has finished the measurement
-        gLed.time = 2000000;        ///< 2s
-        led_setup_orange(&gLed);    ///< Orange led
-        mphone_store_spl_location(&gMphone); ///< Store the SPL array in non-volatile memory
+    gps_update_fix(&gGps);
+    gps_check_data(&gGps);
+}
+
+/**
+ * @brief Core1 may have posted a result, keep it for the transitions.
+ * 
+ */
+static void service_mphone(const event_t *ev)
+{
+    sResultValid = mphone_pop_result(&gMphone, &sResult);
+}
+
+/**
+ * @brief Answer the export requests, the flash is not read while measuring.
+ * 
+ */
+static void service_usb(const event_t *ev)
+{
+    uexp_poll(&gExport, &gMphone.log, gSystem.state == MEASURE);
+}
+
+/**
+ * @brief Show the data on the LCD.
+ * 
+ */
+static void service_lcd(const event_t *ev)
+{
+    char str_0[FMT_MAX]; ///< Field of the LCD, fixed widths: the fields never overflow nor leave stale cells
+
+    //Draw the framebuffer, only the cells that change are sent
+    if (gSystem.state == MEASURE){
+        str_0[0] = 'L'; ///< "LAF  -65.3 dB", the Fast level updated by core1 every block
+        str_0[1] = weighting_letter(gMphone.curve);
+        str_0[2] = 'F';
+        fmt_fixed(&str_0[3], gMphone.live_cdb, 2, 1, 7);
+        lcd_print(&gLcd, str_0, 0, 0);
+        lcd_print(&gLcd, " dB", 0, 10);
+    }else{
+        lcd_print(&gLcd, "X:", 0, 0); //Show the latitude, microdegrees
+        fmt_fixed(str_0, gGps.latitude, 6, 6, 11);
+        lcd_print(&gLcd, str_0, 0, 2);
     }
-    if (gFlags.B.uart_read){
-        //Get the data from the GPS
-        gps_get_GPGGA(&gGps);
+    lcd_print(&gLcd, "Y:", 1, 0); //Show the longitude
+    fmt_fixed(str_0, gGps.longitude, 6, 6, 11);
+    lcd_print(&gLcd, str_0, 1, 2);
+    fmt_uint(str_0, gGps.fix_quality, 1, ' ');
+    lcd_print(&gLcd, str_0, 0, 15); //Show the fix quality
+    fmt_uint(str_0, gGps.num_satellites, 2, ' ');
+    lcd_print(&gLcd, str_0, 1, 14); //Show the number of satellites
+    lcd_flush(&gLcd); //Returns at once, a busy transfer leaves the changes for the next refresh
+}
+
+///< Work of each event whatever the state, before its transition
+static void (*const service[EV_NUM])(const event_t *ev) = {
+    [EV_MPHONE_BLOCK] = service_mphone,
+    [EV_GPS_FIX] = service_gps,
+    [EV_LCD_TICK] = service_lcd,
+    [EV_USB_RX] = service_usb,
+};
 
-        uart_clear_FIFO(gGps.uart);
-        //enable the UART read interruption
-        uart_set_irq_enables(gGps.uart, true, false);
+/**
+ * @brief First release after the power on: core1 is parked while the system is dormant.
+ * 
+ */
+static bool guard_first_release(const event_t *ev)
+{
+    return !dsp_core_is_running();
+}
 
-        gps_check_data(&gGps);
+/**
+ * @brief The GPS is hooked and core1 is ready to process the blocks.
+ * 
+ */
+static bool guard_hooked(const event_t *ev)
+{
+    return gGps.valid && dsp_core_is_running();
+}
 
-        //Clear the flag
-        gFlags.B.uart_read = 0;  
+/**
+ * @brief The fix is still valid when the button is pressed: it may have aged since it was checked.
+ * 
+ */
+static bool guard_fix_valid(const event_t *ev)
+{
+    gps_check_data(&gGps);
+    return gGps.valid;
+}
+
+/**
+ * @brief The acquisition was stopped by an overrun or a late interrupt (the measurement has a gap), or the result was lost.
+ * 
+ */
+static bool guard_mphone_failed(const event_t *ev)
+{
+    return mphone_failed(&gMphone);
+}
+
+/**
+ * @brief The measurement has all its samples.
+ * 
+ */
+static bool guard_leq_done(const event_t *ev)
+{
+    return sResultValid && sResult.type == MPHONE_RESULT_LEQ;
+}
+
+/**
+ * @brief The alarm was set when the state was entered: an older one, still in the queue, is stale.
+ * 
+ */
+static bool guard_tick_fresh(const event_t *ev)
+{
+    return (int32_t)(ev->time_us - gSystem.state_us) >= 0;
+}
+
+/**
+ * @brief Like a power on button: power the modules, the system waits for the GPS to be hooked.
+ * 
+ */
+static void action_power_on(const event_t *ev)
+{
+    lcd_enable(&gLcd);
+    mphone_enable(&gMphone);
+    gps_enable(&gGps);
+    lcd_start_initialization(&gLcd);
+}
+
+/**
+ * @brief The button is released after the power on: prepare the microphone while the GPS hooks.
+ * 
+ */
+static void action_wait(const event_t *ev)
+{
+    printf_usb("WAIT \n");
+    gLed.time = 1000000;    ///< 1s
+    gLed.state = 1;         ///< Led on
+    led_setup_red(&gLed);   ///< Red led
+    mphone_configure_dma(&gMphone); ///< Configure the DMA for the microphone
+    dsp_core_launch(&gMphone); ///< Core1 processes the microphone blocks
+    mphone_maintain_store(&gMphone); ///< Erase the flash the next record needs, never while measuring
+    if (gSystem.usb){
+        printf("Boot: %lu us\n", (unsigned long)gSystem.boot_us);
+        mphone_print_summary(&gMphone);
+        gps_print_ttff(&gGps);
+        evq_print_stats(&gEvents);
+        swt_print_stats();
     }
-    if (gFlags.B.refresh_lcd){
-         //Show the data on the LCD
-        uint8_t str_0[16]; ///< Line 0 of the LCD
-
-        //Clear the LCD
-        //lcd_send_str_cursor(&gLcd, "                ", 0, 0);
-        //lcd_send_str_cursor(&gLcd, "                ", 1, 0);
-        sprintf((char *)str_0, "X: %f", gGps.latitude); 
-        lcd_send_str_cursor(&gLcd, (char *)str_0, 0, 0); //Show the latitude
-        sprintf((char *)str_0, "Y: %f", gGps.longitude);
-        lcd_send_str_cursor(&gLcd, (char *)str_0, 1, 0); //Show the longitude
-        sprintf((char *)str_0, "%d", gGps.fix_quality);
-        lcd_send_str_cursor(&gLcd, (char *)str_0, 0, 15); //Show the fix quality
-        sprintf((char *)str_0, "%d", gGps.num_satellites);
-        lcd_send_str_cursor(&gLcd, (char *)str_0, 1, 15); //Show the number of satellites
-
-        //Clear the flag
-        gFlags.B.refresh_lcd = 0;
+    lcd_refresh_start(LCD_REFRESH_US);
+}
+
+/**
+ * @brief Blink the red led while the GPS hooks.
+ * 
+ */
+static void action_blink(const event_t *ev)
+{
+    if (gLed.state){
+        led_setup_red(&gLed); ///< Red led
+        gLed.state = 0;
+    }else {
+        led_on(&gLed, 0x00);
+        led_set_alarm(&gLed);
+        gLed.state = 1;
     }
 }
 
-void gpioCallback(uint num, uint32_t mask) 
+/**
+ * @brief The GPS is hooked, the system is ready to measure.
+ * 
+ */
+static void action_ready(const event_t *ev)
 {
-    if (num == gButton.KEY.gpio_num) {
-        switch (gSystem.state)
-        {
-        case DORMANT: ///< Start the system when the button is pressed and the system is dormant. Like a power on button
-            gSystem.state = WAIT;   ///< The system is waiting for the GPS to be hooked.
-            button_setup_pwm_dbnc(&gButton); ///< Debounce setup
-            lcd_enable(&gLcd);
-            mphone_enable(&gMphone);
-            gps_enable(&gGps);
-            irq_set_enabled(gLed.timer_irq, true); ///< Enable the led timer
-            irq_set_enabled(TIMER_IRQ_1, true); ///< Enable the lcd refresh timer
-            lcd_initialization_timer_handler();
-            break;
-
-        case READY: ///< Start measuring the noise when the button is pressed and the system is ready
-            if (gGps.valid){
-                gSystem.state = MEASURE; ///< The system is measuring the noise
-                gMphone.lat_v = gGps.latitude; ///< Store the latitude of the place where the SPL was measured
-                gMphone.lon_v = gGps.longitude; ///< Store the longitude of the place where the SPL was measured
-                button_setup_pwm_dbnc(&gButton); ///< Debounce setup
-            }
-            else {
-                gSystem.state = ERROR; ///< The system is waiting for the GPS to be hooked
-                gFlags.B.error = 1; ///< The system is waiting for the GPS to be hooked
-            }
-            break;
+    led_setup_green(&gLed); ///< Green led
+}
+
+/**
+ * @brief Store the place and the time where the SPL is going to be measured.
+ * 
+ */
+static void action_arm(const event_t *ev)
+{
+    gMphone.lat_v = gGps.latitude; ///< Latitude in microdegrees
+    gMphone.lon_v = gGps.longitude; ///< Longitude in microdegrees
+    gMphone.time_v = gps_time_2000(&gGps); ///< With the date of RMC or NAV-TIMEUTC, else only the time of day
+    gMphone.ttff_v = gGps.ttff_ms; ///< Time to the first fix of the session, and its start
+    gMphone.gps_start_v = gGps.start;
+}
 
-        case MEASURE: ///< Stop measuring the noise when the button is pressed and the system is measuring. 
-            gSystem.state = ERROR; ///< An anomaly has occurred
-            button_setup_pwm_dbnc(&gButton); ///< Debounce setup
-            break;
+/**
+ * @brief The button is released: start the measurement, without its noise.
+ * 
+ */
+static void action_measure(const event_t *ev)
+{
+    printf_usb("MEASURE \n");
+    gLed.time = 10000000;       ///< 10s
+    led_setup_yellow(&gLed);    ///< Yellow led
+    mphone_set_weighting(&gMphone, MPHONE_DEFAULT_WEIGHTING); ///< Frequency weighting of this measurement
+    gMphone.dma_time = time_us_32(); ///< Start the DMA transfer
+    if (!dsp_core_pause()) printf_usb("Core1 was reset\n"); ///< Core1 leaves the last measurement before its state is reset
+    mphone_dma_trigger(&gMphone);   ///< Start the continuous DMA for the microphone
+    dsp_core_resume();
+    lcd_refresh_start(LCD_REFRESH_MEASURE_US); ///< Live level
+}
 
-        default: ///< The system is not ready to start the measurement
-            // printf_usb("Button pressed but the system is not ready\n");
-            break;
-        }
-    }
-    gpio_acknowledge_irq(num, mask); ///< gpio IRQ acknowledge
+/**
+ * @brief The measurement has all its samples: store its record.
+ * 
+ */
+static void action_done(const event_t *ev)
+{
+    mphone_dma_stop(&gMphone);
+    printf_usb("Microphone measurement done\n");
+    if (gSystem.usb) mphone_print_throughput(&gMphone);
+    if (gSystem.usb) mphone_print_time_weighting(&gMphone, &sResult);
+    mphone_calculate_spl(&gMphone, &sResult); ///< Calculate the Sound Pressure Level
+    gLed.time = 2000000;        ///< 2s
+    led_setup_orange(&gLed);    ///< Orange led
+    mphone_store_spl_location(&gMphone); ///< Append the record to the log in non-volatile memory
+    lcd_refresh_start(LCD_REFRESH_US);
 }
 
-void led_timer_handler(void)
+/**
+ * @brief An anomaly has occurred: discard the measurement in progress.
+ * 
+ */
+static void action_error(const event_t *ev)
 {
-    // Aknowledge the interrupt
-    hw_clear_bits(&timer_hw->intr, 1u << gLed.timer_irq);
+    printf_usb("ERROR \n");
+    mphone_dma_stop(&gMphone);  ///< Discard the measurement in progress
+    if (gSystem.usb && mphone_failed(&gMphone)) mphone_print_throughput(&gMphone);
+    gLed.time = 3000000;    ///< 3s
+    led_setup_red(&gLed);   ///< Red led
+    if (swt_active(&sLcdRefresh)) lcd_refresh_start(LCD_REFRESH_US);
+}
 
-    if (gSystem.state == WAIT){
-        if (gLed.state){
-            led_setup_red(&gLed); ///< Red led
-            gLed.state = 0;
-        }else {
-            led_on(&gLed, 0x00);
-            led_set_alarm(&gLed);
-            gLed.state = 1;
-        }
-        if (gGps.valid == 1) {
-            gSystem.state = READY; ///< The system is ready to measure
-            led_setup_green(&gLed); ///< Green led
-        }
-    }
-    else if (gSystem.state == DONE || gSystem.state == ERROR){
-        led_off(&gLed);
-        lcd_disable(&gLcd);
-        mphone_disable(&gMphone);
-        gps_disable(&gGps);
-        irq_set_enabled(gLed.timer_irq, false); ///< Disable the led timer
-        irq_set_enabled(TIMER_IRQ_1, false); ///< Disable the lcd refresh timer
-        gSystem.state = DORMANT; ///< The system is going to DORMANT state
+/**
+ * @brief Power off the modules, the system goes dormant.
+ * 
+ */
+static void action_power_off(const event_t *ev)
+{
+    led_off(&gLed);
+    lcd_disable(&gLcd);
+    mphone_disable(&gMphone);
+    gps_disable(&gGps);
+    swt_cancel(&gLed.timer); ///< Stop the led timer
+    swt_cancel(&sLcdRefresh); ///< Stop the lcd refresh timer
+}
+
+/**
+ * @brief A transition of the system: in state, on event and if guard, run action and go to next.
+ * 
+ */
+typedef struct{
+    uint8_t state;      ///< State of system_t
+    uint8_t event;      ///< event_type_t
+    bool (*guard)(const event_t *ev);   ///< NULL: always
+    void (*action)(const event_t *ev);  ///< NULL: none
+    uint8_t next;       ///< State of system_t
+}transition_t;
+
+///< The first transition of the state and the event whose guard passes is taken, the events without one are ignored
+static const transition_t transitions[] = {
+    {DORMANT, EV_BUTTON,         NULL,             action_power_on,  WAIT},
+    {WAIT,    EV_BUTTON_RELEASE, guard_first_release, action_wait,   WAIT},
+    {WAIT,    EV_LED_TICK,       NULL,             action_blink,     WAIT},
+    {WAIT,    EV_GPS_FIX,        guard_hooked,     action_ready,     READY},
+    {READY,   EV_BUTTON,         guard_fix_valid,  action_arm,       MEASURE},
+    {READY,   EV_BUTTON,         NULL,             action_error,     ERROR},
+    {MEASURE, EV_BUTTON_RELEASE, NULL,             action_measure,   MEASURE},
+    {MEASURE, EV_BUTTON,         NULL,             action_error,     ERROR},
+    {MEASURE, EV_MPHONE_BLOCK,   guard_mphone_failed, action_error,  ERROR},
+    {MEASURE, EV_MPHONE_BLOCK,   guard_leq_done,   action_done,      DONE},
+    {DONE,    EV_LED_TICK,       guard_tick_fresh, action_power_off, DORMANT},
+    {ERROR,   EV_LED_TICK,       guard_tick_fresh, action_power_off, DORMANT},
+};
+
+void program(const event_t *ev)
+{
+    if (ev->type < EV_NUM && service[ev->type]) service[ev->type](ev);
+
+    for (uint8_t i = 0; i < sizeof(transitions)/sizeof(transitions[0]); i++){
+        const transition_t *t = &transitions[i];
+        if (t->state != gSystem.state || t->event != ev->type) continue;
+        if (t->guard && !t->guard(ev)) continue;
+        gSystem.state_us = time_us_32(); ///< Before the action, which sets the alarms of the new state
+        if (t->action) t->action(ev);
+        gSystem.state = t->next;
+        return;
     }
+}
 
-    if (gSystem.state == MEASURE) {
-        if (gMphone.dma_done) { ///< The DMA transfer is done correctly
-            gFlags.B.mphone_dma = 1;
-            gMphone.dma_done = false;
-        }
-        else {
-            gFlags.B.error = 1; ///< An anomaly has occurred: the DMA transfer is not done after 10s
-            gSystem.state = ERROR; ///< An anomaly has occurred: the DMA transfer is not done after 10s
-            printf_usb("ERROR: DMA transfer not done\n");
-        }
+void program_idle(void)
+{
+    uexp_poll(&gExport, &gMphone.log, gSystem.state == MEASURE);
+}
+
+void gpioCallback(uint num, uint32_t mask) 
+{
+    if (num == gButton.KEY.gpio_num) {
+        button_setup_pwm_dbnc(&gButton); ///< Debounce setup, the release is posted by the debouncer
+        event_t ev = {.type = EV_BUTTON, .button = {.gpio = num, .mask = mask}};
+        evq_post(&gEvents, &ev);
     }
+    gpio_acknowledge_irq(num, mask); ///< gpio IRQ acknowledge
 }
 
-void lcd_refresh_handler(void)
+void led_timer_handler(swt_timer_t *timer)
 {
-    // Set the alarm
-    hw_clear_bits(&timer_hw->intr, 1u << TIMER_IRQ_1);
+    evq_post_type(&gEvents, EV_LED_TICK);
+}
+
+void lcd_refresh_handler(swt_timer_t *timer)
+{
+    evq_post_type(&gEvents, EV_LCD_TICK);
+}
 
-    gFlags.B.refresh_lcd = true;
+void lcd_refresh_start(uint32_t period_us)
+{
+    swt_start(&sLcdRefresh, 0, period_us, period_us/LCD_REFRESH_SLACK_DIV); ///< A refresh now, then every period
+}
 
-    // Setting the IRQ handler
-    irq_set_exclusive_handler(TIMER_IRQ_1, lcd_refresh_handler);
-    irq_set_enabled(TIMER_IRQ_1, true);
-    hw_set_bits(&timer_hw->inte, 1u << TIMER_IRQ_1); // Enable alarm0 for signal value calculation
-    timer_hw->alarm[1] = (uint32_t)(time_us_64() + 1000000); // Set alarm0 to trigger in t_sample
+void usb_rx_callback(void *param)
+{
+    evq_post_type(&gEvents, EV_USB_RX);
 }
 
 void uart_read_handler(void)
 {   
-    char data = uart_getc(gGps.uart);
-    //printf("%c", data);
-
-    if (data == '$')
-    {
-        //Start of the data
-        gGps.buffer_index = 0;
-        gGps.data_available = true;
-        //led_on(&gLed, 0x06); //Led on yellow
-    }
-    
-    if ((data == '\r' || data == '\n' )&& gGps.data_available){
-        //End of the data
-        gGps.buffer[gGps.buffer_index] = '\0';
-        gGps.data_available = false;
-        gFlags.B.uart_read = 1;
-        gGps.buffer_index = 0;
-
-        //Disable the UART read interruption
-        uart_set_irq_enables(gGps.uart, false, false);
-        
-    }
-    else if (gGps.data_available && gGps.buffer_index < 255) {
-        //Append the data to the buffer
-        gGps.buffer[gGps.buffer_index] = data;
-        gGps.buffer_index++;
-    }
-    else if (gGps.buffer_index >= 255){
-        //Buffer overflow
-        gGps.buffer_index = 0;
-        gGps.data_available = false;
+    if (gps_receive(&gGps)) {
+        event_t ev = {.type = EV_GPS_FIX, .published = true}; ///< A frame with a correct checksum published a new fix
+        evq_post(&gEvents, &ev);
     }
 }
 
 void dma_handler(void)
 {
-    dma_irqn_acknowledge_channel(gMphone.dma_irq, gMphone.dma_chan); ///< Acknowledge the DMA IRQ
-    gMphone.dma_done = true; ///< Set the flag that indicates that the DMA has finished
-    gMphone.dma_time = time_us_32() - gMphone.dma_time; ///< Calculate the time which takes the DMA to transfer the data 
-    uint8_t str[20];
-    sprintf((char *)str, "DMA time: %d us\n", gMphone.dma_time);
-    printf_usb((char *)str);
+    if (mphone_dma_block_done(&gMphone)){ ///< A block of the ping-pong buffer is ready
+        gMphone.dma_time = time_us_32(); ///< Time stamp of the block
+        event_t ev = {.type = EV_MPHONE_BLOCK, .block_us = gMphone.dma_time};
+        evq_post(&gEvents, &ev);
+    }
 }
 
 void pwm_handler(void)
 {
     bool button;
-    switch (pwm_get_irq_status_mask())
-    {
-    case 0x01UL:
+    uint32_t mask = pwm_get_irq_status_mask(); ///< Both slices can be pending at once
+    if (mask & (1u << GPS_RX_SLICE)){
+        pwm_clear_irq(GPS_RX_SLICE); // Acknowledge the GPS receive backstop
+        bool published = gps_receive(&gGps);
+        if (published || gGps.valid) {
+            event_t ev = {.type = EV_GPS_FIX, .published = published}; ///< A new fix, or check the age of the valid one
+            evq_post(&gEvents, &ev);
+        }
+    }
+    if (mask & 0x01UL){
         button = gpio_get(gButton.KEY.gpio_num);
         if(button_is_2nd_zero(&gButton)){
             if(!button){
                 button_set_irq_enabled(&gButton, true); ///< Enable the GPIO IRQs
                 pwm_set_enabled(0, false);      ///< Disable the button debouncer
                 gButton.KEY.dbnc = 0;
-                switch (gSystem.state)
-                {
-                case WAIT:
-                    gFlags.B.wait = 1; ///< The systen just power on and is waiting for the GPS to hook
-                    break;
-                case MEASURE:
-                    gFlags.B.meas = 1; ///< Start the measurement
-                    break;
-                case ERROR:
-                    gFlags.B.error = 1; ///< An anomaly has occurred
-                    break;
-                default:
-                    break;
-                }
+                evq_post_type(&gEvents, EV_BUTTON_RELEASE);
             }
             else
                 button_clr_zflag(&gButton);
@@ -411,14 +561,22 @@ void pwm_handler(void)
                 button_set_zflag(&gButton);
         }
         pwm_clear_irq(0); // Acknowledge slice 2 PWM IRQ
-        break;
-    
-    default:
-        break;
     }
 }
 
 
+/**
+ * @brief Print a frequency of measure_freqs() if the USB is connected.
+ * 
+ */
+static void print_khz_usb(const char *name, uint32_t khz)
+{
+    char str[FMT_MAX];
+    fmt_uint(str, khz, 0, ' ');
+    if (gSystem.usb)
+        printf("%s = %skHz\n", name, str);
+}
+
 void measure_freqs(void)
 {
     uint f_pll_sys = frequency_count_khz(CLOCKS_FC0_SRC_VALUE_PLL_SYS_CLKSRC_PRIMARY);
@@ -430,30 +588,14 @@ void measure_freqs(void)
     uint f_clk_adc = frequency_count_khz(CLOCKS_FC0_SRC_VALUE_CLK_ADC);
     uint f_clk_rtc = frequency_count_khz(CLOCKS_FC0_SRC_VALUE_CLK_RTC);
 
-    uint8_t str[30];
-    sprintf((char *)str, "pll_sys = %dkHz\n", f_pll_sys);
-    printf_usb((char *)str);
-
-    sprintf((char *)str, "pll_usb = %dkHz\n", f_pll_usb);
-    printf_usb((char *)str);
-
-    sprintf((char *)str, "rosc = %dkHz\n", f_rosc);
-    printf_usb((char *)str);
-
-    sprintf((char *)str, "clk_sys = %dkHz\n", f_clk_sys);
-    printf_usb((char *)str);
-
-    sprintf((char *)str, "clk_peri = %dkHz\n", f_clk_peri);
-    printf_usb((char *)str);
-
-    sprintf((char *)str, "clk_usb = %dkHz\n", f_clk_usb);
-    printf_usb((char *)str);
-
-    sprintf((char *)str, "clk_adc = %dkHz\n", f_clk_adc);
-    printf_usb((char *)str);
-
-    sprintf((char *)str, "clk_rtc = %dkHz\n", f_clk_rtc);
-    printf_usb((char *)str);
+    print_khz_usb("pll_sys", f_pll_sys);
+    print_khz_usb("pll_usb", f_pll_usb);
+    print_khz_usb("rosc", f_rosc);
+    print_khz_usb("clk_sys", f_clk_sys);
+    print_khz_usb("clk_peri", f_clk_peri);
+    print_khz_usb("clk_usb", f_clk_usb);
+    print_khz_usb("clk_adc", f_clk_adc);
+    print_khz_usb("clk_rtc", f_clk_rtc);
     // Can't measure clk_ref / xosc as it is the ref
 }
 
@@ -13,22 +13,12 @@
 
 #include <stdint.h>
 
-/**
- * @brief This typedef is for generate a word on we have the flags of interrups pending.
- * @typedef flags_t
- */
-typedef union{
-    uint8_t W;
-    struct{
-        uint8_t wait         :1; ///<  Button interruption pending: power on the system
-        uint8_t meas         :1; ///< Button interruption pending: start the measurement
-        uint8_t error        :1; ///< Button interruption pending: error
-        uint8_t mphone_dma   :1; ///< DMA interruption pending
-        uint8_t uart_read    :1; //uart read interruption pending
-        uint8_t refresh_lcd  :1; //refresh lcd interruption pending
-        uint8_t              :2;
-    }B;
-}flags_t;
+#include "event.h"
+#include "sw_timer.h"
+
+#define LCD_REFRESH_US 1000000          ///< Period of the LCD refresh
+#define LCD_REFRESH_MEASURE_US 100000   ///< Period of the LCD refresh while measuring, live level at 10 Hz
+#define LCD_REFRESH_SLACK_DIV 10        ///< A refresh may be a tenth of its period late, to share the wakeup of the LED
 
 /**
  * @brief This typedef indicates the global system state.
@@ -44,7 +34,9 @@ typedef struct _system_t{
         DONE,       ///< The system has finished the measurement and is sending the data (orange led)
         ERROR       ///< An anomaly has occurred (red led for 3s)
     } state;
+    uint32_t state_us; ///< time_us_32() when the state was entered
     bool usb; ///< USB is connected (available for the user)
+    uint32_t boot_us; ///< Time from the reset to the end of the initialization, in us
 } system_t;
 
 /**
@@ -53,6 +45,12 @@ typedef struct _system_t{
  */
 void initGlobalVariables(void);
 
+/**
+ * \var gEvents
+ * \brief Events posted by the interruptions to the main loop
+ */
+extern evq_t gEvents;
+
 /**
  * @brief This function initializes a PWM signal as a periodic interrupt timer (PIT).
  * Each slice will generate interruptions at a period of milis miliseconds.
@@ -66,10 +64,20 @@ void initGlobalVariables(void);
 void initPWMasPIT(uint8_t slice, uint16_t milis, bool enable);
 
 /**
- * @brief This function is the main, here the program is executed when a flag of interruption is pending.
+ * @brief This function is the main, here the program is executed for each event popped from the queue:
+ * the work of the event whatever the state, then the transition of the state on the event.
+ * The interruptions only post events, the state is only changed here.
  * 
+ * @param ev Event popped from gEvents
  */
-void program(void);
+void program(const event_t *ev);
+
+/**
+ * @brief Work done each time the event queue is empty, before the core sleeps: the export requests
+ * whose EV_USB_RX was dropped from a full queue, or received after the callback, are answered here.
+ * 
+ */
+void program_idle(void);
 
 /**
  * @brief This function configures the clocks of the system.
@@ -106,17 +114,33 @@ void printf_usb(char *str);
 void gpioCallback(uint num, uint32_t mask);
 
 /**
- * @brief Handler for the programmable timer
+ * @brief Handler for the timer of the LED
+ * 
+ * @param timer
+ */
+void led_timer_handler(swt_timer_t *timer);
+
+/**
+ * @brief Handler for refresh the LCD, every LCD_REFRESH_US or LCD_REFRESH_MEASURE_US while measuring.
+ * Only the cells that change are sent
  * 
+ * @param timer
+ */
+void lcd_refresh_handler(swt_timer_t *timer);
 
+/**
+ * @brief Refresh the LCD now and then periodically.
+ * 
+ * @param period_us LCD_REFRESH_US, or LCD_REFRESH_MEASURE_US for the live level
  */
-void led_timer_handler(void);
+void lcd_refresh_start(uint32_t period_us);
 
 /**
- * @brief Handler for refresh the LCD
+ * @brief Callback of the USB stdio when characters are received.
  * 
+ * @param param Not used.
  */
-void lcd_refresh_handler(void);
+void usb_rx_callback(void *param);
 
 /**
  * @brief Handler for the DMA interruption
@@ -131,7 +155,7 @@ void dma_handler(void);
 void pwm_handler(void);
 
 /*
- * @brief Handler for the UART read pending interruption
+ * @brief Handler for the UART RX timeout interruption of the GPS, the bytes come from the DMA ring
  * 
  */
 void uart_read_handler(void);
@@ -17,6 +17,9 @@
 #include "hardware/timer.h"
 
 #include "functs.h"
+#include "sw_timer.h"
+
+#define LED_TIMER_SLACK_US 50000 ///< The LED may change this late, to share the wakeup of the LCD refresh
 
 typedef struct
 {
@@ -27,7 +30,7 @@ typedef struct
     uint8_t lsb_rgb;    ///< LSB of the RGB LED
     uint8_t color;      ///< Value of the RGB LED
     uint32_t time;      ///< Time (us) for the RGB LED
-    uint8_t timer_irq;  ///< Alarm timer IRQ number (TIMER_IRQ_0)
+    swt_timer_t timer;  ///< One-shot timer of the LED, see led_timer_handler()
 
 }led_rgb_t;
 
@@ -43,7 +46,7 @@ static inline void led_init(led_rgb_t *led, uint8_t lsb_rgb, uint32_t time)
     led->state = true;
     led->color = 0x00;
     led->time = time;
-    led->timer_irq = TIMER_IRQ_2;
+    swt_timer_init(&led->timer, led_timer_handler, led);
     gpio_init_mask(0x00000007 << lsb_rgb); // gpios for key rows 2,3,4,5
     gpio_set_dir_masked(0x00000007 << lsb_rgb, 0x00000007 << lsb_rgb); // rows as outputs
     gpio_put_masked(0x00000007 << lsb_rgb, 0x00000000);
@@ -57,14 +60,7 @@ static inline void led_init(led_rgb_t *led, uint8_t lsb_rgb, uint32_t time)
  */
 static inline void led_set_alarm(led_rgb_t *led)
 {
-    // Interrupt acknowledge
-    hw_clear_bits(&timer_hw->intr, 1u << led->timer_irq);
-
-    // Setting the IRQ handler
-    irq_set_exclusive_handler(led->timer_irq, led_timer_handler);
-    irq_set_enabled(led->timer_irq, true);
-    hw_set_bits(&timer_hw->inte, 1u << led->timer_irq); ///< Enable alarm0 interrupt
-    timer_hw->alarm[led->timer_irq] = (uint32_t)(time_us_64() + led->time); ///< Set alarm1 to trigger in 100ms
+    swt_start(&led->timer, led->time, 0, LED_TIMER_SLACK_US); ///< led_timer_handler() in led->time us
 }
 
 /**
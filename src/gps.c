@@ -8,17 +8,35 @@ void gps_init(gps_t *gps, uart_inst_t *uart, uint8_t rx, uint8_t tx, uint32_t ba
     gps->tx = tx;
     gps->baudrate = baudrate;
     gps->status = false;
-    gps->data_available = false;
     gps->valid = false;
     gps->fix_quality = 0;
     gps->num_satellites = 0;
+    gps->latitude = 0;
+    gps->longitude = 0;
+    gps->hdop = 0;
+    gps->fix_us = time_us_32();
+    gps->h_acc_mm = 0;
+    gps->rx_us = gps->fix_us;
+    gps_set_validity(gps, GPS_VALID_MIN_SATELLITES, GPS_VALID_MAX_HDOP, GPS_VALID_MAX_H_ACC_MM, GPS_VALID_MAX_AGE_MS);
 
-    //Initialize the GPS buffer with 0
-    memset(gps->buffer, 0, sizeof(gps->buffer));
-    gps->buffer_index = 0;
+    //Initialize the NMEA and UBX parsers, without a fix
+    nmea_init(&gps->nmea);
+    ubx_init(&gps->ubx);
+    gps->ubx_active = false;
+    gps->profile_pending = false;
+    gps_set_profile(gps, GPS_PROFILE_BAUDRATE, GPS_PROFILE_RATE_MS, GPS_PROFILE_UBX, GPS_PROFILE_NMEA_MASK);
     
+    // The first session is a cold start, the receiver has never been powered
+    gps->power_mode = GPS_POWER_MODE;
+    gps->backup = false;
+    gps->start = GPS_START_COLD;
+    gps->session_us = gps->fix_us;
+    gps->ttff_ms = 0;
+    memset(gps->ttff, 0, sizeof(gps->ttff));
+
     // Initialize the UART
     uart_init(gps->uart, gps->baudrate);
+    gps->uart_baudrate = gps->baudrate;
     gpio_set_function(gps->tx, GPIO_FUNC_UART);
     gpio_pull_up(gps->tx);
     gpio_set_function(gps->rx, GPIO_FUNC_UART);
@@ -29,6 +47,38 @@ void gps_init(gps_t *gps, uart_inst_t *uart, uint8_t rx, uint8_t tx, uint32_t ba
     gpio_set_dir(en_gpio, GPIO_OUT);
     gpio_put(en_gpio, 0);
 
+    // Receive with the DMA in a ring: the write address wraps on the aligned buffer and the
+    // transfer count, started at its maximum, counts down the bytes written
+    gps->dma_chan = dma_claim_unused_channel(true);
+    gps->rx_tail = 0;
+    gps->rx_overruns = 0;
+    dma_channel_config c = dma_channel_get_default_config(gps->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, GPS_RX_RING_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(gps->uart, false));
+    dma_channel_configure(gps->dma_chan, &c, gps->rx_ring, &uart_get_hw(gps->uart)->dr, UINT32_MAX, true);
+
+    // Transmit the commands by DMA, one at a time from the queue
+    gps->tx_dma_chan = dma_claim_unused_channel(true);
+    gps->cmd_head = 0;
+    gps->cmd_tail = 0;
+    gps->cmd_state = GPS_CMD_IDLE;
+    gps->cmd_tries = 0;
+    gps->cmd_acks = 0;
+    gps->cmd_naks = 0;
+    gps->cmd_timeouts = 0;
+    c = dma_channel_get_default_config(gps->tx_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, uart_get_dreq(gps->uart, true));
+    dma_channel_configure(gps->tx_dma_chan, &c, &uart_get_hw(gps->uart)->dr, NULL, 0, false);
+
+    // Backstop that drains the ring while the UART does not go idle
+    initPWMasPIT(GPS_RX_SLICE, GPS_RX_POLL_MS, false);
+
     // Set the handler for the UART
     if (gps->uart == uart0) {
         irq_set_exclusive_handler(UART0_IRQ, uart_read_handler);
@@ -39,14 +89,39 @@ void gps_init(gps_t *gps, uart_inst_t *uart, uint8_t rx, uint8_t tx, uint32_t ba
         irq_set_enabled(UART1_IRQ, true);
     }
 
-    // Set the UART IRQ enables for read data
-    uart_set_irq_enables(gps->uart, true, false);
+    // Only the RX timeout interrupt: the line is idle after a burst of sentences
+    uart_get_hw(gps->uart)->imsc = UART_UARTIMSC_RTIM_BITS;
+}
+
+/**
+ * @brief Next free command of the queue, NULL if it is full.
+ * 
+ */
+static gps_cmd_t *gps_cmd_alloc(gps_t *gps)
+{
+    if ((uint8_t)(gps->cmd_head - gps->cmd_tail) >= GPS_CMD_QUEUE) return NULL;
+    return &gps->cmd[gps->cmd_head & (GPS_CMD_QUEUE - 1)];
+}
+
+/**
+ * @brief Publish the command written in gps_cmd_alloc() and start it if the queue was idle.
+ * 
+ */
+static void gps_cmd_push(gps_t *gps)
+{
+    __sync_synchronize(); ///< The command is written before the interrupts see it
+    gps->cmd_head++;
+    uint32_t irq = save_and_disable_interrupts(); ///< gps_tx_poll() also runs in the receive interrupts
+    gps_tx_poll(gps);
+    restore_interrupts(irq);
 }
 
-void gps_send_command(gps_t *gps, char *command)
+bool gps_send_command(gps_t *gps, char *command)
 {
+    gps_cmd_t *cmd = gps_cmd_alloc(gps);
+    size_t len = strlen(command);
+    if (!cmd || len + 5 > GPS_CMD_MAX) return false; ///< '*', checksum, CR and LF
     char checksum = command[1];
-    char check_char[3] = {0};
     
     uint8_t i = 0;
 
@@ -55,188 +130,393 @@ void gps_send_command(gps_t *gps, char *command)
         checksum ^= command[i];
     }
 
-    // Convert checksum to ASCII
-    check_char[0] = (checksum >> 4) < 10 ? (checksum >> 4) + '0' : (checksum >> 4) - 10 + 'A';
-    check_char[1] = (checksum & 0x0F) < 10 ? (checksum & 0x0F) + '0' : (checksum & 0x0F) - 10 + 'A';
-
-    // Send command and checksum
-    uart_write(uart0, (uint8_t *)command, strlen(command));
-    uart_write(uart0, (uint8_t *)"*", 1);
-    uart_write(uart0, (uint8_t *)check_char, 2);
-    uart_write(uart0, (uint8_t *)"\r\n", 2);
+    // Command, '*', checksum in ASCII and CR LF
+    memcpy(cmd->data, command, len);
+    cmd->data[len++] = '*';
+    cmd->data[len++] = (checksum >> 4 & 0x0F) < 10 ? (checksum >> 4 & 0x0F) + '0' : (checksum >> 4 & 0x0F) - 10 + 'A';
+    cmd->data[len++] = (checksum & 0x0F) < 10 ? (checksum & 0x0F) + '0' : (checksum & 0x0F) - 10 + 'A';
+    cmd->data[len++] = '\r';
+    cmd->data[len++] = '\n';
+    cmd->len = len;
+    cmd->wait_ack = false; ///< NMEA commands are not matched with their answer
+    cmd->baudrate = 0;
+    gps_cmd_push(gps);
+    return true;
+}
 
-    // Wait for the response of the GPS module for 200ms min
+bool gps_send_ubx(gps_t *gps, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len, uint32_t baudrate)
+{
+    gps_cmd_t *cmd = gps_cmd_alloc(gps);
+    if (!cmd || len + UBX_OVERHEAD > GPS_CMD_MAX) return false;
+    cmd->len = ubx_frame(cmd->data, cls, id, payload, len);
+    cmd->cls = cls;
+    cmd->id = id;
+    cmd->wait_ack = !baudrate; ///< The ACK of a baudrate change comes at the new one, or gets lost
+    cmd->baudrate = baudrate;
+    gps_cmd_push(gps);
+    return true;
 }
 
-void gps_get_GNRMC(gps_t *gps)
+/**
+ * @brief The command at the head of the queue is finished, go to the next one.
+ * 
+ */
+static inline void gps_cmd_done(gps_t *gps)
 {
-    // printf("GPS data: %s\n", gps->buffer);
+    gps->cmd_tail++;
+    gps->cmd_state = GPS_CMD_IDLE;
+    gps->cmd_tries = 0;
+}
 
-    // Check if the GPS data is valid GNRMC or GPRMC
-    if (strncmp(gps->buffer, "$GNRMC", 6) != 0 && strncmp(gps->buffer, "$GPRMC", 6) != 0) {
-        // printf("Invalid GPS data format.\n");
-        return;
-    }
+void gps_tx_poll(gps_t *gps)
+{
+    while (gps->cmd_tail != gps->cmd_head) {
+        gps_cmd_t *cmd = &gps->cmd[gps->cmd_tail & (GPS_CMD_QUEUE - 1)];
+        switch (gps->cmd_state) {
+        case GPS_CMD_IDLE:
+            gps->ubx.ack = UBX_ACK_NONE; ///< Only an ACK received from now on matches
+            gps->cmd_tries++;
+            dma_channel_transfer_from_buffer_now(gps->tx_dma_chan, cmd->data, cmd->len);
+            gps->cmd_state = GPS_CMD_SENDING;
+            return;
 
-    // Parse the GPS data
-    char *token = strtok(gps->buffer, ",");
-    uint16_t field_index = 0;
-
-    while (token != NULL) {
-        //printf("Token: %s\n", token);
-        switch (field_index) {
-            case 1:  // Time
-                    // Extract hours
-                    gps->time_h = (token[0] - '0') * 10 + (token[1] - '0');
-                    // Extract minutes
-                    gps->time_m = (token[2] - '0') * 10 + (token[3] - '0');
-                    // Extract seconds
-                    gps->time_s = (token[4] - '0') * 10 + (token[5] - '0');
-                    // Extract milliseconds
-                    gps->time_ms = (token[7] - '0') * 10 + (token[8] - '0');
-                break;
-            case 2:  // Status
-                gps->status = (token[0] == 'A') ? 1 : 0; // 1: valid, 0: invalid
+        case GPS_CMD_SENDING:
+            if (dma_channel_is_busy(gps->tx_dma_chan)) return;
+            if (cmd->wait_ack) {
+                gps->cmd_deadline = time_us_32() + GPS_CMD_TIMEOUT_MS*1000;
+                gps->cmd_state = GPS_CMD_WAIT_ACK;
                 break;
-            case 3:  // Latitude
-                if (strlen(token) >= 4) {
-                    double lat_deg, lat_min;
-                    sscanf(token, "%2lf%lf", &lat_deg, &lat_min);
-                    gps->latitude = lat_deg + lat_min / 60.0;
-                }
-                break;
-            case 4:  // Latitude Direction
-                gps->latitude_area = token[0];
-                if (gps->latitude_area == 'S') {
-                    gps->latitude = -gps->latitude;
-                }
-                break;
-            case 5:  // Longitude
-                if (strlen(token) >= 5) {
-                    double lon_deg, lon_min;
-                    sscanf(token, "%3lf%lf", &lon_deg, &lon_min);
-                    gps->longitude = lon_deg + lon_min / 60.0;
-                }
+            }
+            if (cmd->baudrate) {
+                if (uart_get_hw(gps->uart)->fr & UART_UARTFR_BUSY_BITS) return; ///< The last bytes are still in the FIFO
+                uart_set_baudrate(gps->uart, cmd->baudrate);
+                gps->uart_baudrate = cmd->baudrate;
+            }
+            gps_cmd_done(gps);
+            break;
+
+        case GPS_CMD_WAIT_ACK:
+            if (gps->ubx.ack != UBX_ACK_NONE && gps->ubx.ack_cls == cmd->cls && gps->ubx.ack_id == cmd->id) {
+                if (gps->ubx.ack == UBX_ACK_OK) gps->cmd_acks++;
+                else gps->cmd_naks++;
+                gps_cmd_done(gps);
                 break;
-            case 6:  // Longitude Direction
-                gps->longitude_area = token[0];
-                if (gps->longitude_area == 'W') {
-                    gps->longitude = -gps->longitude;
-                }
+            }
+            if ((int32_t)(time_us_32() - gps->cmd_deadline) < 0) return;
+            if (gps->cmd_tries < GPS_CMD_RETRIES) {
+                gps->cmd_state = GPS_CMD_IDLE; ///< Send it again
                 break;
+            }
+            gps->cmd_timeouts++;
+            gps_cmd_done(gps);
+            break;
+
+        default:
+            gps_cmd_done(gps);
+            break;
         }
-        // Get the next token
-        token = strtok(NULL, ",");
-        field_index++;
     }
+}
+
+void gps_apply_profile(gps_t *gps)
+{
+    gps_profile_t *profile = &gps->profile;
+    uint32_t baudrate = profile->baudrate ? profile->baudrate : gps->baudrate;
 
-    // printf("Time: %d:%d:%d\n", gps->time_h, gps->time_m, gps->time_s);
-    // printf("Status: %d\n", gps->status);
-    // printf("Latitude: %f %c\n", gps->latitude, gps->latitude_area);
-    // printf("Longitude: %f %c\n", gps->longitude, gps->longitude_area);
+    // CFG-RATE: measurement period, one navigation solution per measurement, GPS time
+    uint8_t rate[UBX_CFG_RATE_LEN] = {(uint8_t)profile->rate_ms, (uint8_t)(profile->rate_ms >> 8), 1, 0, 1, 0};
+    gps_send_ubx(gps, UBX_CLASS_CFG, UBX_CFG_RATE, rate, sizeof(rate), 0);
+
+    // CFG-MSG: the navigation messages once per epoch, or the NMEA sentences of the mask
+    if (profile->ubx) {
+        static const uint8_t nav[] = {UBX_NAV_POSLLH, UBX_NAV_STATUS, UBX_NAV_SOL, UBX_NAV_TIMEUTC};
+        for (uint8_t i = 0; i < sizeof(nav); i++) {
+            uint8_t msg[UBX_CFG_MSG_LEN] = {UBX_CLASS_NAV, nav[i], 1};
+            gps_send_ubx(gps, UBX_CLASS_CFG, UBX_CFG_MSG, msg, sizeof(msg), 0);
+        }
+    }
+    else {
+        for (uint8_t i = 0; i < GPS_NMEA_NUM; i++) {
+            uint8_t msg[UBX_CFG_MSG_LEN] = {UBX_CLASS_NMEA, i, (profile->nmea_mask >> i) & 1};
+            gps_send_ubx(gps, UBX_CLASS_CFG, UBX_CFG_MSG, msg, sizeof(msg), 0);
+        }
+    }
+
+    // CFG-PRT: UART1 at the new baudrate, 8N1, UBX and NMEA in, UBX or NMEA out. The last one,
+    // the UART follows the baudrate when it has been sent
+    uint8_t prt[UBX_CFG_PRT_LEN] = {0};
+    prt[0] = 1;                                 ///< portID: UART1
+    prt[4] = 0xD0;                              ///< mode: 8 bits, no parity, 1 stop bit
+    prt[5] = 0x08;
+    prt[8] = (uint8_t)baudrate;
+    prt[9] = (uint8_t)(baudrate >> 8);
+    prt[10] = (uint8_t)(baudrate >> 16);
+    prt[11] = (uint8_t)(baudrate >> 24);
+    prt[12] = 0x03;                             ///< inProtoMask: UBX, NMEA
+    prt[14] = profile->ubx ? 0x01 : 0x02;       ///< outProtoMask: UBX or NMEA
+    gps_send_ubx(gps, UBX_CLASS_CFG, UBX_CFG_PRT, prt, sizeof(prt), baudrate);
 }
 
-void gps_get_GPGGA(gps_t *gps) {
-    // printf("GPS data: %s\n", gps->buffer);
-    gps->valid = false;
-    // Check if the GPS data is valid GPGGA
-    if (strncmp(gps->buffer, "$GPGGA", 6) != 0) {
-        // printf("Invalid GPS data format.\n");
+/**
+ * @brief Copy the UBX fix, NAV-STATUS gives the fix type instead of the GGA fix quality.
+ * 
+ */
+static void gps_update_ubx(gps_t *gps)
+{
+    ubx_fix_t fix;
+    ubx_read(&gps->ubx, &fix);
+
+    if (fix.utc_valid) {
+        gps->time_h = fix.time_ms/3600000;
+        gps->time_m = fix.time_ms/60000 % 60;
+        gps->time_s = fix.time_ms/1000 % 60;
+        gps->time_ms = fix.time_ms % 1000;
+        gps->date = fix.date;
+    }
+    switch (fix.gps_fix) { ///< To the GSA fix type
+    case UBX_FIX_2D:
+        gps->fix_type = 2;
+        break;
+    case UBX_FIX_3D:
+    case UBX_FIX_GPS_DR:
+        gps->fix_type = 3;
+        break;
+    default:
+        gps->fix_type = 1;
+        break;
+    }
+    gps->fix_quality = (fix.fix_ok && gps->fix_type >= 2) ? 1 : 0;
+    gps->status = gps->fix_quality;
+    gps->num_satellites = fix.num_sv;
+    gps->latitude = fix.lat;
+    gps->latitude_area = fix.lat < 0 ? 'S' : 'N';
+    gps->longitude = fix.lon;
+    gps->longitude_area = fix.lon < 0 ? 'W' : 'E';
+    gps->altitude = (fix.hmsl_dm > 0) ? fix.hmsl_dm/10 : 0;
+    gps->h_acc_mm = fix.h_acc_mm;
+}
+
+void gps_update_fix(gps_t *gps)
+{
+    if (gps->ubx_active) {
+        gps_update_ubx(gps);
         return;
     }
 
-    // Parse the GPS data
-    char *token = strtok(gps->buffer, ",");
-    uint16_t field_index = 0;
+    nmea_fix_t fix;
+    if (!nmea_read(&gps->nmea, &fix)) return; ///< No sentence yet
+    if (gps->profile_pending) { ///< The receiver is on and talks at the power on settings
+        gps->profile_pending = false;
+        gps_apply_profile(gps);
+    }
 
-    while (token != NULL) {
-        switch (field_index) {
-            case 1:  // Time
-                gps->time_h = (token[0] - '0') * 10 + (token[1] - '0');
-                gps->time_m = (token[2] - '0') * 10 + (token[3] - '0');
-                gps->time_s = (token[4] - '0') * 10 + (token[5] - '0');
-                break;
-            case 2:  // Latitude
-                if (strlen(token) >= 4) {
-                    double lat_deg, lat_min;
-                    sscanf(token, "%2lf%lf", &lat_deg, &lat_min);
-                    gps->latitude = lat_deg + lat_min / 60.0;
-                }
-                break;
-            case 3:  // Latitude Direction
-                gps->latitude_area = token[0];
-                if (gps->latitude_area == 'S') {
-                    gps->latitude = -gps->latitude;
-                }
-                break;
-            case 4:  // Longitude
-                if (strlen(token) >= 5) {
-                    double lon_deg, lon_min;
-                    sscanf(token, "%3lf%lf", &lon_deg, &lon_min);
-                    gps->longitude = lon_deg + lon_min / 60.0;
-                }
-                break;
-            case 5:  // Longitude Direction
-                gps->longitude_area = token[0];
-                if (gps->longitude_area == 'W') {
-                    gps->longitude = -gps->longitude;
-                }
-                break;
-            case 6:  // Fix Quality
-                gps->fix_quality = atoi(token); // 0: invalid, 1: GPS fix, 2: DGPS fix
-                break;
-            case 7:  // Number of Satellites
-                gps->num_satellites = atoi(token);
-                break;
-            case 9:  // Altitude
-                gps->altitude = atof(token);
-                break;
+    gps->time_h = fix.time_ms/3600000;
+    gps->time_m = fix.time_ms/60000 % 60;
+    gps->time_s = fix.time_ms/1000 % 60;
+    gps->time_ms = fix.time_ms % 1000;
+    gps->status = fix.status;
+    gps->latitude = fix.lat;
+    gps->latitude_area = fix.lat_area;
+    gps->longitude = fix.lon;
+    gps->longitude_area = fix.lon_area;
+    gps->fix_quality = fix.fix_quality; // 0: invalid, 1: GPS fix, 2: DGPS fix
+    gps->fix_type = fix.fix_type;
+    gps->num_satellites = fix.num_satellites;
+    gps->altitude = (fix.alt_dm > 0) ? fix.alt_dm/10 : 0;
+    gps->hdop = fix.hdop;
+    gps->speed_cms = fix.speed_cms;
+    gps->date = fix.date;
+}
+
+uint32_t gps_time_2000(const gps_t *gps)
+{
+    static const uint16_t days_before[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+    uint32_t seconds = gps->time_h*3600 + gps->time_m*60 + gps->time_s;
+    uint32_t day = gps->date/10000, month = gps->date/100 % 100, year = gps->date % 100; ///< ddmmyy, 20yy
+    if (!gps->date || day < 1 || day > 31 || month < 1 || month > 12) return seconds;
+
+    ///< Leap years from 2000 to 2099 are the multiples of 4, 2000 included
+    uint32_t days = 365*year + (year + 3)/4 + days_before[month - 1] + day - 1;
+    if (month > 2 && year % 4 == 0) days++;
+    return days*86400 + seconds;
+}
+
+/**
+ * @brief Bytes written by the DMA in the receive ring since it was started.
+ * 
+ */
+static inline uint32_t gps_rx_head(gps_t *gps)
+{
+    return ~dma_channel_hw_addr(gps->dma_chan)->transfer_count; ///< Counts down from UINT32_MAX
+}
+
+bool gps_receive(gps_t *gps)
+{
+    bool published = false;
+    uart_get_hw(gps->uart)->icr = UART_UARTICR_RTIC_BITS; ///< Acknowledge the RX timeout
+
+    uint32_t head = gps_rx_head(gps);
+    if (head - gps->rx_tail > GPS_RX_RING_SIZE) { ///< The DMA wrote over bytes not fed yet
+        gps->rx_tail = head - GPS_RX_RING_SIZE;
+        gps->rx_overruns++;
+    }
+    while (gps->rx_tail != head) { ///< Both parsers: '$' and 0xB5 start their frames, the other bytes are skipped cheaply
+        uint8_t c = gps->rx_ring[gps->rx_tail++ & (GPS_RX_RING_SIZE - 1)];
+        if (nmea_feed(&gps->nmea, (char)c)) {
+            published = true;
+            gps->rx_us = time_us_32();
+            if (gps->nmea.fix.sentence == NMEA_GGA) gps->fix_us = time_us_32(); ///< Age of the fix quality and the position
+        }
+        if (ubx_feed(&gps->ubx, c)) {
+            published = true;
+            gps->rx_us = time_us_32();
+            gps->ubx_active = true;
+            if (gps->ubx.fix.epoch_mask & (1u << UBX_MSG_POSLLH)) gps->fix_us = time_us_32();
         }
-        // Get the next token
-        token = strtok(NULL, ",");
-        field_index++;
     }
 
-    // printf("Time: %02d:%02d:%02d\n", gps->time_h, gps->time_m, gps->time_s);
-    // printf("Latitude: %.6f %c\n", gps->latitude, gps->latitude_area);
-    // printf("Longitude: %.6f %c\n", gps->longitude, gps->longitude_area);
-    // printf("Fix Quality: %d\n", gps->fix_quality);
-    // printf("Number of Satellites: %d\n", gps->num_satellites);
-    // printf("Altitude: %.2f meters\n", gps->altitude);
+    if (!dma_channel_is_busy(gps->dma_chan)) { ///< The count ran out (4 GB received): start again, the FIFO holds the bytes meanwhile
+        dma_channel_set_write_addr(gps->dma_chan, gps->rx_ring, false);
+        dma_channel_set_trans_count(gps->dma_chan, UINT32_MAX, true);
+        gps->rx_tail = 0;
+    }
+
+    gps_tx_poll(gps); ///< An ACK may have arrived, or the command queue may be waiting for a timeout
+
+    // Silent receiver: it may have kept the profile baudrate in its backup mode, or lost it with
+    // the backup supply. Alternate between the power on and the profile baudrates until it talks
+    if (gps->enable && gps->cmd_tail == gps->cmd_head && gps->profile.baudrate && gps->profile.baudrate != gps->baudrate &&
+        time_us_32() - gps->rx_us >= GPS_BAUD_PROBE_MS*1000) {
+        gps->uart_baudrate = (gps->uart_baudrate == gps->baudrate) ? gps->profile.baudrate : gps->baudrate;
+        uart_set_baudrate(gps->uart, gps->uart_baudrate);
+        gps->rx_us = time_us_32();
+    }
+    return published;
 }
 
 void gps_check_data(gps_t *gps)
 {
-    // Verificar calidad del fix y número de satélites
-    if (gps->fix_quality >= 1 && gps->num_satellites >= 3) {
-        // Verificar latitud y hemisferio
-        if (gps->latitude != 0.0 && (gps->latitude_area == 'N' || gps->latitude_area == 'S')) {
-            // Verificar longitud y hemisferio
-            if (gps->longitude != 0.0 && (gps->longitude_area == 'E' || gps->longitude_area == 'W')) {
-                gps->valid = true;
-                return;
-            }
+    gps->valid = false;
+    // Verificar calidad del fix, número de satélites y edad del fix
+    if (gps->fix_quality < 1) return;
+    if ((time_us_32() - gps->fix_us)/1000 >= gps->validity.max_age_ms) return;
+    if (gps->ubx_active) {
+        // UBX: un fix 3D (4 satélites o más) y la precisión horizontal estimada
+        if (gps->fix_type < 3) return;
+        if (gps->validity.max_h_acc_mm && gps->h_acc_mm >= gps->validity.max_h_acc_mm) return;
+    }
+    else {
+        // NMEA: número de satélites y la precisión horizontal, si el GPS no la da el fix no es válido
+        if (gps->num_satellites < gps->validity.min_satellites) return;
+        if (gps->validity.max_hdop && (gps->hdop == 0 || gps->hdop >= gps->validity.max_hdop)) return;
+    }
+    // Verificar latitud, longitud y hemisferios
+    if (gps->latitude == 0 || (gps->latitude_area != 'N' && gps->latitude_area != 'S')) return;
+    if (gps->longitude == 0 || (gps->longitude_area != 'E' && gps->longitude_area != 'W')) return;
+    gps->valid = true;
+
+    // Primer fix válido de la sesión: tiempo hasta el fix (TTFF) según el tipo de arranque
+    if (gps->enable && gps->ttff_ms == 0) {
+        gps_ttff_stats_t *stats = &gps->ttff[gps->start];
+        gps->ttff_ms = (time_us_32() - gps->session_us)/1000;
+        if (gps->ttff_ms == 0) gps->ttff_ms = 1; ///< 0 is no fix yet
+        stats->last_ms = gps->ttff_ms;
+        if (stats->fixes == 0 || gps->ttff_ms < stats->min_ms) stats->min_ms = gps->ttff_ms;
+        if (gps->ttff_ms > stats->max_ms) stats->max_ms = gps->ttff_ms;
+        stats->sum_ms += gps->ttff_ms;
+        stats->fixes++;
+    }
+}
+
+void gps_print_ttff(gps_t *gps)
+{
+    static const char *start[GPS_START_NUM] = {"cold", "hot"};
+    for (uint8_t i = 0; i < GPS_START_NUM; i++) {
+        gps_ttff_stats_t *stats = &gps->ttff[i];
+        if (!stats->fixes) {
+            printf("TTFF %s: %lu sessions, no fix\n", start[i], (unsigned long)stats->sessions);
+            continue;
         }
+        uint32_t mean_ms = (uint32_t)(stats->sum_ms/stats->fixes);
+        printf("TTFF %s: %lu/%lu sessions, last %lu ms, min %lu ms, max %lu ms, mean %lu ms, %lu mAs\n", start[i],
+               (unsigned long)stats->fixes, (unsigned long)stats->sessions, (unsigned long)stats->last_ms,
+               (unsigned long)stats->min_ms, (unsigned long)stats->max_ms, (unsigned long)mean_ms,
+               (unsigned long)(mean_ms*GPS_WAIT_CURRENT_MA/1000)); ///< Charge spent waiting for the mean fix
     }
-    gps->valid = false;
+}
+
+void gps_tx_flush(gps_t *gps)
+{
+    while (gps->cmd_tail != gps->cmd_head) {
+        uint32_t irq = save_and_disable_interrupts();
+        gps_tx_poll(gps);
+        restore_interrupts(irq);
+    }
+    while (uart_get_hw(gps->uart)->fr & UART_UARTFR_BUSY_BITS) tight_loop_contents(); ///< The last bytes leave the FIFO
 }
 
 void gps_enable(gps_t *gps)
 {
     // Enable the GPS module
     gpio_put(gps->en_gpio, 1);
-    // Clear the UART FIFO
-    uart_clear_FIFO(gps->uart);
+    // A new session: hot start if the receiver kept its ephemeris in the backup mode
+    gps->start = gps->backup ? GPS_START_HOT : GPS_START_COLD;
+    gps->session_us = time_us_32();
+    gps->rx_us = gps->session_us;
+    gps->ttff_ms = 0;
+    gps->ttff[gps->start].sessions++;
+    // Skip the bytes received while it was off, and start the backstop
+    gps->rx_tail = gps_rx_head(gps);
+    // The receiver starts in NMEA at the power on baudrate, apply the profile when it talks
+    gps->ubx_active = false;
+    gps->profile_pending = true;
+    pwm_set_enabled(GPS_RX_SLICE, true);
     gps->enable = true;
+    if (gps->backup) { ///< Any byte on RX wakes the receiver, it ignores the first ones
+        gps_cmd_t *cmd = gps_cmd_alloc(gps);
+        if (cmd) {
+            memset(cmd->data, 0xFF, GPS_WAKE_BYTES);
+            cmd->len = GPS_WAKE_BYTES;
+            cmd->wait_ack = false;
+            cmd->baudrate = 0;
+            gps_cmd_push(gps);
+        }
+        gps->backup = false;
+    }
 }
 
 void gps_disable(gps_t *gps)
 {
-    // Disable the GPS module
-    gpio_put(gps->en_gpio, 0);
-    // Clear the UART FIFO
-    uart_clear_FIFO(gps->uart);
+    // Stop the backstop, the DMA keeps the UART FIFO empty
+    pwm_set_enabled(GPS_RX_SLICE, false);
+    // Drop the commands
+    uint32_t irq = save_and_disable_interrupts(); ///< gps_tx_poll() in the receive interrupts would start the next one
+    dma_channel_abort(gps->tx_dma_chan);
+    gps->cmd_tail = gps->cmd_head;
+    gps->cmd_state = GPS_CMD_IDLE;
+    gps->cmd_tries = 0;
+    restore_interrupts(irq);
     gps->enable = false;
+
+    if (gps->power_mode == GPS_POWER_BACKUP) {
+        // Keep the supply: RXM-PMREQ, backup mode until a byte on RX. The receiver keeps its
+        // ephemeris, almanac and configuration (and baudrate) for a hot start. It does not answer
+        static const uint8_t pmreq[UBX_RXM_PMREQ_LEN] = {0, 0, 0, 0, 0x02, 0, 0, 0}; ///< duration: infinite, flags: backup
+        gps_cmd_t *cmd = gps_cmd_alloc(gps);
+        cmd->len = ubx_frame(cmd->data, UBX_CLASS_RXM, UBX_RXM_PMREQ, pmreq, sizeof(pmreq));
+        cmd->cls = UBX_CLASS_RXM;
+        cmd->id = UBX_RXM_PMREQ;
+        cmd->wait_ack = false;
+        cmd->baudrate = 0;
+        gps_cmd_push(gps);
+        gps->backup = true;
+        return;
+    }
+    // Disable the GPS module, it returns to the power on baudrate
+    gpio_put(gps->en_gpio, 0);
+    gps->backup = false;
+    gps->uart_baudrate = gps->baudrate;
+    uart_set_baudrate(gps->uart, gps->baudrate);
 }
 
 void uart_read(uart_inst_t *uart, uint8_t *data, uint16_t len)
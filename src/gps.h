@@ -23,8 +23,14 @@
 #include "hardware/uart.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
 
 #include "functs.h"
+#include "nmea.h"
+#include "ubx.h"
+
+// MTK commands ($PMTK, L76X), the u-blox receivers (NEO-6M) ignore them and use UBX, see gps_apply_profile()
 
 //Startup mode
 #define GPS_HOT_START       "$PMTK101"
@@ -83,9 +89,128 @@
 #define GPS_NMEA_RMC "$GPRMC"  // Time, date, position, course, speed data
 #define GPS_NMEA_VTG "$GPVTG"  // Course, speed information relative to the ground
 
-// Macros for GPS NMEA buffer
-#define GPS_BUFFSIZE 800
+// Macros for the DMA receive ring of the GPS UART
+#define GPS_RX_RING_BITS 11  ///< log2 of the ring size, the DMA wraps the write address on it
+#define GPS_RX_RING_SIZE (1u << GPS_RX_RING_BITS)  ///< More than the bytes of GPS_RX_POLL_MS at 115200 baud
+#define GPS_RX_POLL_MS 100  ///< Period of the backstop that drains the ring if the UART stays busy
+#define GPS_RX_SLICE 1  ///< PWM slice used as the timer of the backstop (slice 0 is the button debouncer)
+
+// Macros for the command queue, sent by DMA
+#define GPS_CMD_QUEUE 16  ///< Commands in the queue, power of two
+#define GPS_CMD_MAX 56  ///< Bytes of a command (GPS_SET_NMEA_OUTPUT with its checksum)
+#define GPS_CMD_TIMEOUT_MS 250  ///< Time to wait for the ACK of a UBX command
+#define GPS_CMD_RETRIES 3  ///< Attempts of a UBX command without ACK
+
+// Default profile, applied at each power on, see gps_profile_t
+#define GPS_PROFILE_BAUDRATE 38400
+#define GPS_PROFILE_RATE_MS 1000
+#define GPS_PROFILE_UBX true
+#define GPS_PROFILE_NMEA_MASK (GPS_NMEA_MASK_GGA | GPS_NMEA_MASK_GSA | GPS_NMEA_MASK_RMC)
+
+// Bits of the NMEA sentences of a profile, in the order of the ids of the u-blox NMEA class
+#define GPS_NMEA_MASK_GGA 0x01
+#define GPS_NMEA_MASK_GLL 0x02
+#define GPS_NMEA_MASK_GSA 0x04
+#define GPS_NMEA_MASK_GSV 0x08
+#define GPS_NMEA_MASK_RMC 0x10
+#define GPS_NMEA_MASK_VTG 0x20
+#define GPS_NMEA_NUM 6
+
+// Power of the receiver between sessions, see gps_power_mode_t
+#define GPS_POWER_MODE GPS_POWER_BACKUP
+#define GPS_WAKE_BYTES 8  ///< 0xFF sent to wake the receiver from its backup mode
+#define GPS_BAUD_PROBE_MS 1500  ///< Without frames, try the other baudrate (power on or profile)
+#define GPS_WAIT_CURRENT_MA 155  ///< Current of the tracker while it waits for the fix, for the energy of the TTFF
+
+// Default validity of a fix, see gps_validity_t
+#define GPS_VALID_MIN_SATELLITES 4  ///< Satellites of a 3D fix
+#define GPS_VALID_MAX_HDOP 200  ///< HDOP x100, the fix is valid below it
+#define GPS_VALID_MAX_AGE_MS 2000  ///< Time since the last position (GGA sentence or NAV-POSLLH)
+#define GPS_VALID_MAX_H_ACC_MM 10000  ///< Horizontal accuracy estimate of UBX, the fix is valid below it
 
+/**
+ * @brief Conditions for a valid fix, besides a GGA fix quality and a position with hemispheres
+ * 
+ */
+typedef struct
+{
+    uint8_t min_satellites;  ///< Minimum satellites used
+    uint16_t max_hdop;  ///< HDOP x100 must be below it, 0 to not check it (NMEA)
+    uint32_t max_h_acc_mm;  ///< Horizontal accuracy must be below it, 0 to not check it (UBX)
+    uint32_t max_age_ms;  ///< The last position must be younger
+}gps_validity_t;
+
+/**
+ * @brief Settings negotiated with the receiver at each power on, it starts at the power on baudrate with every NMEA sentence
+ * 
+ */
+typedef struct
+{
+    uint32_t baudrate;  ///< Baudrate after the negotiation, 0 to keep the power on one
+    uint16_t rate_ms;  ///< Measurement period (CFG-RATE)
+    bool ubx;  ///< Output NAV-POSLLH, NAV-STATUS, NAV-SOL and NAV-TIMEUTC instead of NMEA
+    uint8_t nmea_mask;  ///< GPS_NMEA_MASK_* of the sentences left on, without ubx
+}gps_profile_t;
+
+/**
+ * @brief What gps_disable() does with the receiver
+ * 
+ */
+typedef enum
+{
+    GPS_POWER_OFF,  ///< Cut its supply with en_gpio: it loses the ephemeris, the next session is a cold start
+    GPS_POWER_BACKUP  ///< Keep the supply and send it to its backup mode (RXM-PMREQ): the next session is a hot start
+}gps_power_mode_t;
+
+/**
+ * @brief Start of a session
+ * 
+ */
+typedef enum
+{
+    GPS_START_COLD,  ///< The receiver was off
+    GPS_START_HOT,  ///< The receiver was in backup mode
+    GPS_START_NUM
+}gps_start_t;
+
+/**
+ * @brief Time to the first fix of the sessions of a kind of start
+ * 
+ */
+typedef struct
+{
+    uint32_t sessions;  ///< Sessions started
+    uint32_t fixes;  ///< Sessions that reached a valid fix
+    uint32_t last_ms;  ///< TTFF of the last fix
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint64_t sum_ms;  ///< For the mean
+}gps_ttff_stats_t;
+
+/**
+ * @brief A command of the queue
+ * 
+ */
+typedef struct
+{
+    uint8_t data[GPS_CMD_MAX];  ///< Bytes to send
+    uint8_t len;
+    bool wait_ack;  ///< UBX command, wait for the ACK-ACK or ACK-NAK of its class and id
+    uint8_t cls;
+    uint8_t id;
+    uint32_t baudrate;  ///< Change the UART baudrate after sending it, 0 to keep it
+}gps_cmd_t;
+
+/**
+ * @brief States of the command at the head of the queue
+ * 
+ */
+typedef enum
+{
+    GPS_CMD_IDLE,  ///< Not sent yet
+    GPS_CMD_SENDING,  ///< The DMA is writing it to the UART
+    GPS_CMD_WAIT_ACK  ///< Sent, waiting for the ACK
+}gps_cmd_state_t;
 
 /**
  * @brief Struct for GPS module for module L76X of WaveShare with the protocol NMEA 0183
@@ -96,29 +221,66 @@ typedef struct
     uart_inst_t *uart; ///< UART instance (uart0 or uart1)
     uint8_t rx;  ///< UART Pin number RX
     uint8_t tx;  ///< UART Pin number TX
-    uint32_t baudrate;  ///< Baudrate of the GPS module
+    uint32_t baudrate;  ///< Baudrate of the GPS module at power on
     bool status;  ///< Avalibility GPS positions (1: Success, 0: Fail)
-    bool data_available;  ///< Data available in the UART
     uint8_t en_gpio;  ///< GPIO pin number for enable the GPS module
     bool enable;  ///< Enable the GPS module
 
+    // Receive ring, filled by the DMA from the UART without interrupts per byte
+    uint8_t rx_ring[GPS_RX_RING_SIZE] __attribute__((aligned(GPS_RX_RING_SIZE)));  ///< The DMA ring needs the alignment of its size
+    uint8_t dma_chan;  ///< DMA channel of the UART RX
+    uint32_t rx_tail;  ///< Bytes of the ring already fed to the parser
+    uint32_t rx_overruns;  ///< Times the parser fell a whole ring behind the DMA (bytes lost)
+
+    // Command queue, written by the program and sent from the interrupts without waiting
+    gps_cmd_t cmd[GPS_CMD_QUEUE];
+    volatile uint8_t cmd_head;  ///< Next command to queue
+    volatile uint8_t cmd_tail;  ///< Command being sent
+    uint8_t cmd_state;  ///< gps_cmd_state_t of the command being sent
+    uint8_t cmd_tries;  ///< Attempts of the command being sent
+    uint32_t cmd_deadline;  ///< time_us_32() limit of the ACK
+    uint8_t tx_dma_chan;  ///< DMA channel of the UART TX
+    uint32_t cmd_acks;  ///< Commands acknowledged
+    uint32_t cmd_naks;  ///< Commands rejected
+    uint32_t cmd_timeouts;  ///< Commands without ACK after GPS_CMD_RETRIES
+    gps_profile_t profile;  ///< Settings applied at each power on
+    bool profile_pending;  ///< Apply the profile when the receiver starts talking
+    uint32_t rx_us;  ///< time_us_32() of the last frame, or of the last baudrate probe
+    uint32_t uart_baudrate;  ///< Current baudrate of the UART
+
+    // Power between sessions and time to the first fix
+    uint8_t power_mode;  ///< gps_power_mode_t
+    bool backup;  ///< The receiver is in its backup mode
+    uint8_t start;  ///< gps_start_t of the session
+    uint32_t session_us;  ///< time_us_32() of gps_enable()
+    uint32_t ttff_ms;  ///< Time to the first valid fix of the session, 0 until it has one
+    gps_ttff_stats_t ttff[GPS_START_NUM];  ///< Statistics since the reset, per kind of start
+
     // GPS data
-    char buffer[GPS_BUFFSIZE];  ///< Buffer for the GPS data
-    uint16_t buffer_index;  ///< Index of the buffer
+    nmea_parser_t nmea;  ///< Parser of the sentences, fed from the receive ring
+    ubx_parser_t ubx;  ///< Parser of the UBX frames, fed with the same bytes
+    bool ubx_active;  ///< The fix comes from UBX frames, the NMEA output is off
 
     uint8_t time_h;  ///< Time hour
     uint8_t time_m;  ///< Time minutes
     uint8_t time_s;  ///< Time seconds
-    uint8_t time_ms;  ///< Time milliseconds
+    uint16_t time_ms;  ///< Time milliseconds
 
-    double latitude;  ///< Latitude
-    double longitude;  ///< Longitude
+    int32_t latitude;  ///< Latitude in microdegrees, negative to the south
+    int32_t longitude;  ///< Longitude in microdegrees, negative to the west
     uint8_t longitude_area; ///< Longitude area (E or W)
     uint8_t latitude_area;  ///< Latitude area (N or S) 
 
     uint8_t fix_quality;
+    uint8_t fix_type;  ///< 1: no fix, 2: 2D, 3: 3D (GSA), 0 if unknown
     uint8_t num_satellites;
-    uint16_t altitude;
+    uint16_t altitude;  ///< Altitude in meters
+    uint16_t hdop;  ///< Horizontal dilution of precision x100, 0 if unknown
+    uint16_t speed_cms;  ///< Speed over ground in cm/s
+    uint32_t date;  ///< UTC date as ddmmyy, 0 if unknown
+    uint32_t h_acc_mm;  ///< Horizontal accuracy estimate in mm (UBX), 0 if unknown
+    uint32_t fix_us;  ///< time_us_32() of the last position (GGA sentence or NAV-POSLLH)
+    gps_validity_t validity;  ///< Conditions checked by gps_check_data()
 
     bool valid;  ///< Valid position (1: Valid, 0: Invalid)
 }gps_t;
@@ -139,43 +301,136 @@ extern gps_t gGps;
 void gps_init(gps_t *gps, uart_inst_t *uart, uint8_t rx, uint8_t tx, uint32_t baudrate, uint8_t en_gpio);
 
 /**
- * @brief Send a command to the GPS, automatically calculate the checksum
+ * @brief Queue a command to the GPS, automatically calculate the checksum. It returns without waiting, the command is sent by DMA
  * 
  * @param gps GPS structure with the configuration
  * @param command Command to send to the GPS. The command string it must end with '\0' to avoid errors.
+ * @return false if the queue is full or the command is too long
+ */
+bool gps_send_command(gps_t *gps, char *command);
+
+/**
+ * @brief Queue a UBX command, it is sent again if its ACK does not arrive in GPS_CMD_TIMEOUT_MS
+ * 
+ * @param gps GPS structure with the configuration
+ * @param cls Class of the command
+ * @param id Id of the command
+ * @param payload Payload of the command
+ * @param len Bytes of the payload
+ * @param baudrate Change the UART baudrate after sending it (CFG-PRT, not acknowledged), 0 to wait for its ACK
+ * @return false if the queue is full or the command is too long
  */
-void gps_send_command(gps_t *gps, char *command);
+bool gps_send_ubx(gps_t *gps, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len, uint32_t baudrate);
 
 /**
- * @brief Get the data from the GPS module and store it in the buffer (GNRMC sentence)
+ * @brief Send the queued commands: start the DMA, match the ACK-ACK and ACK-NAK, retry on timeout
+ * and change the baudrate. Called from the receive interrupts, \ref gps_receive()
  * 
  * @param gps GPS structure with the configuration
  */
-void gps_get_GNRMC(gps_t *gps);
+void gps_tx_poll(gps_t *gps);
 
 /**
- * @brief Get the data from the GPS module and store it in the buffer (GNGGA sentence)
+ * @brief Queue the commands of the profile: measurement rate, output messages (UBX NAV or the NMEA
+ * sentences of the mask) and, the last one, the port with its baudrate and output protocol.
+ * The configuration is not saved in the receiver, it is applied at each power on
  * 
  * @param gps GPS structure with the configuration
  */
-void gps_get_GPGGA(gps_t *gps);
+void gps_apply_profile(gps_t *gps);
 
 /**
- * @brief Check the data from the GPS module if it valide, IF data is valid the atributtes of the GPS structure /ref valid is true
+ * @brief Set the profile applied at each power on
+ * 
+ * @param gps GPS structure with the configuration
+ * @param baudrate Baudrate after the negotiation, 0 to keep the power on one
+ * @param rate_ms Measurement period
+ * @param ubx Output UBX NAV messages instead of NMEA
+ * @param nmea_mask GPS_NMEA_MASK_* of the sentences left on, without ubx
+ */
+static inline void gps_set_profile(gps_t *gps, uint32_t baudrate, uint16_t rate_ms, bool ubx, uint8_t nmea_mask)
+{
+    gps->profile.baudrate = baudrate;
+    gps->profile.rate_ms = rate_ms;
+    gps->profile.ubx = ubx;
+    gps->profile.nmea_mask = nmea_mask;
+}
+
+/**
+ * @brief Copy the last fix published by the UBX parser (NAV-POSLLH, NAV-STATUS, NAV-SOL and NAV-TIMEUTC
+ * merged) or, until it has one, by the NMEA parser (GGA, RMC, GSA and VTG merged) to the GPS
+ * structure. The first NMEA sentence after gps_enable() queues the profile
+ * 
+ * @param gps GPS structure with the configuration
+ */
+void gps_update_fix(gps_t *gps);
+
+/**
+ * @brief UTC time of the last fix as a time stamp of the records (record.h)
+ * 
+ * @param gps GPS structure with the configuration
+ * @return Seconds since 2000-01-01 00:00:00, or only the seconds of the day if the date is unknown
+ */
+uint32_t gps_time_2000(const gps_t *gps);
+
+/**
+ * @brief Feed the bytes the DMA has written in the receive ring to the NMEA parser, in one batch.
+ * Call it from the UART RX timeout interrupt (the line went idle after a burst of sentences)
+ * and from the periodic backstop, both acknowledged here.
+ * 
+ * @param gps GPS structure with the configuration
+ * @return true if a sentence with a correct checksum published a new fix
+ */
+bool gps_receive(gps_t *gps);
+
+/**
+ * @brief Check the data from the GPS module if it valide (see \ref gps_validity_t), IF data is valid the atributtes of the GPS structure /ref valid is true
  * 
  * @param gps GPS structure with the configuration
  */
 void gps_check_data(gps_t *gps);
 
 /**
- * @brief Turn On the GPS
+ * @brief Set the conditions of a valid fix
+ * 
+ * @param gps GPS structure with the configuration
+ * @param min_satellites Minimum satellites used
+ * @param max_hdop HDOP x100 must be below it, 0 to not check it (NMEA)
+ * @param max_h_acc_mm Horizontal accuracy must be below it, 0 to not check it (UBX)
+ * @param max_age_ms The last position must be younger
+ */
+static inline void gps_set_validity(gps_t *gps, uint8_t min_satellites, uint16_t max_hdop, uint32_t max_h_acc_mm, uint32_t max_age_ms)
+{
+    gps->validity.min_satellites = min_satellites;
+    gps->validity.max_hdop = max_hdop;
+    gps->validity.max_h_acc_mm = max_h_acc_mm;
+    gps->validity.max_age_ms = max_age_ms;
+}
+
+/**
+ * @brief Print the TTFF statistics of the cold and hot starts, with the charge spent waiting for the fix
+ * 
+ * @param gps GPS structure with the configuration
+ */
+void gps_print_ttff(gps_t *gps);
+
+/**
+ * @brief Wait until the queued commands have been sent, e.g. the backup request before the dormant mode.
+ * The commands waiting for an ACK can take GPS_CMD_RETRIES*GPS_CMD_TIMEOUT_MS
+ * 
+ * @param gps GPS structure with the configuration
+ */
+void gps_tx_flush(gps_t *gps);
+
+/**
+ * @brief Turn On the GPS, or wake it from its backup mode. A new session starts, its TTFF is measured
  * 
  * @param gps GPS structure with the configuration
  */
 void gps_enable(gps_t *gps);
 
 /**
- * @brief Turn Off the GPS
+ * @brief Turn Off the GPS, or send it to its backup mode (see \ref gps_power_mode_t)
  * 
  * @param gps GPS structure with the configuration
  */
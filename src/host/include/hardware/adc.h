@@ -0,0 +1,34 @@
+/**
+ * \file        adc.h
+ * \brief       Host build: ADC in free running mode, its samples come from the source of the simulation.
+ * \details     A conversion takes (1 + div) cycles of clk_adc (48 MHz); the FIFO keeps 4 samples, the DMA takes them as they are converted.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_ADC_H
+#define __HARDWARE_ADC_H
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+typedef struct{
+    volatile uint32_t cs;
+    volatile uint32_t result;
+    volatile uint32_t fcs;
+    volatile uint32_t fifo;
+    volatile uint32_t div;
+}adc_hw_t;
+
+extern adc_hw_t *adc_hw;
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+void adc_set_clkdiv(float clkdiv);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_fifo_drain(void);
+void adc_run(bool run);
+
+#endif // __HARDWARE_ADC_H
@@ -0,0 +1,30 @@
+/**
+ * \file        address_mapped.h
+ * \brief       Host build: atomic access to the bits of the simulated registers.
+ * \details     The registers are plain memory read by the simulation, core1 runs in another thread.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_ADDRESS_MAPPED_H
+#define __HARDWARE_ADDRESS_MAPPED_H
+
+#include "pico.h"
+
+static inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask)
+{
+    __atomic_fetch_or(addr, mask, __ATOMIC_SEQ_CST);
+}
+
+static inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask)
+{
+    __atomic_fetch_and(addr, ~mask, __ATOMIC_SEQ_CST);
+}
+
+static inline void hw_xor_bits(volatile uint32_t *addr, uint32_t mask)
+{
+    __atomic_fetch_xor(addr, mask, __ATOMIC_SEQ_CST);
+}
+
+#endif // __HARDWARE_ADDRESS_MAPPED_H
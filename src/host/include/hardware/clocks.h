@@ -0,0 +1,60 @@
+/**
+ * \file        clocks.h
+ * \brief       Host build: clocks, at their nominal frequencies.
+ * \details     The configuration is accepted and ignored, the simulation runs in the time of the host.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_CLOCKS_H
+#define __HARDWARE_CLOCKS_H
+
+#include "pico.h"
+
+enum clock_index{
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+};
+
+// Sources of the clocks, only their names are used
+enum{
+    CLOCKS_CLK_REF_CTRL_SRC_VALUE_ROSC_CLKSRC_PH = 0,
+    CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF = 0,
+    CLOCKS_CLK_ADC_CTRL_AUXSRC_VALUE_ROSC_CLKSRC_PH = 2,
+    CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLK_SYS = 0,
+    CLOCKS_CLK_USB_CTRL_AUXSRC_VALUE_ROSC_CLKSRC_PH = 2
+};
+
+// Sources of the frequency counter
+enum{
+    CLOCKS_FC0_SRC_VALUE_PLL_SYS_CLKSRC_PRIMARY = 1,
+    CLOCKS_FC0_SRC_VALUE_PLL_USB_CLKSRC_PRIMARY,
+    CLOCKS_FC0_SRC_VALUE_ROSC_CLKSRC,
+    CLOCKS_FC0_SRC_VALUE_ROSC_CLKSRC_PH,
+    CLOCKS_FC0_SRC_VALUE_XOSC_CLKSRC,
+    CLOCKS_FC0_SRC_VALUE_CLKSRC_GPIN0,
+    CLOCKS_FC0_SRC_VALUE_CLKSRC_GPIN1,
+    CLOCKS_FC0_SRC_VALUE_CLK_REF,
+    CLOCKS_FC0_SRC_VALUE_CLK_SYS,
+    CLOCKS_FC0_SRC_VALUE_CLK_PERI,
+    CLOCKS_FC0_SRC_VALUE_CLK_USB,
+    CLOCKS_FC0_SRC_VALUE_CLK_ADC,
+    CLOCKS_FC0_SRC_VALUE_CLK_RTC
+};
+
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq);
+void clock_stop(enum clock_index clk_index);
+uint32_t clock_get_hz(enum clock_index clk_index);
+uint32_t frequency_count_khz(uint src);
+
+#endif // __HARDWARE_CLOCKS_H
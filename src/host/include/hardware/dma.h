@@ -0,0 +1,81 @@
+/**
+ * \file        dma.h
+ * \brief       Host build: DMA channels paced by the requests of the simulated devices.
+ * \details     The ADC, the UART and the I2C blocks move the data of their requests when the simulation advances; a channel without a request is not supported. The transfer count of a trigger is the last one written, the addresses are not reloaded. A channel that finishes raises its interrupt and triggers the channel it is chained to.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_DMA_H
+#define __HARDWARE_DMA_H
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+// Data requests of the devices
+enum{
+    DREQ_UART0_TX = 20,
+    DREQ_UART0_RX = 21,
+    DREQ_UART1_TX = 22,
+    DREQ_UART1_RX = 23,
+    DREQ_I2C0_TX = 32,
+    DREQ_I2C0_RX = 33,
+    DREQ_I2C1_TX = 34,
+    DREQ_I2C1_RX = 35,
+    DREQ_ADC = 36,
+    DREQ_FORCE = 0x3f
+};
+
+typedef struct{
+    uint8_t size;           ///< enum dma_channel_transfer_size
+    bool read_increment;
+    bool write_increment;
+    bool ring_write;        ///< The ring wraps the write address, else the read one
+    uint8_t ring_bits;      ///< 0: no ring
+    uint8_t chain_to;       ///< Itself: no chain
+    uint8_t dreq;
+    bool irq_quiet;
+}dma_channel_config;
+
+///< The addresses are pointers of the host
+typedef struct{
+    volatile uintptr_t read_addr;
+    volatile uintptr_t write_addr;
+    volatile uint32_t transfer_count;   ///< Transfers left of the current trigger
+    volatile uint32_t ctrl_trig;
+}dma_channel_hw_t;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to);
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits);
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+dma_channel_hw_t *dma_channel_hw_addr(uint channel);
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_irqn_get_channel_status(uint irq_index, uint channel);
+void dma_irqn_acknowledge_channel(uint irq_index, uint channel);
+
+#endif // __HARDWARE_DMA_H
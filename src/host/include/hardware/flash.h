@@ -0,0 +1,22 @@
+/**
+ * \file        flash.h
+ * \brief       Host build: the flash, an image in a file mapped at XIP_BASE.
+ * \details     Erasing sets the bytes of the sectors to 0xFF, programming can only clear bits, as the NOR flash.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_FLASH_H
+#define __HARDWARE_FLASH_H
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_BLOCK_SIZE (1u << 16)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif // __HARDWARE_FLASH_H
@@ -0,0 +1,49 @@
+/**
+ * \file        i2c.h
+ * \brief       Host build: I2C controllers, the LCD of the board (PCF8574 and HD44780) is on i2c1.
+ * \details     A transfer written to data_cmd by the DMA of the TX request takes 9 bit times per byte at the baudrate. A target that does not answer (absent, or without supply) aborts the transfer: TX_ABRT is raised and the rest of the transfer is flushed.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_I2C_H
+#define __HARDWARE_I2C_H
+
+#include "pico.h"
+#include <stddef.h>
+#include "hardware/address_mapped.h"
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_DMA_CR_TDMAE_BITS 0x00000002u
+
+typedef struct{
+    volatile uint32_t con;
+    volatile uint32_t tar;          ///< Address of the target, written while the block is disabled
+    volatile uint32_t sar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t intr_mask;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;  ///< Reading it clears TX_ABRT, the next transfer clears it in the simulation
+    volatile uint32_t enable;
+    volatile uint32_t status;
+    volatile uint32_t txflr;
+    volatile uint32_t tx_abrt_source;
+    volatile uint32_t dma_cr;
+}i2c_hw_t;
+
+typedef struct i2c_inst i2c_inst_t;
+
+extern i2c_inst_t *i2c0;
+extern i2c_inst_t *i2c1;
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+uint i2c_hw_index(i2c_inst_t *i2c);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif // __HARDWARE_I2C_H
@@ -0,0 +1,30 @@
+/**
+ * \file        irq.h
+ * \brief       Host build: interrupt handlers of the simulated NVIC.
+ * \details     The handlers run in the thread of core0, when it waits (__wfi, tight loops) or
+ *              enables the interrupts again, never preempting another handler. The interrupts
+ *              are levels: a handler runs again while its device keeps the line asserted.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_IRQ_H
+#define __HARDWARE_IRQ_H
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+void irq_set_priority(uint num, uint8_t priority);
+
+#endif // __HARDWARE_IRQ_H
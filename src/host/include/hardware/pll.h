@@ -0,0 +1,23 @@
+/**
+ * \file        pll.h
+ * \brief       Host build: PLLs.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_PLL_H
+#define __HARDWARE_PLL_H
+
+#include "pico.h"
+
+typedef struct pll_hw pll_hw_t;
+
+extern pll_hw_t *pll_sys;
+extern pll_hw_t *pll_usb;
+
+void pll_init(pll_hw_t *pll, uint ref_div, uint vco_freq, uint post_div1, uint post_div2);
+void pll_deinit(pll_hw_t *pll);
+
+#endif // __HARDWARE_PLL_H
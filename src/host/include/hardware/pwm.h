@@ -0,0 +1,41 @@
+/**
+ * \file        pwm.h
+ * \brief       Host build: PWM slices, only their wrap interrupts.
+ * \details     A slice wraps every (wrap + 1)*div cycles of clk_sys, twice that in phase correct mode.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_PWM_H
+#define __HARDWARE_PWM_H
+
+#include "pico.h"
+
+#define NUM_PWM_SLICES 8
+
+enum pwm_clkdiv_mode{
+    PWM_DIV_FREE_RUNNING,
+    PWM_DIV_B_HIGH,
+    PWM_DIV_B_RISING,
+    PWM_DIV_B_FALLING
+};
+
+typedef struct{
+    bool phase_correct;
+    float div;
+    uint16_t top;
+}pwm_config;
+
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_phase_correct(pwm_config *c, bool phase_correct);
+void pwm_config_set_clkdiv(pwm_config *c, float div);
+void pwm_config_set_clkdiv_mode(pwm_config *c, enum pwm_clkdiv_mode mode);
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap);
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+void pwm_set_enabled(uint slice_num, bool enabled);
+void pwm_set_irq_enabled(uint slice_num, bool enabled);
+uint32_t pwm_get_irq_status_mask(void);
+void pwm_clear_irq(uint slice_num);
+
+#endif // __HARDWARE_PWM_H
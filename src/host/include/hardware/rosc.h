@@ -0,0 +1,17 @@
+/**
+ * \file        rosc.h
+ * \brief       Host build: ring oscillator and the dormant mode.
+ * \details     The dormant mode waits for an edge of a GPIO enabled with gpio_set_dormant_irq_enabled(), the simulation ends if the script of the button has no more presses.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_ROSC_H
+#define __HARDWARE_ROSC_H
+
+#include "pico.h"
+
+void rosc_set_dormant(void);
+
+#endif // __HARDWARE_ROSC_H
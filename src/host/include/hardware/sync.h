@@ -0,0 +1,19 @@
+/**
+ * \file        sync.h
+ * \brief       Host build: interrupt masking of core0.
+ * \details     Restoring the interrupts runs the handlers that became pending meanwhile.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_SYNC_H
+#define __HARDWARE_SYNC_H
+
+#include "pico.h"
+#include "hardware/irq.h"
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+#endif // __HARDWARE_SYNC_H
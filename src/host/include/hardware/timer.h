@@ -0,0 +1,36 @@
+/**
+ * \file        timer.h
+ * \brief       Host build: the 64 bit timer and its four alarms.
+ * \details     timerawl follows the time of the simulation. An alarm fires when the time reaches
+ *              the value written in it and its interrupt is enabled in inte; the handler must
+ *              write a new value (or disable it), as the hardware disarms an alarm when it fires.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_TIMER_H
+#define __HARDWARE_TIMER_H
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+typedef struct{
+    volatile uint32_t alarm[4];
+    volatile uint32_t armed;    ///< Write 1 to disarm
+    volatile uint32_t timerawh;
+    volatile uint32_t timerawl;
+    volatile uint32_t intr;     ///< Write 1 to clear, reads as 0 in the simulation
+    volatile uint32_t inte;
+    volatile uint32_t intf;     ///< Force the interrupt
+    volatile uint32_t ints;
+}timer_hw_t;
+
+extern timer_hw_t *timer_hw;
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void busy_wait_us(uint64_t us);
+void hardware_alarm_claim(uint alarm_num);
+
+#endif // __HARDWARE_TIMER_H
@@ -0,0 +1,68 @@
+/**
+ * \file        uart.h
+ * \brief       Host build: UARTs, the GPS of the board is on a pseudo terminal or a replayed file.
+ * \details     The bytes are received at the baudrate (10 bits each) and taken by the DMA of the RX request, or kept in a FIFO of 32 bytes. The RX timeout interrupt (RTIM) is raised 32 bit times after the last byte.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_UART_H
+#define __HARDWARE_UART_H
+
+#include "pico.h"
+#include "hardware/address_mapped.h"
+
+#define UART_UARTFR_BUSY_BITS 0x00000008u
+#define UART_UARTFR_RXFE_BITS 0x00000010u
+#define UART_UARTFR_TXFF_BITS 0x00000020u
+#define UART_UARTFR_RXFF_BITS 0x00000040u
+#define UART_UARTFR_TXFE_BITS 0x00000080u
+#define UART_UARTIMSC_RXIM_BITS 0x00000010u
+#define UART_UARTIMSC_TXIM_BITS 0x00000020u
+#define UART_UARTIMSC_RTIM_BITS 0x00000040u
+#define UART_UARTICR_RXIC_BITS 0x00000010u
+#define UART_UARTICR_TXIC_BITS 0x00000020u
+#define UART_UARTICR_RTIC_BITS 0x00000040u
+#define UART_UARTMIS_RTMIS_BITS 0x00000040u
+#define UART_UARTDMACR_RXDMAE_BITS 0x00000001u
+#define UART_UARTDMACR_TXDMAE_BITS 0x00000002u
+
+typedef struct{
+    volatile uint32_t dr;
+    volatile uint32_t rsr;
+    volatile uint32_t fr;       ///< Flags, updated by the simulation
+    volatile uint32_t ibrd;
+    volatile uint32_t fbrd;
+    volatile uint32_t lcr_h;
+    volatile uint32_t cr;
+    volatile uint32_t ifls;
+    volatile uint32_t imsc;
+    volatile uint32_t ris;
+    volatile uint32_t mis;
+    volatile uint32_t icr;      ///< Write 1 to clear, applied by the simulation
+    volatile uint32_t dmacr;
+}uart_hw_t;
+
+typedef struct uart_inst uart_inst_t;
+
+extern uart_inst_t *uart0;
+extern uart_inst_t *uart1;
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart);
+uint uart_get_index(uart_inst_t *uart);
+uint uart_get_dreq(uart_inst_t *uart, bool is_tx);
+uint uart_init(uart_inst_t *uart, uint baudrate);
+void uart_deinit(uart_inst_t *uart);
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate);
+void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled);
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data);
+bool uart_is_readable(uart_inst_t *uart);
+bool uart_is_writable(uart_inst_t *uart);
+char uart_getc(uart_inst_t *uart);
+void uart_putc_raw(uart_inst_t *uart, char c);
+void uart_putc(uart_inst_t *uart, char c);
+void uart_puts(uart_inst_t *uart, const char *s);
+void uart_tx_wait_blocking(uart_inst_t *uart);
+
+#endif // __HARDWARE_UART_H
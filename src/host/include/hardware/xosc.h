@@ -0,0 +1,18 @@
+/**
+ * \file        xosc.h
+ * \brief       Host build: crystal oscillator.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __HARDWARE_XOSC_H
+#define __HARDWARE_XOSC_H
+
+#include "pico.h"
+
+void xosc_init(void);
+void xosc_disable(void);
+
+#endif // __HARDWARE_XOSC_H
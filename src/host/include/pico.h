@@ -0,0 +1,97 @@
+/**
+ * \file        pico.h
+ * \brief       Host build: base definitions of the Pico SDK for the simulated hardware.
+ * \details     The headers of include/ declare the subset of the SDK used by the tracker, with
+ *              the same names and signatures, and the sim_*.c files implement them on Linux.
+ *              The core instructions (__wfi, __wfe, __sev) go to the simulation: while core0
+ *              waits, the devices advance to the current time and raise their interrupts.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_H
+#define __PICO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+typedef unsigned int uint;
+
+#define PICO_ON_DEVICE 0 ///< As the host platform of the SDK, the code for the RP2040 only is left out
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+#define __aligned(n) __attribute__((aligned(n)))
+#define count_of(a) (sizeof(a)/sizeof((a)[0]))
+
+#define KHZ 1000
+#define MHZ 1000000
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT (-1)
+#define PICO_ERROR_GENERIC (-2)
+#define PICO_ERROR_NO_DATA (-3)
+
+#define PICO_FLASH_SIZE_BYTES (2*1024*1024)
+#define XIP_BASE ((uintptr_t)sim_flash_xip())   ///< The flash image is mapped in the memory of the process
+
+// Interrupt numbers of the RP2040
+#define TIMER_IRQ_0 0
+#define TIMER_IRQ_1 1
+#define TIMER_IRQ_2 2
+#define TIMER_IRQ_3 3
+#define PWM_IRQ_WRAP 4
+#define USBCTRL_IRQ 5
+#define DMA_IRQ_0 11
+#define DMA_IRQ_1 12
+#define IO_IRQ_BANK0 13
+#define UART0_IRQ 20
+#define UART1_IRQ 21
+#define I2C0_IRQ 23
+#define I2C1_IRQ 24
+#define NUM_IRQS 32
+
+const uint8_t *sim_flash_xip(void);
+void sim_wfi(void);
+void sim_wfe(void);
+void sim_sev(void);
+void sim_yield(void);
+
+static inline void __wfi(void)
+{
+    sim_wfi();
+}
+
+static inline void __wfe(void)
+{
+    sim_wfe();
+}
+
+static inline void __sev(void)
+{
+    sim_sev();
+}
+
+static inline void __dmb(void)
+{
+    __sync_synchronize();
+}
+
+static inline void __compiler_memory_barrier(void)
+{
+    __asm__ volatile ("" ::: "memory");
+}
+
+/**
+ * @brief Busy wait loops let the devices advance, as they would in parallel with the core.
+ *
+ */
+static inline void tight_loop_contents(void)
+{
+    sim_yield();
+}
+
+#endif // __PICO_H
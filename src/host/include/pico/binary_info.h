@@ -0,0 +1,17 @@
+/**
+ * \file        binary_info.h
+ * \brief       Host build: the binary information of picotool is not used.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_BINARY_INFO_H
+#define __PICO_BINARY_INFO_H
+
+#include "pico.h"
+
+#define bi_decl(...)
+
+#endif // __PICO_BINARY_INFO_H
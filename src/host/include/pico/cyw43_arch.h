@@ -0,0 +1,15 @@
+/**
+ * \file        cyw43_arch.h
+ * \brief       Host build: the wireless chip of the Pico W is not used.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_CYW43_ARCH_H
+#define __PICO_CYW43_ARCH_H
+
+#include "pico.h"
+
+#endif // __PICO_CYW43_ARCH_H
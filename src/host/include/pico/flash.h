@@ -0,0 +1,18 @@
+/**
+ * \file        flash.h
+ * \brief       Host build: flash operations with the other core stopped.
+ * \details     Core1 does not read the flash image, the operation runs at once.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_FLASH_H
+#define __PICO_FLASH_H
+
+#include "pico.h"
+#include "hardware/flash.h"
+
+int flash_safe_execute(void (*func)(void *param), void *param, uint32_t enter_exit_timeout_ms);
+
+#endif // __PICO_FLASH_H
@@ -0,0 +1,20 @@
+/**
+ * \file        multicore.h
+ * \brief       Host build: core1, a thread of the host.
+ * \details     Reset cancels the thread at its next __wfe().
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_MULTICORE_H
+#define __PICO_MULTICORE_H
+
+#include "pico.h"
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+void multicore_lockout_victim_init(void);
+uint get_core_num(void);
+
+#endif // __PICO_MULTICORE_H
@@ -0,0 +1,16 @@
+/**
+ * \file        sleep.h
+ * \brief       Host build: sleep modes of pico_extras.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_SLEEP_H
+#define __PICO_SLEEP_H
+
+#include "pico.h"
+#include "hardware/rosc.h"
+
+#endif // __PICO_SLEEP_H
@@ -0,0 +1,27 @@
+/**
+ * \file        stdio.h
+ * \brief       Host build: standard input and output, the USB CDC of the tracker.
+ * \details     The output goes to stdout and the input comes from stdin, without translation.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_STDIO_H
+#define __PICO_STDIO_H
+
+#include "pico.h"
+#include <stdio.h>
+
+typedef struct stdio_driver{
+    void (*out_chars)(const char *buf, int len);
+    void (*out_flush)(void);
+    int (*in_chars)(char *buf, int len);
+}stdio_driver_t;
+
+bool stdio_init_all(void);
+void stdio_flush(void);
+int getchar_timeout_us(uint32_t timeout_us);
+void stdio_set_chars_available_callback(void (*fn)(void *param), void *param);
+
+#endif // __PICO_STDIO_H
@@ -0,0 +1,21 @@
+/**
+ * \file        stdio_usb.h
+ * \brief       Host build: the USB CDC driver of stdio.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_STDIO_USB_H
+#define __PICO_STDIO_USB_H
+
+#include "pico.h"
+#include "pico/stdio.h"
+
+extern stdio_driver_t stdio_usb;
+
+bool stdio_usb_init(void);
+bool stdio_usb_connected(void);
+
+#endif // __PICO_STDIO_USB_H
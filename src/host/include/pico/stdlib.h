@@ -0,0 +1,22 @@
+/**
+ * \file        stdlib.h
+ * \brief       Host build: the common headers of the SDK.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_STDLIB_H
+#define __PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/stdio.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+void setup_default_uart(void);
+
+#endif // __PICO_STDLIB_H
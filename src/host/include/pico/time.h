@@ -0,0 +1,19 @@
+/**
+ * \file        time.h
+ * \brief       Host build: time since the start of the simulation.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __PICO_TIME_H
+#define __PICO_TIME_H
+
+#include "pico.h"
+#include "hardware/timer.h"
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+#endif // __PICO_TIME_H
@@ -0,0 +1,122 @@
+/**
+ * \file        sim.h
+ * \brief       Host build: simulated hardware of the tracker board, behind the headers of the Pico SDK.
+ * \details     Each device (timer, GPIO and PWM, ADC, DMA, UART, I2C, USB) keeps its registers in
+ *              memory and is advanced to the current time when core0 waits or polls: it moves the
+ *              data of its DMA requests, changes its flags and asserts its interrupt lines. The
+ *              deadline of a device is the next time it changes by itself, core0 sleeps until the
+ *              earliest one. The interrupts are levels, dispatched in the thread of core0.
+ *
+ *              In virtual time core0 jumps from one deadline to the next instead of sleeping, and
+ *              core1 runs until it waits on __wfe() before the time moves: a session of minutes
+ *              runs in a fraction of a second and repeats exactly. Busy loops advance to the next
+ *              deadline, polling a busy DMA channel takes 1 us.
+ *
+ *              The peripherals of the board plug into the devices: the sample source of the ADC,
+ *              the GPS on a UART, the targets of the I2C buses and the button script. They are
+ *              configured with environment variables:
+ *
+ *              TRACKER_SIM_ADC     tone:<Hz>:<dBFS> (default tone:1000:-20) or wav:<file> (PCM 16 bit)
+ *              TRACKER_SIM_GPS     File of NMEA/UBX bytes replayed in a loop, default a pseudo terminal
+ *                                  (its name is printed, e.g. for test/gps_simulation/ubx_sim.py --port)
+ *              TRACKER_SIM_FLASH   Image of the flash, default tracker_flash.bin
+ *              TRACKER_SIM_BUTTON  Times of the presses of the button in ms, e.g. 1000,5000
+ *              TRACKER_SIM_TIME_S  Duration of the simulation, default until it is dormant without presses
+ *              TRACKER_SIM_CLOCK   virtual or real, default virtual with a replay file of the GPS and
+ *                                  real with the pseudo terminal
+ *
+ *              The events of the board (LED, supplies, LCD text) are logged on stderr with the time.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico.h"
+
+#define SIM_NONE UINT64_MAX     ///< No deadline
+
+// Board: the pins and buses of the peripherals, as wired in functs.c
+#define SIM_BUTTON_GPIO 2
+#define SIM_BUTTON_HOLD_MS 200  ///< Time the button is held in each press of the script
+#define SIM_GPS_EN_GPIO 11
+#define SIM_LCD_EN_GPIO 12
+#define SIM_MPHONE_EN_GPIO 13
+#define SIM_LED_GPIO 18         ///< Three GPIOs: blue, green and red
+#define SIM_GPS_UART 1
+#define SIM_LCD_I2C 1
+#define SIM_LCD_ADDR 0x20
+
+// Clocks, nominal
+#define SIM_CLK_SYS_HZ 125000000u
+#define SIM_CLK_ADC_HZ 48000000u
+
+/**
+ * @brief A source of samples for the ADC, full scale is +-1.
+ *
+ */
+typedef struct _sim_source_t{
+    float (*sample)(struct _sim_source_t *src, uint64_t n, uint32_t rate); ///< Sample n of a stream at rate Hz
+    void *ctx;
+}sim_source_t;
+
+/**
+ * @brief A target of an I2C bus.
+ *
+ */
+typedef struct{
+    uint8_t bus;                    ///< Index of the controller
+    uint8_t addr;                   ///< 7 bit address
+    bool (*ack)(void);              ///< It answers its address (present and supplied)
+    void (*write)(uint8_t data);    ///< Byte written
+    void (*stop)(void);             ///< End of the transfer
+}sim_i2c_target_t;
+
+// Core: time, interrupts, log
+uint64_t sim_now_us(void);
+void sim_advance(void);
+void sim_poll(void);
+void sim_irq_set_level(uint num, bool (*level)(void));
+void sim_log(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void sim_fault(const char *fmt, ...) __attribute__((format(printf, 1, 2), noreturn));
+void sim_exit(void) __attribute__((noreturn));
+
+// Devices, advanced by the core to the current time
+void sim_timer_init(void);
+void sim_timer_advance(uint64_t now);
+uint64_t sim_timer_deadline(uint64_t now);
+void sim_gpio_init(void);
+void sim_gpio_advance(uint64_t now);
+uint64_t sim_gpio_deadline(uint64_t now);
+uint64_t sim_gpio_next_press(uint64_t now);
+bool sim_gpio_out(uint gpio);
+void sim_adc_init(void);
+void sim_adc_advance(uint64_t now);
+uint64_t sim_adc_deadline(uint64_t now);
+void sim_uart_init(void);
+void sim_uart_advance(uint64_t now);
+uint64_t sim_uart_deadline(uint64_t now);
+int sim_uart_fd(void);
+void sim_i2c_advance(uint64_t now);
+uint64_t sim_i2c_deadline(uint64_t now);
+void sim_usb_init(void);
+void sim_usb_advance(uint64_t now);
+int sim_usb_fd(void);
+void sim_flash_sync(void);
+
+// DMA requests of the devices
+bool sim_dma_push(uint dreq, uint32_t data);
+bool sim_dma_pull(uint dreq, uint32_t *data);
+uint32_t sim_dma_pending(uint dreq);
+
+// Sources of samples and targets of the buses
+bool sim_source_tone(sim_source_t *src, float hz, float dbfs);
+bool sim_source_wav(sim_source_t *src, const char *path);
+void sim_adc_set_source(const sim_source_t *src);
+extern const sim_i2c_target_t sim_lcd;
+
+#endif // __SIM_H__
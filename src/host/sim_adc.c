@@ -0,0 +1,257 @@
+/**
+ * \file        sim_adc.c
+ * \brief       Host build: ADC in free running mode, its FIFO and the sample sources (tones, WAV files).
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+#include "sim.h"
+
+#define SIM_ADC_CS_EN_BITS 0x00000001u
+#define SIM_ADC_CS_START_MANY_BITS 0x00000008u
+#define SIM_ADC_FCS_EN_BITS 0x00000001u
+#define SIM_ADC_FCS_DREQ_EN_BITS 0x00000008u
+#define SIM_ADC_FCS_OVER_BITS 0x00000800u
+#define SIM_ADC_FIFO_DEPTH 4
+#define SIM_ADC_FULL_SCALE 2047     ///< 12 bit codes around the bias of the microphone
+
+static adc_hw_t sim_adc;
+adc_hw_t *adc_hw = &sim_adc;
+static sim_source_t sim_source;
+static uint64_t sim_t0_us;          ///< Start of the free running mode
+static uint64_t sim_count;          ///< Conversions since the start
+static uint16_t sim_fifo[SIM_ADC_FIFO_DEPTH];
+static uint8_t sim_fifo_level;
+
+/**
+ * @brief Conversions per second: one every 1 + div cycles of clk_adc.
+ *
+ */
+static double sim_adc_rate(void)
+{
+    return SIM_CLK_ADC_HZ/(1.0 + sim_adc.div/256.0);
+}
+
+static uint64_t sim_adc_time(uint64_t n)
+{
+    return sim_t0_us + (uint64_t)ceil(n*1e6/sim_adc_rate());
+}
+
+/**
+ * @brief Code of a conversion: the source when the microphone is supplied, else 0 V.
+ *
+ */
+static uint16_t sim_adc_convert(uint64_t n)
+{
+    if (!sim_gpio_out(SIM_MPHONE_EN_GPIO) || !sim_source.sample) return 0;
+    float s = sim_source.sample(&sim_source, n, (uint32_t)lround(sim_adc_rate()));
+    long code = (SIM_ADC_FULL_SCALE + 1) + lroundf(s*SIM_ADC_FULL_SCALE);
+    if (code < 0) code = 0;
+    if (code > 4095) code = 4095;
+    return (uint16_t)code;
+}
+
+void sim_adc_advance(uint64_t now)
+{
+    if (!(sim_adc.cs & SIM_ADC_CS_START_MANY_BITS)) return;
+    while (sim_adc_time(sim_count) <= now) {
+        uint16_t code = sim_adc_convert(sim_count++);
+        sim_adc.result = code;
+        if (!(sim_adc.fcs & SIM_ADC_FCS_EN_BITS)) continue;
+        if (sim_fifo_level < SIM_ADC_FIFO_DEPTH) sim_fifo[sim_fifo_level++] = code;
+        else sim_adc.fcs |= SIM_ADC_FCS_OVER_BITS;
+        if (!(sim_adc.fcs & SIM_ADC_FCS_DREQ_EN_BITS)) continue;
+        while (sim_fifo_level && sim_dma_push(DREQ_ADC, sim_fifo[0])) {
+            memmove(sim_fifo, sim_fifo + 1, --sim_fifo_level*sizeof(sim_fifo[0]));
+        }
+    }
+}
+
+/**
+ * @brief Time the channel paced by the ADC completes, its interrupt wakes up the core.
+ *
+ */
+uint64_t sim_adc_deadline(uint64_t now)
+{
+    if (!(sim_adc.cs & SIM_ADC_CS_START_MANY_BITS)) return SIM_NONE;
+    uint32_t pending = sim_dma_pending(DREQ_ADC);
+    if (!pending) return SIM_NONE;
+    return sim_adc_time(sim_count + pending - 1);
+}
+
+void adc_init(void)
+{
+    memset(&sim_adc, 0, sizeof(sim_adc));
+    sim_adc.cs = SIM_ADC_CS_EN_BITS;
+    sim_fifo_level = 0;
+}
+
+void adc_gpio_init(uint gpio)
+{
+}
+
+void adc_select_input(uint input)
+{
+    sim_adc.cs = (sim_adc.cs & ~0x7000u) | (input << 12);
+}
+
+void adc_set_clkdiv(float clkdiv)
+{
+    sim_adc.div = (uint32_t)(clkdiv*256.0f); ///< 16.8 fixed point
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift)
+{
+    if (byte_shift) sim_fault("the 8 bit ADC results are not simulated");
+    sim_adc.fcs = (en ? SIM_ADC_FCS_EN_BITS : 0) | (dreq_en ? SIM_ADC_FCS_DREQ_EN_BITS : 0);
+}
+
+void adc_fifo_drain(void)
+{
+    sim_fifo_level = 0;
+}
+
+void adc_run(bool run)
+{
+    if (run && !(sim_adc.cs & SIM_ADC_CS_START_MANY_BITS)) {
+        sim_t0_us = sim_now_us();
+        sim_count = 1; ///< The first conversion ends one period after the start
+    }
+    if (run) sim_adc.cs |= SIM_ADC_CS_START_MANY_BITS;
+    else sim_adc.cs &= ~SIM_ADC_CS_START_MANY_BITS;
+}
+
+// -------------------------------------------------------------
+// ---------------- Sources ------------------------------------
+// -------------------------------------------------------------
+
+typedef struct{
+    float hz;
+    float amplitude;
+}sim_tone_t;
+
+typedef struct{
+    int16_t *data;
+    uint32_t len;       ///< Samples of the first channel
+    uint32_t rate;
+}sim_wav_t;
+
+static float sim_tone_sample(sim_source_t *src, uint64_t n, uint32_t rate)
+{
+    const sim_tone_t *tone = src->ctx;
+    double cycles = fmod((double)n*tone->hz/rate, 1.0);
+    return tone->amplitude*(float)sin(2*M_PI*cycles);
+}
+
+bool sim_source_tone(sim_source_t *src, float hz, float dbfs)
+{
+    sim_tone_t *tone = malloc(sizeof(sim_tone_t));
+    if (!tone) return false;
+    tone->hz = hz;
+    tone->amplitude = powf(10.0f, dbfs/20.0f);
+    src->sample = sim_tone_sample;
+    src->ctx = tone;
+    return true;
+}
+
+/**
+ * @brief The file in a loop, resampled to the rate of the ADC by the nearest sample.
+ *
+ */
+static float sim_wav_sample(sim_source_t *src, uint64_t n, uint32_t rate)
+{
+    const sim_wav_t *wav = src->ctx;
+    uint64_t i = n*wav->rate/rate;
+    return wav->data[i % wav->len]/32768.0f;
+}
+
+static uint32_t sim_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t sim_le16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+/**
+ * @brief A RIFF file of PCM 16 bit samples, only the first channel is used.
+ *
+ */
+bool sim_source_wav(sim_source_t *src, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t hdr[12], chunk[8], fmt[16];
+    uint16_t channels = 0, bits = 0;
+    uint32_t rate = 0;
+    bool ok = fread(hdr, 1, 12, f) == 12 && !memcmp(hdr, "RIFF", 4) && !memcmp(hdr + 8, "WAVE", 4);
+    while (ok && fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = sim_le32(chunk + 4);
+        if (!memcmp(chunk, "fmt ", 4)) {
+            if (size < 16 || fread(fmt, 1, 16, f) != 16) break;
+            if (sim_le16(fmt) != 1) break; ///< PCM only
+            channels = sim_le16(fmt + 2);
+            rate = sim_le32(fmt + 4);
+            bits = sim_le16(fmt + 14);
+            fseek(f, size - 16 + (size & 1), SEEK_CUR);
+        } else if (!memcmp(chunk, "data", 4)) {
+            if (bits != 16 || !channels || !rate) break;
+            uint32_t len = size/(2*channels);
+            sim_wav_t *wav = malloc(sizeof(sim_wav_t));
+            int16_t *frames = malloc(size);
+            if (!len || !wav || !frames || fread(frames, 2*channels, len, f) != len) {
+                free(wav);
+                free(frames);
+                break;
+            }
+            for (uint32_t i = 0; i < len; i++) frames[i] = (int16_t)sim_le16((uint8_t *)&frames[i*channels]);
+            wav->data = frames;
+            wav->len = len;
+            wav->rate = rate;
+            src->sample = sim_wav_sample;
+            src->ctx = wav;
+            fclose(f);
+            return true;
+        } else {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    return false;
+}
+
+void sim_adc_set_source(const sim_source_t *src)
+{
+    sim_source = *src;
+}
+
+/**
+ * @brief Source of TRACKER_SIM_ADC.
+ *
+ */
+void sim_adc_init(void)
+{
+    const char *spec = getenv("TRACKER_SIM_ADC");
+    sim_source_t src = {0};
+    float hz = 1000, dbfs = -20;
+    bool ok;
+    if (spec && !strncmp(spec, "wav:", 4)) ok = sim_source_wav(&src, spec + 4);
+    else {
+        if (spec && sscanf(spec, "tone:%f:%f", &hz, &dbfs) != 2) sim_fault("TRACKER_SIM_ADC: %s", spec);
+        ok = sim_source_tone(&src, hz, dbfs);
+    }
+    if (!ok) sim_fault("TRACKER_SIM_ADC: %s can not be read", spec);
+    sim_adc_set_source(&src);
+}
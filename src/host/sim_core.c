@@ -0,0 +1,650 @@
+/**
+ * \file        sim_core.c
+ * \brief       Host build: time, interrupts, cores and clocks of the simulated RP2040.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <poll.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/pll.h"
+#include "hardware/xosc.h"
+#include "hardware/rosc.h"
+
+#include "sim.h"
+
+#define SIM_MAX_SHARED 4        ///< Handlers of a shared interrupt
+#define SIM_IRQ_LOOP_MAX 10000  ///< A handler that never clears its line
+#define SIM_WAIT_MAX_US 10000   ///< Longest sleep of core0, the sources on a terminal are polled
+#define SIM_YIELD_MAX_US 1000   ///< Longest step of a busy loop in virtual time
+#define SIM_SYNC_MAX_S 1        ///< Core1 never waits: it loops on something of core0
+
+static uint64_t sim_start_ns;
+static uint64_t sim_end_us = SIM_NONE;
+static bool sim_virtual;                    ///< Virtual time, else the clock of the host
+static uint64_t sim_time_us;                ///< Virtual time, only core0 moves it
+static __thread uint sim_core;              ///< Core of the thread
+static irq_handler_t sim_handlers[NUM_IRQS][SIM_MAX_SHARED];
+static bool (*sim_levels[NUM_IRQS])(void);  ///< Interrupt line of each device
+static uint32_t sim_irq_enabled;
+static bool sim_primask;                    ///< Interrupts disabled in core0
+static bool sim_in_handler;                 ///< No preemption between handlers
+static uint64_t sim_advanced_us;            ///< Time the devices were advanced to
+static int sim_event[2];                    ///< Event latch of __wfe() of each core
+static pthread_t sim_core1;
+static bool sim_core1_running;
+static bool sim_core1_waiting;              ///< Core1 sleeps in __wfe()
+static pthread_mutex_t sim_core_lock = PTHREAD_MUTEX_INITIALIZER;   ///< Of the event latches and core1
+static pthread_cond_t sim_core_cond = PTHREAD_COND_INITIALIZER;
+
+// -------------------------------------------------------------
+// ---------------- Time and log -------------------------------
+// -------------------------------------------------------------
+
+static uint64_t sim_host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000u + ts.tv_nsec;
+}
+
+uint64_t sim_now_us(void)
+{
+    if (sim_virtual) return __atomic_load_n(&sim_time_us, __ATOMIC_ACQUIRE);
+    return (sim_host_ns() - sim_start_ns)/1000;
+}
+
+void sim_log(const char *fmt, ...)
+{
+    va_list ap;
+    uint64_t now = sim_now_us();
+    fprintf(stderr, "[%6lu.%06lu] ", (unsigned long)(now/1000000), (unsigned long)(now % 1000000));
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+void sim_fault(const char *fmt, ...)
+{
+    va_list ap;
+    fprintf(stderr, "Simulation fault: ");
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    fflush(stdout);
+    abort();
+}
+
+void sim_exit(void)
+{
+    sim_log("End of the simulation");
+    fflush(stdout);
+    sim_flash_sync();
+    exit(0);
+}
+
+/**
+ * @brief Configuration of the devices, before main(). The clock is virtual unless the GPS is a
+ * terminal, which sends in real time.
+ *
+ */
+__attribute__((constructor)) static void sim_init(void)
+{
+    sim_start_ns = sim_host_ns();
+    const char *end = getenv("TRACKER_SIM_TIME_S");
+    if (end) sim_end_us = (uint64_t)(atof(end)*1000000);
+    const char *clock = getenv("TRACKER_SIM_CLOCK");
+    if (clock && strcmp(clock, "virtual") && strcmp(clock, "real")) sim_fault("TRACKER_SIM_CLOCK: %s", clock);
+    sim_virtual = clock ? !strcmp(clock, "virtual") : getenv("TRACKER_SIM_GPS") != NULL;
+    sim_timer_init();
+    sim_gpio_init();
+    sim_adc_init();
+    sim_uart_init();
+    sim_usb_init();
+}
+
+// -------------------------------------------------------------
+// ---------------- Devices and interrupts ---------------------
+// -------------------------------------------------------------
+
+/**
+ * @brief Earliest time a device changes by itself.
+ *
+ */
+static uint64_t sim_deadline(uint64_t now)
+{
+    uint64_t t = sim_end_us;
+    uint64_t d;
+    if ((d = sim_timer_deadline(now)) < t) t = d;
+    if ((d = sim_gpio_deadline(now)) < t) t = d;
+    if ((d = sim_adc_deadline(now)) < t) t = d;
+    if ((d = sim_uart_deadline(now)) < t) t = d;
+    if ((d = sim_i2c_deadline(now)) < t) t = d;
+    return t;
+}
+
+static void sim_advance_to(uint64_t now)
+{
+    if (now >= sim_end_us) sim_exit();
+    sim_timer_advance(now);
+    sim_gpio_advance(now);
+    sim_adc_advance(now);
+    sim_uart_advance(now);
+    sim_i2c_advance(now);
+    sim_usb_advance(now);
+    sim_advanced_us = now;
+}
+
+void sim_advance(void)
+{
+    sim_advance_to(sim_now_us());
+}
+
+void sim_irq_set_level(uint num, bool (*level)(void))
+{
+    sim_levels[num] = level;
+}
+
+/**
+ * @brief First enabled interrupt whose line is asserted, the lowest number has the highest priority.
+ *
+ */
+static int sim_irq_pending(void)
+{
+    for (uint num = 0; num < NUM_IRQS; num++) {
+        if ((sim_irq_enabled & (1u << num)) && sim_levels[num] && sim_levels[num]()) return num;
+    }
+    return -1;
+}
+
+/**
+ * @brief Run the handlers of the asserted lines, while they stay asserted.
+ *
+ */
+static void sim_irq_dispatch(void)
+{
+    if (sim_core != 0 || sim_primask || sim_in_handler) return;
+    sim_in_handler = true;
+    for (int loops = 0; ; loops++) {
+        int num = sim_irq_pending();
+        if (num < 0) break;
+        if (loops == SIM_IRQ_LOOP_MAX) sim_fault("the interrupt %d is never cleared", num);
+        if (!sim_handlers[num][0]) sim_fault("the interrupt %d has no handler", num);
+        for (int i = 0; i < SIM_MAX_SHARED && sim_handlers[num][i]; i++) {
+            sim_handlers[num][i]();
+        }
+    }
+    sim_in_handler = false;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+    if (sim_handlers[num][0] && sim_handlers[num][0] != handler) sim_fault("the interrupt %u already has a handler", num);
+    sim_handlers[num][0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority)
+{
+    for (int i = 0; i < SIM_MAX_SHARED; i++) {
+        if (sim_handlers[num][i] == handler) return;
+        if (!sim_handlers[num][i]) {
+            sim_handlers[num][i] = handler;
+            return;
+        }
+    }
+    sim_fault("too many handlers of the interrupt %u", num);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler)
+{
+    for (int i = 0; i < SIM_MAX_SHARED; i++) {
+        if (sim_handlers[num][i] != handler) continue;
+        for (; i < SIM_MAX_SHARED - 1; i++) sim_handlers[num][i] = sim_handlers[num][i + 1];
+        sim_handlers[num][SIM_MAX_SHARED - 1] = NULL;
+        return;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+    if (enabled) sim_irq_enabled |= 1u << num;
+    else sim_irq_enabled &= ~(1u << num);
+}
+
+bool irq_is_enabled(uint num)
+{
+    return sim_irq_enabled & (1u << num);
+}
+
+void irq_set_priority(uint num, uint8_t priority)
+{
+}
+
+uint32_t save_and_disable_interrupts(void)
+{
+    if (sim_core != 0) return 0;
+    uint32_t status = sim_primask;
+    sim_primask = true;
+    return status;
+}
+
+void restore_interrupts(uint32_t status)
+{
+    if (sim_core != 0) return;
+    sim_primask = status;
+    sim_irq_dispatch(); ///< The lines asserted meanwhile are taken now
+}
+
+// -------------------------------------------------------------
+// ---------------- Time steps ---------------------------------
+// -------------------------------------------------------------
+
+/**
+ * @brief Wait until a time or an input of a terminal. The virtual time jumps to it at once.
+ *
+ */
+static void sim_wait_until(uint64_t t)
+{
+    if (sim_virtual) {
+        if (t == SIM_NONE) {
+            sim_log("Nothing else happens");
+            sim_exit();
+        }
+        if (t > sim_time_us) __atomic_store_n(&sim_time_us, t, __ATOMIC_RELEASE);
+        return;
+    }
+    uint64_t now = sim_now_us();
+    uint64_t wait = (t <= now) ? 0 : t - now;
+    if (wait > SIM_WAIT_MAX_US) wait = SIM_WAIT_MAX_US;
+    struct pollfd fds[2] = {{sim_usb_fd(), POLLIN, 0}, {sim_uart_fd(), POLLIN, 0}}; ///< Negative ones are ignored
+    struct timespec ts = {(time_t)(wait/1000000), (long)(wait % 1000000)*1000};
+    ppoll(fds, 2, &ts, NULL);
+}
+
+/**
+ * @brief In virtual time core1 runs until it waits before core0 goes on: it is never late and the
+ * runs repeat exactly.
+ *
+ */
+static void sim_core1_sync(void)
+{
+    if (!sim_virtual || sim_core != 0) return;
+    struct timespec limit;
+    clock_gettime(CLOCK_REALTIME, &limit);
+    limit.tv_sec += SIM_SYNC_MAX_S;
+    pthread_mutex_lock(&sim_core_lock);
+    while (sim_core1_running && !(sim_core1_waiting && !sim_event[1])) {
+        if (pthread_cond_timedwait(&sim_core_cond, &sim_core_lock, &limit)) sim_fault("core1 does not wait");
+    }
+    pthread_mutex_unlock(&sim_core_lock);
+}
+
+/**
+ * @brief In real time the process may be descheduled for longer than a block of the microphone: the
+ * devices advance from change to change up to now and the interrupts of each one are taken in order,
+ * on time as on the hardware, instead of all the changes at once.
+ *
+ * @return An interrupt is pending that the core cannot take yet: the devices stay at its time, as the
+ * core wakes up from __wfi() on it or ends the handler. The next call advances them by one change.
+ */
+static bool sim_catch_up(void)
+{
+    if (sim_virtual || sim_core != 0) return false;
+    uint64_t now = sim_now_us();
+    for (;;) {
+        uint64_t t = sim_deadline(sim_advanced_us);
+        if (t >= now || t <= sim_advanced_us) return false;
+        sim_advance_to(t);
+        sim_irq_dispatch();
+        if (sim_irq_pending() >= 0) return true;
+    }
+}
+
+/**
+ * @brief A step of a busy loop of core0: the devices advance and raise their interrupts. The virtual
+ * time jumps to the next change of a device, up to a limit.
+ *
+ */
+static void sim_step(uint64_t limit)
+{
+    sim_core1_sync();
+    if (!sim_catch_up()) sim_advance(); ///< Else one change per step, until the core takes the interrupt
+    if (sim_virtual) {
+        uint64_t t = sim_deadline(sim_now_us());
+        sim_wait_until(t < limit ? t : limit);
+        sim_advance();
+    }
+    sim_irq_dispatch();
+}
+
+void sim_poll(void)
+{
+    if (sim_core != 0) return;
+    if (sim_virtual) sim_wait_until(sim_now_us() + 1);
+    if (!sim_catch_up()) sim_advance();
+}
+
+// -------------------------------------------------------------
+// ---------------- Core instructions --------------------------
+// -------------------------------------------------------------
+
+void sim_wfi(void)
+{
+    if (sim_core != 0) {
+        sched_yield();
+        return;
+    }
+    fflush(stdout);
+    for (;;) {
+        sim_core1_sync();
+        if (sim_catch_up()) break;
+        sim_advance();
+        if (sim_irq_pending() >= 0) break;
+        sim_wait_until(sim_deadline(sim_now_us()));
+    }
+    sim_irq_dispatch(); ///< With the interrupts disabled the core only wakes up
+}
+
+static void sim_unlock(void *lock)
+{
+    pthread_mutex_unlock(lock);
+}
+
+void sim_wfe(void)
+{
+    if (sim_core == 0) {
+        for (;;) {
+            pthread_mutex_lock(&sim_core_lock);
+            bool event = sim_event[0];
+            sim_event[0] = 0;
+            pthread_mutex_unlock(&sim_core_lock);
+            if (event) return;
+            sim_yield();
+        }
+    }
+    pthread_mutex_lock(&sim_core_lock);
+    pthread_cleanup_push(sim_unlock, &sim_core_lock); ///< The wait is the cancellation point of multicore_reset_core1()
+    while (!sim_event[1]) {
+        sim_core1_waiting = true;
+        pthread_cond_broadcast(&sim_core_cond);
+        pthread_cond_wait(&sim_core_cond, &sim_core_lock);
+    }
+    sim_event[1] = 0;
+    sim_core1_waiting = false;
+    pthread_cleanup_pop(1);
+}
+
+void sim_sev(void)
+{
+    pthread_mutex_lock(&sim_core_lock);
+    sim_event[0] = 1;
+    sim_event[1] = 1;
+    pthread_cond_broadcast(&sim_core_cond);
+    pthread_mutex_unlock(&sim_core_lock);
+    sim_core1_sync();
+}
+
+void sim_yield(void)
+{
+    if (sim_core != 0) {
+        sched_yield();
+        return;
+    }
+    sim_step(sim_now_us() + SIM_YIELD_MAX_US);
+}
+
+// -------------------------------------------------------------
+// ---------------- Timer --------------------------------------
+// -------------------------------------------------------------
+
+static timer_hw_t sim_timer;
+timer_hw_t *timer_hw = &sim_timer;
+static uint32_t sim_alarm_fired[4]; ///< Value of each alarm when it last fired
+static uint32_t sim_timer_raw;      ///< Raw interrupts, INTR only receives the writes to clear them
+static uint32_t sim_alarm_claimed;  ///< Alarms claimed by the firmware
+
+/**
+ * @brief Line of an alarm: raw or forced, and enabled.
+ *
+ */
+static bool sim_alarm_level(uint alarm)
+{
+    sim_timer_raw &= ~sim_timer.intr; ///< Write 1 to clear, the writes take effect here
+    sim_timer.intr = 0;
+    sim_timer.ints = (sim_timer_raw | sim_timer.intf) & sim_timer.inte;
+    return sim_timer.ints & (1u << alarm);
+}
+
+static bool sim_alarm0_level(void) { return sim_alarm_level(0); }
+static bool sim_alarm1_level(void) { return sim_alarm_level(1); }
+static bool sim_alarm2_level(void) { return sim_alarm_level(2); }
+static bool sim_alarm3_level(void) { return sim_alarm_level(3); }
+
+void sim_timer_init(void)
+{
+    sim_irq_set_level(TIMER_IRQ_0, sim_alarm0_level);
+    sim_irq_set_level(TIMER_IRQ_1, sim_alarm1_level);
+    sim_irq_set_level(TIMER_IRQ_2, sim_alarm2_level);
+    sim_irq_set_level(TIMER_IRQ_3, sim_alarm3_level);
+}
+
+void hardware_alarm_claim(uint alarm_num)
+{
+    if (sim_alarm_claimed & (1u << alarm_num)) sim_fault("hardware alarm %u already claimed", alarm_num);
+    sim_alarm_claimed |= 1u << alarm_num;
+}
+
+/**
+ * @brief An alarm is armed while it holds a value it has not fired at: the hardware arms it when it
+ * is written. The writes can not be seen, so an alarm disarmed through the armed register must
+ * also have its interrupt disabled, as sw_timer does.
+ *
+ */
+static bool sim_alarm_armed(uint alarm)
+{
+    return (sim_timer.inte & (1u << alarm)) && sim_timer.alarm[alarm] != sim_alarm_fired[alarm];
+}
+
+void sim_timer_advance(uint64_t now)
+{
+    sim_timer.timerawl = (uint32_t)now;
+    sim_timer.timerawh = (uint32_t)(now >> 32);
+    sim_timer.armed = 0;
+    sim_timer_raw &= ~sim_timer.intr; ///< A clear written before a new match
+    sim_timer.intr = 0;
+    for (uint i = 0; i < 4; i++) {
+        if (sim_alarm_armed(i) && (int32_t)(sim_timer.timerawl - sim_timer.alarm[i]) >= 0) {
+            sim_timer_raw |= 1u << i;
+            sim_alarm_fired[i] = sim_timer.alarm[i];
+        }
+    }
+}
+
+uint64_t sim_timer_deadline(uint64_t now)
+{
+    uint64_t t = SIM_NONE;
+    for (uint i = 0; i < 4; i++) {
+        if (!sim_alarm_armed(i)) continue;
+        int32_t wait = (int32_t)(sim_timer.alarm[i] - (uint32_t)now);
+        uint64_t at = now + (wait > 0 ? wait : 0);
+        if (at < t) t = at;
+    }
+    return t;
+}
+
+uint32_t time_us_32(void)
+{
+    uint32_t now = (uint32_t)sim_now_us();
+    if (sim_core == 0) sim_timer.timerawl = now; ///< Read right after by the code that arms an alarm
+    return now;
+}
+
+uint64_t time_us_64(void)
+{
+    return sim_now_us();
+}
+
+void busy_wait_us(uint64_t us)
+{
+    uint64_t end = sim_now_us() + us;
+    while (sim_now_us() < end) {
+        if (sim_core == 0) sim_step(end);
+        else sched_yield();
+    }
+}
+
+void sleep_us(uint64_t us)
+{
+    busy_wait_us(us);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    busy_wait_us((uint64_t)ms*1000);
+}
+
+// -------------------------------------------------------------
+// ---------------- Cores --------------------------------------
+// -------------------------------------------------------------
+
+static void *sim_core1_main(void *entry)
+{
+    sim_core = 1;
+    ((void (*)(void))entry)();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+    if (sim_core1_running) sim_fault("core1 is already running");
+    pthread_mutex_lock(&sim_core_lock);
+    sim_event[1] = 0;
+    sim_core1_waiting = false;
+    sim_core1_running = true;
+    pthread_mutex_unlock(&sim_core_lock);
+    if (pthread_create(&sim_core1, NULL, sim_core1_main, (void *)entry)) sim_fault("core1 could not be started");
+    sim_core1_sync();
+}
+
+void multicore_reset_core1(void)
+{
+    if (!sim_core1_running) return;
+    pthread_cancel(sim_core1);
+    pthread_join(sim_core1, NULL);
+    pthread_mutex_lock(&sim_core_lock);
+    sim_core1_running = false;
+    sim_core1_waiting = false;
+    pthread_mutex_unlock(&sim_core_lock);
+}
+
+void multicore_lockout_victim_init(void)
+{
+}
+
+uint get_core_num(void)
+{
+    return sim_core;
+}
+
+// -------------------------------------------------------------
+// ---------------- Clocks and sleep ---------------------------
+// -------------------------------------------------------------
+
+struct pll_hw{
+    int unused;
+};
+
+static pll_hw_t sim_pll[2];
+pll_hw_t *pll_sys = &sim_pll[0];
+pll_hw_t *pll_usb = &sim_pll[1];
+
+static const uint32_t sim_clk_hz[CLK_COUNT] = {
+    [clk_ref] = 12000000,
+    [clk_sys] = SIM_CLK_SYS_HZ,
+    [clk_peri] = SIM_CLK_SYS_HZ,
+    [clk_usb] = 48000000,
+    [clk_adc] = SIM_CLK_ADC_HZ,
+    [clk_rtc] = 46875,
+};
+
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq)
+{
+    return true;
+}
+
+void clock_stop(enum clock_index clk_index)
+{
+}
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    return sim_clk_hz[clk_index];
+}
+
+uint32_t frequency_count_khz(uint src)
+{
+    switch (src) {
+    case CLOCKS_FC0_SRC_VALUE_PLL_SYS_CLKSRC_PRIMARY: return SIM_CLK_SYS_HZ/1000;
+    case CLOCKS_FC0_SRC_VALUE_PLL_USB_CLKSRC_PRIMARY: return 48000;
+    case CLOCKS_FC0_SRC_VALUE_ROSC_CLKSRC:
+    case CLOCKS_FC0_SRC_VALUE_ROSC_CLKSRC_PH: return 6500;
+    case CLOCKS_FC0_SRC_VALUE_XOSC_CLKSRC:
+    case CLOCKS_FC0_SRC_VALUE_CLK_REF: return sim_clk_hz[clk_ref]/1000;
+    case CLOCKS_FC0_SRC_VALUE_CLK_SYS: return sim_clk_hz[clk_sys]/1000;
+    case CLOCKS_FC0_SRC_VALUE_CLK_PERI: return sim_clk_hz[clk_peri]/1000;
+    case CLOCKS_FC0_SRC_VALUE_CLK_USB: return sim_clk_hz[clk_usb]/1000;
+    case CLOCKS_FC0_SRC_VALUE_CLK_ADC: return sim_clk_hz[clk_adc]/1000;
+    case CLOCKS_FC0_SRC_VALUE_CLK_RTC: return sim_clk_hz[clk_rtc]/1000;
+    default: return 0;
+    }
+}
+
+void pll_init(pll_hw_t *pll, uint ref_div, uint vco_freq, uint post_div1, uint post_div2)
+{
+}
+
+void pll_deinit(pll_hw_t *pll)
+{
+}
+
+void xosc_init(void)
+{
+}
+
+void xosc_disable(void)
+{
+}
+
+/**
+ * @brief Dormant until the next press of the script. The timer keeps counting, unlike the hardware.
+ *
+ */
+void rosc_set_dormant(void)
+{
+    uint64_t wake = sim_gpio_next_press(sim_now_us());
+    if (wake == SIM_NONE || wake >= sim_end_us) {
+        sim_log("Dormant without more presses of the button");
+        sim_exit();
+    }
+    sim_log("Dormant");
+    fflush(stdout);
+    while (sim_now_us() < wake) sim_wait_until(wake);
+    sim_advance(); ///< The edge of the button is latched and its interrupt taken, as after the wake up
+    sim_irq_dispatch();
+}
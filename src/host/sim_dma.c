@@ -0,0 +1,284 @@
+/**
+ * \file        sim_dma.c
+ * \brief       Host build: DMA channels, paced by the data requests of the simulated devices.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#include "sim.h"
+
+/**
+ * @brief A channel: its registers, its configuration and the count reloaded by each trigger.
+ *
+ */
+typedef struct{
+    dma_channel_hw_t hw;
+    dma_channel_config cfg;
+    uint32_t reload;        ///< Written through the alias without trigger
+    bool busy;
+    bool claimed;
+}sim_channel_t;
+
+static sim_channel_t sim_channels[NUM_DMA_CHANNELS];
+static uint32_t sim_dma_intr;       ///< Raw completion of each channel
+static uint32_t sim_dma_inte[2];    ///< Channels of DMA_IRQ_0 and DMA_IRQ_1
+
+static bool sim_dma_irq0_level(void) { return sim_dma_intr & sim_dma_inte[0]; }
+static bool sim_dma_irq1_level(void) { return sim_dma_intr & sim_dma_inte[1]; }
+
+__attribute__((constructor)) static void sim_dma_init(void)
+{
+    sim_irq_set_level(DMA_IRQ_0, sim_dma_irq0_level);
+    sim_irq_set_level(DMA_IRQ_1, sim_dma_irq1_level);
+}
+
+static void sim_dma_complete(uint channel);
+
+/**
+ * @brief Next address of a side of a transfer: the increment, wrapped on the ring of that side.
+ *
+ */
+static uintptr_t sim_dma_step(const dma_channel_config *c, uintptr_t addr, bool incr, bool write)
+{
+    if (!incr) return addr;
+    uintptr_t next = addr + (1u << c->size);
+    if (c->ring_bits && c->ring_write == write) {
+        uintptr_t mask = ((uintptr_t)1 << c->ring_bits) - 1;
+        next = (addr & ~mask) | (next & mask);
+    }
+    return next;
+}
+
+/**
+ * @brief One transfer of a channel; its data comes from the device, or goes to it, or both are memory.
+ *
+ */
+static void sim_dma_transfer(uint channel, const uint32_t *in, uint32_t *out)
+{
+    sim_channel_t *ch = &sim_channels[channel];
+    const dma_channel_config *c = &ch->cfg;
+    uint32_t data;
+    if (in) data = *in;
+    else {
+        switch (c->size) {
+        case DMA_SIZE_8: data = *(volatile uint8_t *)ch->hw.read_addr; break;
+        case DMA_SIZE_16: data = *(volatile uint16_t *)ch->hw.read_addr; break;
+        default: data = *(volatile uint32_t *)ch->hw.read_addr; break;
+        }
+    }
+    if (out) *out = data;
+    else {
+        switch (c->size) {
+        case DMA_SIZE_8: *(volatile uint8_t *)ch->hw.write_addr = (uint8_t)data; break;
+        case DMA_SIZE_16: *(volatile uint16_t *)ch->hw.write_addr = (uint16_t)data; break;
+        default: *(volatile uint32_t *)ch->hw.write_addr = data; break;
+        }
+    }
+    ch->hw.read_addr = sim_dma_step(c, ch->hw.read_addr, c->read_increment, false);
+    ch->hw.write_addr = sim_dma_step(c, ch->hw.write_addr, c->write_increment, true);
+    if (--ch->hw.transfer_count == 0) sim_dma_complete(channel);
+}
+
+static void sim_dma_trigger(uint channel)
+{
+    sim_channel_t *ch = &sim_channels[channel];
+    ch->hw.transfer_count = ch->reload;
+    ch->busy = ch->reload != 0;
+    if (!ch->busy) return;
+    if (ch->cfg.dreq == DREQ_FORCE) { ///< Unpaced: memory to memory at once
+        while (ch->busy) sim_dma_transfer(channel, NULL, NULL);
+    }
+}
+
+static void sim_dma_complete(uint channel)
+{
+    sim_channel_t *ch = &sim_channels[channel];
+    ch->busy = false;
+    if (!ch->cfg.irq_quiet) sim_dma_intr |= 1u << channel;
+    if (ch->cfg.chain_to != channel) sim_dma_trigger(ch->cfg.chain_to);
+}
+
+/**
+ * @brief Busy channel paced by a data request, the lowest number if there are several.
+ *
+ */
+static int sim_dma_find(uint dreq)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (sim_channels[i].busy && sim_channels[i].cfg.dreq == dreq) return i;
+    }
+    return -1;
+}
+
+bool sim_dma_push(uint dreq, uint32_t data)
+{
+    int channel = sim_dma_find(dreq);
+    if (channel < 0) return false;
+    sim_dma_transfer(channel, &data, NULL);
+    return true;
+}
+
+bool sim_dma_pull(uint dreq, uint32_t *data)
+{
+    int channel = sim_dma_find(dreq);
+    if (channel < 0) return false;
+    sim_dma_transfer(channel, NULL, data);
+    return true;
+}
+
+uint32_t sim_dma_pending(uint dreq)
+{
+    int channel = sim_dma_find(dreq);
+    return channel < 0 ? 0 : sim_channels[channel].hw.transfer_count;
+}
+
+int dma_claim_unused_channel(bool required)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (sim_channels[i].claimed) continue;
+        sim_channels[i].claimed = true;
+        return i;
+    }
+    if (required) sim_fault("no free DMA channel");
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+    sim_channels[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    dma_channel_config c = {
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .ring_write = false,
+        .ring_bits = 0,
+        .chain_to = (uint8_t)channel,
+        .dreq = DREQ_FORCE,
+        .irq_quiet = false,
+    };
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->size = size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    c->write_increment = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+    c->dreq = (uint8_t)dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+    c->chain_to = (uint8_t)chain_to;
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+    c->ring_write = write;
+    c->ring_bits = (uint8_t)size_bits;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    sim_channels[channel].cfg = *config;
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, trigger);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger)
+{
+    sim_channels[channel].hw.read_addr = (uintptr_t)read_addr;
+    if (trigger) sim_dma_trigger(channel);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger)
+{
+    sim_channels[channel].hw.write_addr = (uintptr_t)write_addr;
+    if (trigger) sim_dma_trigger(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger)
+{
+    sim_channel_t *ch = &sim_channels[channel];
+    ch->reload = trans_count;
+    if (!ch->busy) ch->hw.transfer_count = trans_count; ///< Reads back the count of the next trigger while idle
+    if (trigger) sim_dma_trigger(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, true);
+}
+
+void dma_channel_start(uint channel)
+{
+    sim_dma_trigger(channel);
+}
+
+void dma_channel_abort(uint channel)
+{
+    sim_channels[channel].busy = false;
+}
+
+/**
+ * @brief Polling a busy channel lets the devices advance, the transfer goes on in parallel with the core.
+ *
+ */
+bool dma_channel_is_busy(uint channel)
+{
+    if (sim_channels[channel].busy) sim_poll();
+    return sim_channels[channel].busy;
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel)
+{
+    return &sim_channels[channel].hw;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled)
+{
+    if (enabled) sim_dma_inte[0] |= 1u << channel;
+    else sim_dma_inte[0] &= ~(1u << channel);
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled)
+{
+    if (enabled) sim_dma_inte[1] |= 1u << channel;
+    else sim_dma_inte[1] &= ~(1u << channel);
+}
+
+bool dma_irqn_get_channel_status(uint irq_index, uint channel)
+{
+    return sim_dma_intr & sim_dma_inte[irq_index] & (1u << channel);
+}
+
+void dma_irqn_acknowledge_channel(uint irq_index, uint channel)
+{
+    sim_dma_intr &= ~(1u << channel);
+}
@@ -0,0 +1,85 @@
+/**
+ * \file        sim_flash.c
+ * \brief       Host build: the flash as an image file mapped in memory, kept between runs.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "pico/flash.h"
+
+#include "sim.h"
+
+static uint8_t *sim_flash;
+
+/**
+ * @brief Image of TRACKER_SIM_FLASH, mapped on the first access. A new or shorter file is completed
+ * with erased bytes.
+ *
+ */
+const uint8_t *sim_flash_xip(void)
+{
+    if (sim_flash) return sim_flash;
+    const char *path = getenv("TRACKER_SIM_FLASH");
+    if (!path) path = "tracker_flash.bin";
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st)) sim_fault("TRACKER_SIM_FLASH: %s can not be opened", path);
+    if (st.st_size < PICO_FLASH_SIZE_BYTES) {
+        static uint8_t erased[FLASH_SECTOR_SIZE];
+        memset(erased, 0xff, sizeof(erased));
+        lseek(fd, st.st_size, SEEK_SET);
+        for (off_t left = PICO_FLASH_SIZE_BYTES - st.st_size; left > 0; left -= FLASH_SECTOR_SIZE) {
+            size_t len = left < FLASH_SECTOR_SIZE ? left : FLASH_SECTOR_SIZE;
+            if (write(fd, erased, len) != (ssize_t)len) sim_fault("TRACKER_SIM_FLASH: %s can not be written", path);
+        }
+    }
+    sim_flash = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (sim_flash == MAP_FAILED) sim_fault("TRACKER_SIM_FLASH: %s can not be mapped", path);
+    return sim_flash;
+}
+
+void sim_flash_sync(void)
+{
+    if (sim_flash) msync(sim_flash, PICO_FLASH_SIZE_BYTES, MS_SYNC);
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        sim_fault("flash erase of %zu bytes at 0x%x", count, (unsigned)flash_offs);
+    }
+    memset((uint8_t *)sim_flash_xip() + flash_offs, 0xff, count);
+}
+
+/**
+ * @brief Programming only clears bits, as the flash does.
+ *
+ */
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        sim_fault("flash program of %zu bytes at 0x%x", count, (unsigned)flash_offs);
+    }
+    uint8_t *dst = (uint8_t *)sim_flash_xip() + flash_offs;
+    for (size_t i = 0; i < count; i++) dst[i] &= data[i];
+}
+
+/**
+ * @brief Core1 does not run from the flash in the simulation, the operation runs at once.
+ *
+ */
+int flash_safe_execute(void (*func)(void *param), void *param, uint32_t enter_exit_timeout_ms)
+{
+    func(param);
+    return PICO_OK;
+}
@@ -0,0 +1,372 @@
+/**
+ * \file        sim_gpio.c
+ * \brief       Host build: GPIOs, the button script, the outputs of the board and the PWM slices.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+
+#include "sim.h"
+
+#define SIM_MAX_PRESSES 64
+
+static uint32_t sim_dir;            ///< Outputs
+static uint32_t sim_out;            ///< Values of the outputs
+static uint32_t sim_in;             ///< Levels of the inputs
+static uint32_t sim_pull_up;
+static uint8_t sim_irq_events[NUM_BANK0_GPIOS];     ///< Enabled events of each GPIO
+static uint8_t sim_dormant_events[NUM_BANK0_GPIOS]; ///< Events that wake from the dormant mode
+static uint8_t sim_latched[NUM_BANK0_GPIOS];        ///< Edges latched, until acknowledged
+static gpio_irq_callback_t sim_callback;
+static bool sim_pwm_level(void);
+static void sim_pwm_advance(uint64_t now);
+static uint64_t sim_presses[SIM_MAX_PRESSES];       ///< Script of the button, in us
+static int sim_num_presses;
+
+/**
+ * @brief Outputs of the board that are logged when they change.
+ *
+ */
+typedef struct{
+    uint8_t gpio;
+    const char *name;
+}sim_supply_t;
+
+static const sim_supply_t sim_supplies[] = {
+    {SIM_GPS_EN_GPIO, "GPS"},
+    {SIM_LCD_EN_GPIO, "LCD"},
+    {SIM_MPHONE_EN_GPIO, "Microphone"},
+};
+
+///< Colors of the RGB LED, named as in gpio_led.h
+static const char *const sim_colors[8] = {"off", "blue", "green", "orange", "red", "purple", "yellow", "white"};
+
+// -------------------------------------------------------------
+// ---------------- GPIO ---------------------------------------
+// -------------------------------------------------------------
+
+static bool sim_gpio_io_level(void)
+{
+    for (uint i = 0; i < NUM_BANK0_GPIOS; i++) {
+        if (sim_latched[i] & sim_irq_events[i]) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Handler of IO_IRQ_BANK0, like the default one of the SDK: the callback of each pending GPIO.
+ *
+ */
+static void sim_gpio_irq_handler(void)
+{
+    for (uint i = 0; i < NUM_BANK0_GPIOS; i++) {
+        uint32_t events = sim_latched[i] & sim_irq_events[i];
+        if (!events) continue;
+        gpio_acknowledge_irq(i, events);
+        if (sim_callback) sim_callback(i, events);
+    }
+}
+
+/**
+ * @brief Press times of TRACKER_SIM_BUTTON.
+ *
+ */
+void sim_gpio_init(void)
+{
+    sim_irq_set_level(IO_IRQ_BANK0, sim_gpio_io_level);
+    sim_irq_set_level(PWM_IRQ_WRAP, sim_pwm_level);
+    irq_set_exclusive_handler(IO_IRQ_BANK0, sim_gpio_irq_handler);
+    const char *script = getenv("TRACKER_SIM_BUTTON");
+    while (script && *script && sim_num_presses < SIM_MAX_PRESSES) {
+        char *end;
+        uint64_t ms = strtoull(script, &end, 10);
+        if (end == script) break;
+        sim_presses[sim_num_presses++] = ms*1000;
+        script = (*end == ',') ? end + 1 : end;
+    }
+}
+
+/**
+ * @brief Level of an input: the button follows the script, the others their pulls.
+ *
+ */
+static bool sim_gpio_input(uint gpio, uint64_t now)
+{
+    if (gpio == SIM_BUTTON_GPIO) {
+        for (int i = 0; i < sim_num_presses; i++) {
+            if (now >= sim_presses[i] && now < sim_presses[i] + SIM_BUTTON_HOLD_MS*1000) return true;
+        }
+        return false;
+    }
+    return sim_pull_up & (1u << gpio);
+}
+
+/**
+ * @brief Latch the edges of a new level.
+ *
+ */
+static void sim_gpio_level(uint gpio, bool level)
+{
+    bool old = (sim_in >> gpio) & 1;
+    if (level == old) return;
+    sim_in ^= 1u << gpio;
+    uint8_t edge = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if ((sim_irq_events[gpio] | sim_dormant_events[gpio]) & edge) sim_latched[gpio] |= edge;
+}
+
+void sim_gpio_advance(uint64_t now)
+{
+    for (uint i = 0; i < NUM_BANK0_GPIOS; i++) {
+        if (!(sim_dir & (1u << i))) sim_gpio_level(i, sim_gpio_input(i, now));
+    }
+    sim_pwm_advance(now);
+}
+
+uint64_t sim_gpio_next_press(uint64_t now)
+{
+    uint64_t t = SIM_NONE;
+    for (int i = 0; i < sim_num_presses; i++) {
+        if (sim_presses[i] > now && sim_presses[i] < t) t = sim_presses[i];
+    }
+    return t;
+}
+
+bool sim_gpio_out(uint gpio)
+{
+    return (sim_dir & sim_out) & (1u << gpio);
+}
+
+/**
+ * @brief Log the outputs of the board that change.
+ *
+ */
+static void sim_gpio_outputs(uint32_t old)
+{
+    uint32_t mask = 7u << SIM_LED_GPIO;
+    if ((old ^ sim_out) & mask) sim_log("LED %s", sim_colors[(sim_out & mask) >> SIM_LED_GPIO]);
+    for (uint i = 0; i < count_of(sim_supplies); i++) {
+        uint32_t bit = 1u << sim_supplies[i].gpio;
+        if ((old ^ sim_out) & bit) sim_log("%s %s", sim_supplies[i].name, (sim_out & bit) ? "on" : "off");
+    }
+}
+
+void gpio_init(uint gpio)
+{
+    gpio_init_mask(1u << gpio);
+}
+
+void gpio_init_mask(uint32_t mask)
+{
+    sim_dir &= ~mask;
+    sim_out &= ~mask;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    gpio_set_dir_masked(1u << gpio, out ? 1u << gpio : 0);
+}
+
+void gpio_set_dir_masked(uint32_t mask, uint32_t value)
+{
+    sim_dir = (sim_dir & ~mask) | (value & mask);
+}
+
+void gpio_pull_up(uint gpio)
+{
+    sim_pull_up |= 1u << gpio;
+}
+
+void gpio_pull_down(uint gpio)
+{
+    sim_pull_up &= ~(1u << gpio);
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    gpio_put_masked(1u << gpio, value ? 1u << gpio : 0);
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+    uint32_t old = sim_out;
+    sim_out = (sim_out & ~mask) | (value & mask);
+    sim_gpio_outputs(old);
+}
+
+void gpio_xor_mask(uint32_t mask)
+{
+    uint32_t old = sim_out;
+    sim_out ^= mask;
+    sim_gpio_outputs(old);
+}
+
+bool gpio_get(uint gpio)
+{
+    return ((sim_dir & (1u << gpio)) ? sim_out : sim_in) & (1u << gpio);
+}
+
+uint32_t gpio_get_all(void)
+{
+    return (sim_dir & sim_out) | (~sim_dir & sim_in);
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled)
+{
+    sim_latched[gpio] &= ~events; ///< The SDK acknowledges the stale edges
+    if (enabled) sim_irq_events[gpio] |= events;
+    else sim_irq_events[gpio] &= ~events;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback)
+{
+    gpio_set_irq_enabled(gpio, events, enabled);
+    gpio_set_irq_callback(callback);
+    if (enabled) irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void gpio_set_irq_callback(gpio_irq_callback_t callback)
+{
+    sim_callback = callback;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t events)
+{
+    sim_latched[gpio] &= ~events;
+}
+
+void gpio_set_dormant_irq_enabled(uint gpio, uint32_t events, bool enabled)
+{
+    if (enabled) sim_dormant_events[gpio] |= events;
+    else sim_dormant_events[gpio] &= ~events;
+}
+
+// -------------------------------------------------------------
+// ---------------- PWM ----------------------------------------
+// -------------------------------------------------------------
+
+/**
+ * @brief A slice, only its period and its wrap interrupt.
+ *
+ */
+typedef struct{
+    pwm_config config;
+    bool enabled;
+    double next_us;     ///< Time of the next wrap
+}sim_slice_t;
+
+static sim_slice_t sim_slices[NUM_PWM_SLICES];
+static uint32_t sim_pwm_inte;
+static uint32_t sim_pwm_intr;
+
+static double sim_pwm_period_us(const sim_slice_t *slice)
+{
+    const pwm_config *c = &slice->config;
+    return (c->top + 1.0)*c->div*(c->phase_correct ? 2 : 1)*1e6/SIM_CLK_SYS_HZ;
+}
+
+static bool sim_pwm_level(void)
+{
+    return sim_pwm_intr & sim_pwm_inte;
+}
+
+static void sim_pwm_advance(uint64_t now)
+{
+    for (uint i = 0; i < NUM_PWM_SLICES; i++) {
+        sim_slice_t *slice = &sim_slices[i];
+        if (!slice->enabled || slice->next_us > now) continue;
+        double period = sim_pwm_period_us(slice);
+        while (slice->next_us <= now) slice->next_us += period;
+        sim_pwm_intr |= 1u << i;
+    }
+}
+
+static uint64_t sim_pwm_deadline(void)
+{
+    uint64_t t = SIM_NONE;
+    for (uint i = 0; i < NUM_PWM_SLICES; i++) {
+        uint64_t wrap = (uint64_t)ceil(sim_slices[i].next_us);
+        if (sim_slices[i].enabled && wrap < t) t = wrap;
+    }
+    return t;
+}
+
+uint64_t sim_gpio_deadline(uint64_t now)
+{
+    uint64_t t = sim_pwm_deadline();
+    for (int i = 0; i < sim_num_presses; i++) { ///< Both edges of each press
+        uint64_t release = sim_presses[i] + SIM_BUTTON_HOLD_MS*1000;
+        if (sim_presses[i] > now && sim_presses[i] < t) t = sim_presses[i];
+        if (release > now && release < t) t = release;
+    }
+    return t;
+}
+
+pwm_config pwm_get_default_config(void)
+{
+    pwm_config c = {false, 1.0f, 0xffff};
+    return c;
+}
+
+void pwm_config_set_phase_correct(pwm_config *c, bool phase_correct)
+{
+    c->phase_correct = phase_correct;
+}
+
+void pwm_config_set_clkdiv(pwm_config *c, float div)
+{
+    c->div = div;
+}
+
+void pwm_config_set_clkdiv_mode(pwm_config *c, enum pwm_clkdiv_mode mode)
+{
+    if (mode != PWM_DIV_FREE_RUNNING) sim_fault("only the free running PWM is simulated");
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap)
+{
+    c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start)
+{
+    sim_slices[slice_num].config = *c;
+    sim_slices[slice_num].enabled = false;
+    pwm_set_enabled(slice_num, start);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled)
+{
+    sim_slice_t *slice = &sim_slices[slice_num];
+    if (enabled && !slice->enabled) slice->next_us = sim_now_us() + sim_pwm_period_us(slice); ///< The counter starts from 0
+    slice->enabled = enabled;
+}
+
+void pwm_set_irq_enabled(uint slice_num, bool enabled)
+{
+    if (enabled) sim_pwm_inte |= 1u << slice_num;
+    else sim_pwm_inte &= ~(1u << slice_num);
+}
+
+uint32_t pwm_get_irq_status_mask(void)
+{
+    return sim_pwm_intr & sim_pwm_inte;
+}
+
+void pwm_clear_irq(uint slice_num)
+{
+    sim_pwm_intr &= ~(1u << slice_num);
+}
@@ -0,0 +1,142 @@
+/**
+ * \file        sim_i2c.c
+ * \brief       Host build: I2C controllers, their DMA transfers and the targets on the buses.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+
+#include "sim.h"
+
+#define SIM_I2C_BITS 9  ///< Bits of a byte on the bus: 8 data and the acknowledge
+
+struct i2c_inst{
+    i2c_hw_t hw;
+    uint index;
+    uint baudrate;
+    const sim_i2c_target_t *target; ///< Target of the transfer in progress, NULL if none
+    bool nak;                       ///< The transfer in progress was aborted
+    bool active;                    ///< A byte of the DMA is on the bus
+    uint64_t end_us;                ///< The byte on the bus ends
+};
+
+static struct i2c_inst sim_i2cs[2] = {{.index = 0}, {.index = 1}};
+i2c_inst_t *i2c0 = &sim_i2cs[0];
+i2c_inst_t *i2c1 = &sim_i2cs[1];
+
+///< Targets of the buses
+static const sim_i2c_target_t *const sim_targets[] = {
+    &sim_lcd,
+};
+
+static const sim_i2c_target_t *sim_i2c_find(uint bus, uint8_t addr)
+{
+    for (uint i = 0; i < count_of(sim_targets); i++) {
+        if (sim_targets[i]->bus == bus && sim_targets[i]->addr == addr) return sim_targets[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief A byte of IC_DATA_CMD: the first one addresses the target, a NAK aborts the rest of the transfer.
+ *
+ */
+static void sim_i2c_byte(i2c_inst_t *i2c, uint32_t data_cmd)
+{
+    if (!i2c->target && !i2c->nak) {
+        i2c->hw.raw_intr_stat &= ~I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+        i2c->target = sim_i2c_find(i2c->index, (uint8_t)i2c->hw.tar);
+        i2c->nak = !i2c->target || !i2c->target->ack();
+        if (i2c->nak) {
+            i2c->target = NULL;
+            i2c->hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+        }
+    }
+    if (i2c->target) i2c->target->write((uint8_t)data_cmd);
+    if (data_cmd & I2C_IC_DATA_CMD_STOP_BITS) {
+        if (i2c->target) i2c->target->stop();
+        i2c->target = NULL;
+        i2c->nak = false;
+    }
+}
+
+static double sim_i2c_byte_us(const i2c_inst_t *i2c)
+{
+    return SIM_I2C_BITS*1e6/i2c->baudrate;
+}
+
+void sim_i2c_advance(uint64_t now)
+{
+    for (int i = 0; i < 2; i++) {
+        i2c_inst_t *i2c = &sim_i2cs[i];
+        while (!i2c->active || i2c->end_us <= now) {
+            uint32_t data_cmd;
+            if (!(i2c->hw.dma_cr & I2C_IC_DMA_CR_TDMAE_BITS) || !sim_dma_pull(i2c_get_dreq(i2c, true), &data_cmd)) {
+                if (i2c->end_us <= now) i2c->active = false;
+                break;
+            }
+            i2c->end_us = (i2c->active ? i2c->end_us : now) + (uint64_t)sim_i2c_byte_us(i2c);
+            i2c->active = true;
+            sim_i2c_byte(i2c, data_cmd);
+        }
+    }
+}
+
+uint64_t sim_i2c_deadline(uint64_t now)
+{
+    uint64_t t = SIM_NONE;
+    for (int i = 0; i < 2; i++) {
+        if (sim_i2cs[i].active && sim_i2cs[i].end_us < t) t = sim_i2cs[i].end_us;
+    }
+    return t;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->hw.enable = 1;
+    i2c->hw.raw_intr_stat = 0;
+    i2c->hw.dma_cr = I2C_IC_DMA_CR_TDMAE_BITS; ///< As the SDK does
+    i2c->target = NULL;
+    i2c->nak = false;
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+    i2c->hw.enable = 0;
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c)
+{
+    return &i2c->hw;
+}
+
+uint i2c_hw_index(i2c_inst_t *i2c)
+{
+    return i2c->index;
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx)
+{
+    return i2c->index ? (is_tx ? DREQ_I2C1_TX : DREQ_I2C1_RX) : (is_tx ? DREQ_I2C0_TX : DREQ_I2C0_RX);
+}
+
+/**
+ * @brief The transfer at once, the bus is free between the transfers of the DMA.
+ *
+ */
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    i2c->hw.tar = addr;
+    for (size_t i = 0; i < len; i++) {
+        sim_i2c_byte(i2c, src[i] | ((i == len - 1 && !nostop) ? I2C_IC_DATA_CMD_STOP_BITS : 0));
+    }
+    return (i2c->hw.raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) ? PICO_ERROR_GENERIC : (int)len;
+}
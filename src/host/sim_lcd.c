@@ -0,0 +1,140 @@
+/**
+ * \file        sim_lcd.c
+ * \brief       Host build: model of the 16x2 display, an HD44780 behind a PCF8574 I2C expander.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+
+#include "sim.h"
+
+// Pins of the expander
+#define SIM_LCD_RS 0x01
+#define SIM_LCD_E 0x04
+#define SIM_LCD_COLS 16
+#define SIM_LCD_ROWS 2
+#define SIM_LCD_DDRAM 80    ///< Two lines of 40 characters, at the addresses 0x00 and 0x40
+
+static bool sim_lcd_supplied;
+static bool sim_lcd_4bit;               ///< Interface of 4 bits, else 8 bits
+static bool sim_lcd_high;               ///< The next nibble is the high one of a byte
+static uint8_t sim_lcd_nibble;          ///< High nibble received
+static uint8_t sim_lcd_port;            ///< Outputs of the expander
+static uint8_t sim_lcd_addr;            ///< Address counter of the DDRAM
+static char sim_lcd_ddram[SIM_LCD_DDRAM];
+static char sim_lcd_shown[SIM_LCD_ROWS][SIM_LCD_COLS + 1]; ///< Text of the last log
+
+/**
+ * @brief The state after the supply is applied: 8 bit interface, blank DDRAM.
+ *
+ */
+static void sim_lcd_reset(void)
+{
+    sim_lcd_4bit = false;
+    sim_lcd_high = true;
+    sim_lcd_addr = 0;
+    sim_lcd_port = 0;
+    memset(sim_lcd_ddram, ' ', sizeof(sim_lcd_ddram));
+}
+
+static uint8_t sim_lcd_index(uint8_t addr)
+{
+    return (addr & 0x40) ? 40 + (addr & 0x3f) % 40 : (addr & 0x3f) % 40;
+}
+
+/**
+ * @brief An instruction, decoded by its highest bit set.
+ *
+ */
+static void sim_lcd_command(uint8_t cmd)
+{
+    if (cmd & 0x80) sim_lcd_addr = cmd & 0x7f;  ///< Set DDRAM address
+    else if (cmd & 0x40) return;                ///< Set CGRAM address, not modeled
+    else if (cmd & 0x20) {                      ///< Function set: DL selects the interface
+        sim_lcd_4bit = !(cmd & 0x10);
+        sim_lcd_high = true;
+    } else if (cmd & 0x1c) return;              ///< Shift, display control, entry mode: not modeled
+    else if (cmd & 0x02) sim_lcd_addr = 0;      ///< Return home
+    else if (cmd & 0x01) {                      ///< Clear display
+        memset(sim_lcd_ddram, ' ', sizeof(sim_lcd_ddram));
+        sim_lcd_addr = 0;
+    }
+}
+
+/**
+ * @brief A character at the address counter, which wraps from the end of a line to the start of the other.
+ *
+ */
+static void sim_lcd_data(uint8_t data)
+{
+    sim_lcd_ddram[sim_lcd_index(sim_lcd_addr)] = (char)data;
+    if (sim_lcd_addr == 0x27) sim_lcd_addr = 0x40;
+    else if (sim_lcd_addr == 0x67) sim_lcd_addr = 0x00;
+    else sim_lcd_addr++;
+}
+
+/**
+ * @brief A nibble latched on the falling edge of E. In the 8 bit interface D0-D3 are not wired and
+ * each nibble is a whole instruction.
+ *
+ */
+static void sim_lcd_latch(uint8_t port)
+{
+    uint8_t nibble = port >> 4;
+    uint8_t value;
+    if (!sim_lcd_4bit) value = nibble << 4;
+    else if (sim_lcd_high) {
+        sim_lcd_nibble = nibble;
+        sim_lcd_high = false;
+        return;
+    } else {
+        value = (sim_lcd_nibble << 4) | nibble;
+        sim_lcd_high = true;
+    }
+    if (port & SIM_LCD_RS) sim_lcd_data(value);
+    else sim_lcd_command(value);
+}
+
+static bool sim_lcd_ack(void)
+{
+    bool supplied = sim_gpio_out(SIM_LCD_EN_GPIO);
+    if (supplied != sim_lcd_supplied) sim_lcd_reset();
+    sim_lcd_supplied = supplied;
+    return supplied;
+}
+
+static void sim_lcd_write(uint8_t data)
+{
+    if ((sim_lcd_port & SIM_LCD_E) && !(data & SIM_LCD_E)) sim_lcd_latch(data);
+    sim_lcd_port = data;
+}
+
+/**
+ * @brief Log the visible text when a transfer changes it.
+ *
+ */
+static void sim_lcd_stop(void)
+{
+    char text[SIM_LCD_ROWS][SIM_LCD_COLS + 1];
+    for (int row = 0; row < SIM_LCD_ROWS; row++) {
+        memcpy(text[row], &sim_lcd_ddram[row*40], SIM_LCD_COLS);
+        text[row][SIM_LCD_COLS] = '\0';
+        for (int col = 0; col < SIM_LCD_COLS; col++) {
+            if (text[row][col] < ' ' || text[row][col] > '~') text[row][col] = '?';
+        }
+    }
+    if (!memcmp(text, sim_lcd_shown, sizeof(text))) return;
+    memcpy(sim_lcd_shown, text, sizeof(text));
+    sim_log("LCD |%s|%s|", text[0], text[1]);
+}
+
+const sim_i2c_target_t sim_lcd = {
+    .bus = SIM_LCD_I2C,
+    .addr = SIM_LCD_ADDR,
+    .ack = sim_lcd_ack,
+    .write = sim_lcd_write,
+    .stop = sim_lcd_stop,
+};
@@ -0,0 +1,328 @@
+/**
+ * \file        sim_uart.c
+ * \brief       Host build: UARTs paced at their baudrate, the GPS on a pseudo terminal or a replay file.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#include "sim.h"
+
+#define SIM_UART_FIFO 32            ///< Bytes of the receive FIFO
+#define SIM_UART_BITS 10            ///< Bits of a byte on the line: start, 8 data, stop
+#define SIM_UART_TIMEOUT_BITS 32    ///< Idle bits before the receive timeout
+#define SIM_GPS_EPOCH_US 1000000    ///< A burst of the replay file each second
+#define SIM_GPS_QUEUE 4096
+
+struct uart_inst{
+    uart_hw_t hw;
+    uint index;
+    uint baudrate;
+    uint8_t fifo[SIM_UART_FIFO];    ///< Received and not taken by the DMA
+    uint8_t fifo_level;
+    double rx_next_us;              ///< The last byte of the line was received
+    uint64_t timeout_us;            ///< Receive timeout pending, SIM_NONE if not
+    uint64_t tx_end_us;             ///< The byte being sent leaves the line
+    bool tx_busy;
+};
+
+static struct uart_inst sim_uarts[2] = {{.index = 0}, {.index = 1}};
+uart_inst_t *uart0 = &sim_uarts[0];
+uart_inst_t *uart1 = &sim_uarts[1];
+
+// The GPS: a pseudo terminal or the bursts of a replay file
+static int sim_gps_fd = -1;
+static int sim_gps_slave = -1;          ///< Kept open, the master does not hang up without a client
+static uint8_t *sim_replay;
+static size_t sim_replay_len;
+static size_t sim_replay_pos;
+static uint64_t sim_burst_us;           ///< Start of the next burst of the replay file
+static uint8_t sim_queue[SIM_GPS_QUEUE];///< Bytes of the GPS waiting for the line
+static size_t sim_queue_head, sim_queue_tail;
+
+static double sim_byte_us(const uart_inst_t *uart)
+{
+    return SIM_UART_BITS*1e6/uart->baudrate;
+}
+
+static bool sim_uart_level(uart_inst_t *uart)
+{
+    uart_hw_t *hw = &uart->hw;
+    hw->ris &= ~hw->icr; ///< The writes to clear take effect here
+    hw->icr = 0;
+    hw->mis = hw->ris & hw->imsc;
+    return hw->mis;
+}
+
+static bool sim_uart0_level(void) { return sim_uart_level(uart0); }
+static bool sim_uart1_level(void) { return sim_uart_level(uart1); }
+
+/**
+ * @brief A new epoch starts at a NAV-POSLLH frame or a GGA sentence, or the file is one epoch.
+ *
+ */
+static bool sim_replay_epoch(size_t i)
+{
+    if (i == 0) return true;
+    const uint8_t *p = &sim_replay[i];
+    size_t left = sim_replay_len - i;
+    if (left >= 4 && p[0] == 0xB5 && p[1] == 0x62 && p[2] == 0x01 && p[3] == 0x02) return true;
+    return left >= 6 && p[0] == '$' && !memcmp(&p[3], "GGA", 3);
+}
+
+static bool sim_gps_open_replay(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    sim_replay = malloc(len > 0 ? len : 1);
+    bool ok = len > 0 && sim_replay && fread(sim_replay, 1, len, f) == (size_t)len;
+    fclose(f);
+    sim_replay_len = ok ? len : 0;
+    return ok;
+}
+
+static bool sim_gps_open_pty(void)
+{
+    sim_gps_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (sim_gps_fd < 0 || grantpt(sim_gps_fd) || unlockpt(sim_gps_fd)) return false;
+    const char *name = ptsname(sim_gps_fd);
+    sim_gps_slave = name ? open(name, O_RDWR | O_NOCTTY) : -1;
+    if (sim_gps_slave < 0) return false;
+    struct termios tio;
+    tcgetattr(sim_gps_slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(sim_gps_slave, TCSANOW, &tio);
+    sim_log("GPS terminal %s", name);
+    return true;
+}
+
+/**
+ * @brief GPS of TRACKER_SIM_GPS.
+ *
+ */
+void sim_uart_init(void)
+{
+    sim_irq_set_level(UART0_IRQ, sim_uart0_level);
+    sim_irq_set_level(UART1_IRQ, sim_uart1_level);
+    for (int i = 0; i < 2; i++) {
+        sim_uarts[i].baudrate = 115200;
+        sim_uarts[i].timeout_us = SIM_NONE;
+        sim_uarts[i].hw.fr = UART_UARTFR_RXFE_BITS | UART_UARTFR_TXFE_BITS;
+    }
+    const char *path = getenv("TRACKER_SIM_GPS");
+    if (path && !sim_gps_open_replay(path)) sim_fault("TRACKER_SIM_GPS: %s can not be read", path);
+    if (!path && !sim_gps_open_pty()) sim_fault("no pseudo terminal for the GPS");
+}
+
+int sim_uart_fd(void)
+{
+    return sim_gps_fd;
+}
+
+/**
+ * @brief Bytes sent by the GPS since the last call: what the terminal has, or the bursts due.
+ *
+ */
+static void sim_gps_produce(uint64_t now)
+{
+    uint8_t buf[256];
+    if (sim_burst_us + SIM_GPS_EPOCH_US <= now) sim_burst_us = now; ///< No catch up of the epochs missed
+    for (;;) {
+        size_t room = SIM_GPS_QUEUE - (sim_queue_head - sim_queue_tail);
+        if (room == 0) return;
+        if (room > sizeof(buf)) room = sizeof(buf);
+        ssize_t n = 0;
+        if (sim_gps_fd >= 0) {
+            n = read(sim_gps_fd, buf, room);
+        } else if (sim_replay_len && sim_burst_us <= now) {
+            do { ///< Up to the start of the next epoch
+                buf[n++] = sim_replay[sim_replay_pos++];
+                if (sim_replay_pos == sim_replay_len) sim_replay_pos = 0;
+            } while ((size_t)n < room && !sim_replay_epoch(sim_replay_pos));
+            if (sim_replay_epoch(sim_replay_pos)) sim_burst_us += SIM_GPS_EPOCH_US;
+        }
+        if (n <= 0) return;
+        for (ssize_t i = 0; i < n; i++) sim_queue[sim_queue_head++ % SIM_GPS_QUEUE] = buf[i];
+    }
+}
+
+/**
+ * @brief A byte received: to the DMA if it is enabled and has a channel, else to the FIFO.
+ *
+ */
+static void sim_uart_receive(uart_inst_t *uart, uint8_t data)
+{
+    uart->hw.dr = data;
+    if ((uart->hw.dmacr & UART_UARTDMACR_RXDMAE_BITS) && sim_dma_push(uart_get_dreq(uart, false), data)) return;
+    if (uart->fifo_level < SIM_UART_FIFO) uart->fifo[uart->fifo_level++] = data;
+    uart->hw.fr &= ~UART_UARTFR_RXFE_BITS;
+}
+
+/**
+ * @brief The line of the GPS: each byte takes its time at the baudrate of the UART, and the receive
+ * timeout is raised after the last one of a burst. The hardware raises it with bytes left in the FIFO,
+ * here the DMA empties the FIFO so it is raised when the line is idle.
+ *
+ */
+static void sim_uart_rx(uart_inst_t *uart, uint64_t now)
+{
+    if (sim_queue_head == sim_queue_tail && uart->rx_next_us < now) uart->rx_next_us = now; ///< Idle line
+    sim_gps_produce(now);
+    bool powered = sim_gpio_out(SIM_GPS_EN_GPIO);
+    while (sim_queue_head != sim_queue_tail && uart->rx_next_us + sim_byte_us(uart) <= now) {
+        uart->rx_next_us += sim_byte_us(uart);
+        uint8_t data = sim_queue[sim_queue_tail++ % SIM_GPS_QUEUE];
+        if (!powered) continue; ///< Without supply the GPS sends nothing
+        sim_uart_receive(uart, data);
+        uart->timeout_us = (uint64_t)ceil(uart->rx_next_us + SIM_UART_TIMEOUT_BITS*1e6/uart->baudrate);
+    }
+    if (uart->timeout_us <= now && sim_queue_head == sim_queue_tail) {
+        uart->hw.ris |= UART_UARTIMSC_RTIM_BITS;
+        uart->timeout_us = SIM_NONE;
+    }
+}
+
+/**
+ * @brief Bytes of the TX DMA, each one busy on the line for its time.
+ *
+ */
+static void sim_uart_tx(uart_inst_t *uart, uint64_t now)
+{
+    while (!uart->tx_busy || uart->tx_end_us <= now) {
+        uint32_t data;
+        if (!(uart->hw.dmacr & UART_UARTDMACR_TXDMAE_BITS) || !sim_dma_pull(uart_get_dreq(uart, true), &data)) {
+            if (uart->tx_busy && uart->tx_end_us <= now) uart->tx_busy = false;
+            break;
+        }
+        uart->tx_end_us = (uart->tx_busy ? uart->tx_end_us : now) + sim_byte_us(uart);
+        uart->tx_busy = true;
+        uint8_t byte = (uint8_t)data;
+        if (uart->index == SIM_GPS_UART && sim_gps_fd >= 0 && write(sim_gps_fd, &byte, 1) != 1) sim_log("GPS byte lost");
+    }
+    if (uart->tx_busy) uart->hw.fr |= UART_UARTFR_BUSY_BITS;
+    else uart->hw.fr &= ~UART_UARTFR_BUSY_BITS;
+}
+
+void sim_uart_advance(uint64_t now)
+{
+    for (int i = 0; i < 2; i++) {
+        if (sim_uarts[i].index == SIM_GPS_UART) sim_uart_rx(&sim_uarts[i], now);
+        sim_uart_tx(&sim_uarts[i], now);
+    }
+}
+
+uint64_t sim_uart_deadline(uint64_t now)
+{
+    uint64_t t = SIM_NONE;
+    for (int i = 0; i < 2; i++) {
+        const uart_inst_t *uart = &sim_uarts[i];
+        uint64_t d = SIM_NONE;
+        if (uart->index == SIM_GPS_UART && sim_queue_head != sim_queue_tail) d = (uint64_t)ceil(uart->rx_next_us + sim_byte_us(uart));
+        else if (uart->index == SIM_GPS_UART && sim_replay_len) d = sim_burst_us;
+        if (uart->timeout_us < d) d = uart->timeout_us;
+        if (uart->tx_busy && uart->tx_end_us < d) d = uart->tx_end_us;
+        if (d < t) t = d;
+    }
+    return t < now ? now : t;
+}
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart)
+{
+    return &uart->hw;
+}
+
+uint uart_get_index(uart_inst_t *uart)
+{
+    return uart->index;
+}
+
+uint uart_get_dreq(uart_inst_t *uart, bool is_tx)
+{
+    return uart->index ? (is_tx ? DREQ_UART1_TX : DREQ_UART1_RX) : (is_tx ? DREQ_UART0_TX : DREQ_UART0_RX);
+}
+
+uint uart_init(uart_inst_t *uart, uint baudrate)
+{
+    uart->fifo_level = 0;
+    uart->hw.imsc = 0;
+    uart->hw.ris = 0;
+    uart->hw.dmacr = UART_UARTDMACR_RXDMAE_BITS | UART_UARTDMACR_TXDMAE_BITS; ///< As the SDK does
+    uart->rx_next_us = sim_now_us();
+    return uart_set_baudrate(uart, baudrate);
+}
+
+void uart_deinit(uart_inst_t *uart)
+{
+    uart->hw.dmacr = 0;
+}
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate)
+{
+    uart->baudrate = baudrate;
+    return baudrate;
+}
+
+void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled)
+{
+}
+
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data)
+{
+    uart->hw.imsc = (rx_has_data ? UART_UARTIMSC_RXIM_BITS | UART_UARTIMSC_RTIM_BITS : 0) |
+                    (tx_needs_data ? UART_UARTIMSC_TXIM_BITS : 0);
+}
+
+bool uart_is_readable(uart_inst_t *uart)
+{
+    return uart->fifo_level;
+}
+
+bool uart_is_writable(uart_inst_t *uart)
+{
+    return true;
+}
+
+char uart_getc(uart_inst_t *uart)
+{
+    while (!uart->fifo_level) tight_loop_contents();
+    char c = (char)uart->fifo[0];
+    memmove(uart->fifo, uart->fifo + 1, --uart->fifo_level);
+    if (!uart->fifo_level) uart->hw.fr |= UART_UARTFR_RXFE_BITS;
+    return c;
+}
+
+void uart_putc_raw(uart_inst_t *uart, char c)
+{
+    if (uart->index == SIM_GPS_UART && sim_gps_fd >= 0 && write(sim_gps_fd, &c, 1) != 1) sim_log("GPS byte lost");
+}
+
+void uart_putc(uart_inst_t *uart, char c)
+{
+    uart_putc_raw(uart, c);
+}
+
+void uart_puts(uart_inst_t *uart, const char *s)
+{
+    while (*s) uart_putc(uart, *s++);
+}
+
+void uart_tx_wait_blocking(uart_inst_t *uart)
+{
+    while (uart->hw.fr & UART_UARTFR_BUSY_BITS) tight_loop_contents();
+}
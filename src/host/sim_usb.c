@@ -0,0 +1,135 @@
+/**
+ * \file        sim_usb.c
+ * \brief       Host build: the USB serial port of stdio on the standard input and output of the process.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/irq.h"
+
+#include "sim.h"
+
+static bool sim_eof;                        ///< The standard input is closed
+static bool sim_notified;                   ///< The callback was called and the data is not read yet
+static bool sim_rx_pending;                 ///< Line of the callback
+static void (*sim_rx_callback)(void *param);
+static void *sim_rx_param;
+
+static bool sim_usb_readable(void)
+{
+    if (sim_eof) return false;
+    struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+    return poll(&fd, 1, 0) > 0;
+}
+
+static bool sim_usb_level(void)
+{
+    return sim_rx_pending;
+}
+
+static void sim_usb_irq_handler(void)
+{
+    sim_rx_pending = false;
+    sim_notified = true;
+    if (sim_rx_callback) sim_rx_callback(sim_rx_param);
+}
+
+void sim_usb_init(void)
+{
+    sim_irq_set_level(USBCTRL_IRQ, sim_usb_level);
+    irq_set_exclusive_handler(USBCTRL_IRQ, sim_usb_irq_handler);
+}
+
+/**
+ * @brief The callback is raised once for the data available, like the SDK: again after it is read.
+ *
+ */
+void sim_usb_advance(uint64_t now)
+{
+    if (sim_rx_callback && !sim_notified && !sim_rx_pending && sim_usb_readable()) sim_rx_pending = true;
+}
+
+int sim_usb_fd(void)
+{
+    return sim_eof ? -1 : STDIN_FILENO;
+}
+
+static void sim_usb_out_chars(const char *buf, int len)
+{
+    fwrite(buf, 1, len, stdout);
+}
+
+static void sim_usb_out_flush(void)
+{
+    fflush(stdout);
+}
+
+static int sim_usb_in_chars(char *buf, int len)
+{
+    if (!sim_usb_readable()) {
+        sim_notified = false;
+        return PICO_ERROR_NO_DATA;
+    }
+    ssize_t n = read(STDIN_FILENO, buf, len);
+    if (n > 0) return (int)n;
+    sim_eof = true;
+    sim_notified = false;
+    return PICO_ERROR_NO_DATA;
+}
+
+stdio_driver_t stdio_usb = {
+    .out_chars = sim_usb_out_chars,
+    .out_flush = sim_usb_out_flush,
+    .in_chars = sim_usb_in_chars,
+};
+
+bool stdio_usb_init(void)
+{
+    irq_set_enabled(USBCTRL_IRQ, true);
+    return true;
+}
+
+bool stdio_usb_connected(void)
+{
+    return true;
+}
+
+bool stdio_init_all(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return stdio_usb_init();
+}
+
+void stdio_flush(void)
+{
+    fflush(stdout);
+}
+
+int getchar_timeout_us(uint32_t timeout_us)
+{
+    uint64_t end = sim_now_us() + timeout_us;
+    char c;
+    for (;;) {
+        if (sim_usb_in_chars(&c, 1) == 1) return (uint8_t)c;
+        if (sim_now_us() >= end) return PICO_ERROR_TIMEOUT;
+        tight_loop_contents();
+    }
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *param), void *param)
+{
+    sim_rx_callback = fn;
+    sim_rx_param = param;
+}
+
+void setup_default_uart(void)
+{
+}
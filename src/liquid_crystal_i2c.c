@@ -1,5 +1,35 @@
 #include "liquid_crystal_i2c.h"
 
+static const uint8_t lcd_row_addr[LCD_MAX_ROWS] = {0x00, 0x40, 0x14, 0x54}; ///< DDRAM address of each row
+
+/**
+ * @brief The four I2C bytes of a byte for the display (PCF8574: D7-D4, backlight, E, R/W, RS)
+ * 
+ */
+static inline void lcd_nibbles(uint8_t *buf, uint8_t val, uint8_t mode)
+{
+    uint8_t high_nibble = mode | (val & 0xF0) | LCD_BACKLIGHT;
+    uint8_t low_nibble =  mode | ((val << 4) & 0xF0) | LCD_BACKLIGHT;
+    buf[0] = high_nibble | LCD_ENABLE_BIT;
+    buf[1] = high_nibble & ~LCD_ENABLE_BIT;
+    buf[2] = low_nibble | LCD_ENABLE_BIT;
+    buf[3] = low_nibble & ~LCD_ENABLE_BIT;
+}
+
+/**
+ * @brief Append a byte for the display to the DMA transfer
+ * 
+ */
+static inline uint16_t lcd_tx_byte(lcd_t *lcd, uint16_t n, uint8_t val, uint8_t mode)
+{
+    uint8_t buf[LCD_NIBBLES];
+    lcd_nibbles(buf, val, mode);
+    for (uint8_t i = 0; i < LCD_NIBBLES; i++) {
+        lcd->tx[n++] = buf[i];
+    }
+    return n;
+}
+
 void lcd_init(lcd_t *lcd, uint8_t addr, i2c_inst_t *i2c, uint8_t cols, uint8_t rows, 
             uint16_t baudrate, uint8_t sda, uint8_t scl, uint8_t en_gpio)
 {
@@ -15,10 +45,15 @@ void lcd_init(lcd_t *lcd, uint8_t addr, i2c_inst_t *i2c, uint8_t cols, uint8_t r
     lcd->en_gpio = en_gpio;
     lcd->display = 0;
     lcd->cursor = 0;
-    lcd->temp_message = NULL;
-    lcd->num_alarm = TIMER_IRQ_0;
+    swt_timer_init(&lcd->timer, lcd_initialization_timer_handler, lcd);
     lcd->pos_secuence = 0;
     lcd->en = false;
+    lcd->flushes = 0;
+    lcd->cells = 0;
+    if (lcd->cols > LCD_MAX_COLS) lcd->cols = LCD_MAX_COLS;
+    if (lcd->rows > LCD_MAX_ROWS) lcd->rows = LCD_MAX_ROWS;
+    lcd_fb_clear(lcd);
+    memset(lcd->shown, ' ', sizeof(lcd->shown));
 
     // Initialize the I2C communication
     i2c_init(lcd->i2c, baudrate*1000);
@@ -29,6 +64,15 @@ void lcd_init(lcd_t *lcd, uint8_t addr, i2c_inst_t *i2c, uint8_t cols, uint8_t r
     gpio_init(en_gpio);
     gpio_set_dir(en_gpio, GPIO_OUT);
     gpio_put(en_gpio, 0); ///< active HIGH
+
+    // The transfers of lcd_flush() are paced by the I2C TX FIFO. i2c_init() enables its DMA handshake
+    lcd->dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(lcd->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);    ///< IC_DATA_CMD: data and the STOP bit
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(lcd->i2c, true));
+    dma_channel_configure(lcd->dma_chan, &c, &i2c_get_hw(lcd->i2c)->data_cmd, lcd->tx, 0, false);
 }
 
 void lcd_write(lcd_t *lcd, uint8_t val)
@@ -40,6 +84,7 @@ void lcd_write(lcd_t *lcd, uint8_t val)
 void lcd_clear_display(lcd_t *lcd)
 {
     lcd_send_byte(lcd, LCD_CLEAR_DISPLAY, LCD_COMMAND);
+    memset(lcd->shown, ' ', sizeof(lcd->shown)); ///< The framebuffer is drawn again by the next flush
 }
 
 void lcd_return_home(lcd_t *lcd)
@@ -49,8 +94,7 @@ void lcd_return_home(lcd_t *lcd)
 
 void lcd_move_cursor(lcd_t *lcd, uint8_t row, uint8_t col)
 {
-    int val = (row == 0) ? 0x80 + col : 0xC0 + col;
-    lcd_send_byte(lcd, val, LCD_COMMAND);
+    lcd_send_byte(lcd, LCD_SETDDRAMADDR | (lcd_row_addr[row % LCD_MAX_ROWS] + col), LCD_COMMAND);
 }
 
 void lcd_send_byte(lcd_t *lcd, uint8_t val, uint8_t mode)
@@ -59,19 +103,11 @@ void lcd_send_byte(lcd_t *lcd, uint8_t val, uint8_t mode)
     // high nibble is sent first, followed by the low nibble. The
     // transfer is done in 4-bit mode, so the high nibble is sent first
     // by shifting the byte 4 places to the right. The high nibble is
-    // then sent by masking the byte with 0x0F.
-    uint8_t high_nibble = mode | (val & 0xF0) | LCD_BACKLIGHT;
-    uint8_t low_nibble =  mode | ((val << 4) & 0xF0) | LCD_BACKLIGHT;
-    //lcd_write(lcd, high_nibble, low_nibble);
-
-    // Send high nibble
-    lcd_write(lcd, high_nibble | LCD_ENABLE_BIT);
-    lcd_write(lcd, high_nibble & ~LCD_ENABLE_BIT);
-
-    // Send low nibble
-    lcd_write(lcd, low_nibble | LCD_ENABLE_BIT);
-    lcd_write(lcd, low_nibble & ~LCD_ENABLE_BIT);
-
+    // then sent by masking the byte with 0x0F. The four bytes go in
+    // one I2C transaction.
+    uint8_t buf[LCD_NIBBLES];
+    lcd_nibbles(buf, val, mode);
+    i2c_write_blocking(lcd->i2c, lcd->addr, buf, LCD_NIBBLES, false);
 }
 
 void lcd_send_char(lcd_t *lcd, uint8_t character)
@@ -93,40 +129,61 @@ void lcd_send_str(lcd_t *lcd, uint8_t *str)
 
 void lcd_send_str_cursor(lcd_t *lcd, uint8_t *str, uint8_t row, uint8_t col)
 {
-    // Check if the display is able to receive data
-    if (!lcd->en) return;
-    //printf("LCD SET cursor\n");
-    lcd_move_cursor(lcd, row, col);
-    lcd->en = false;
-    //printf("LCD SER cursor finish\n");
-    lcd->temp_message = str;
-
-    lcd_send_str(lcd, str);
-    lcd->en = true;
+    lcd_print(lcd, (const char *)str, row, col);
+    lcd_flush(lcd);
+}
 
-    // // Setting the IRQ handler
-    // irq_set_exclusive_handler(TIMER_IRQ_0, lcd_send_str_callback);
-    // irq_set_enabled(TIMER_IRQ_0, true);
-    // hw_set_bits(&timer_hw->inte, 1u << lcd->num_alarm); // Enable alarm0 for signal value calculation
-    // timer_hw->alarm[lcd->num_alarm] = (uint32_t)(time_us_64() + 1000); // Set alarm0 to trigger in t_sample
+void lcd_print(lcd_t *lcd, const char *str, uint8_t row, uint8_t col)
+{
+    if (row >= lcd->rows) return;
+    while (*str && col < lcd->cols) {
+        lcd->fb[row][col++] = *str++;
+    }
 }
 
-void lcd_send_str_callback(void)
-{   
-    //printf("LCD Send str callback\n");
-    // Interrupt acknowledge
-    hw_clear_bits(&timer_hw->intr, 1u << gLcd.num_alarm);
+bool lcd_flush(lcd_t *lcd)
+{
+    // Check if the display is able to receive data
+    if (!lcd->en || dma_channel_is_busy(lcd->dma_chan)) return false;
+    i2c_hw_t *hw = i2c_get_hw(lcd->i2c);
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) { ///< The last transfer was not acknowledged: draw everything again
+        (void)hw->clr_tx_abrt;
+        memset(lcd->shown, 0, sizeof(lcd->shown));
+    }
 
-    // Send the string to the LCD
-    lcd_send_str(&gLcd, gLcd.temp_message);
-    gLcd.temp_message = NULL;
-    gLcd.en = true;
+    // Diff the framebuffer with the display: the address of each run of changed cells, then its characters
+    uint16_t n = 0;
+    for (uint8_t row = 0; row < lcd->rows; row++) {
+        bool run = false;
+        for (uint8_t col = 0; col < lcd->cols; col++) {
+            if (lcd->fb[row][col] == lcd->shown[row][col]) {
+                run = false;
+                continue;
+            }
+            if (!run) n = lcd_tx_byte(lcd, n, LCD_SETDDRAMADDR | (lcd_row_addr[row] + col), LCD_COMMAND);
+            n = lcd_tx_byte(lcd, n, (uint8_t)lcd->fb[row][col], LCD_CHARACTER);
+            lcd->shown[row][col] = lcd->fb[row][col];
+            lcd->cells++;
+            run = true;
+        }
+    }
+    if (n == 0) return true;
+
+    // One transaction: STOP after the last byte. The target address is only written while the block is idle
+    lcd->tx[n - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    if (hw->tar != lcd->addr) {
+        hw->enable = 0;
+        hw->tar = lcd->addr;
+        hw->enable = 1;
+    }
+    dma_channel_transfer_from_buffer_now(lcd->dma_chan, lcd->tx, n);
+    lcd->flushes++;
+    return true;
 }
 
-void lcd_initialization_timer_handler(void)
+void lcd_initialization_timer_handler(swt_timer_t *timer)
 {
-    // Interrupt acknowledge
-    hw_clear_bits(&timer_hw->intr, 1u << gLcd.num_alarm);
+    lcd_t *lcd = (lcd_t *)timer->param;
 
     // position of the sequence
     uint32_t time_next_secuence_us = 0;
@@ -137,60 +194,57 @@ void lcd_initialization_timer_handler(void)
     uint8_t lcd_display_ctrl = (LCD_DISPLAY_CONTROL | LCD_DISPLAY_ON);
     
     
-    switch (gLcd.pos_secuence)
+    switch (lcd->pos_secuence)
     {
     case 0:
-        lcd_send_byte(&gLcd, 0x03, LCD_COMMAND);
+        lcd_send_byte(lcd, 0x03, LCD_COMMAND);
         time_next_secuence_us = 8000;
         break;
     case 1:
-        lcd_send_byte(&gLcd, 0x03, LCD_COMMAND);
+        lcd_send_byte(lcd, 0x03, LCD_COMMAND);
         time_next_secuence_us = 100;
         break;
     case 2:
-        lcd_send_byte(&gLcd, 0x03, LCD_COMMAND);
+        lcd_send_byte(lcd, 0x03, LCD_COMMAND);
         time_next_secuence_us = 100;
         break;
     case 3:
-        lcd_send_byte(&gLcd, 0x02, LCD_COMMAND);
+        lcd_send_byte(lcd, 0x02, LCD_COMMAND);
         time_next_secuence_us = 150000;
         break;
     case 4:
         // Function set
-        lcd_send_byte(&gLcd, lcd_entry_mode, LCD_COMMAND);
+        lcd_send_byte(lcd, lcd_entry_mode, LCD_COMMAND);
         time_next_secuence_us = 40;
         break;
     case 5:
         // Display control
-        lcd_send_byte(&gLcd, lcd_function, LCD_COMMAND);
+        lcd_send_byte(lcd, lcd_function, LCD_COMMAND);
         time_next_secuence_us = 40;
         break;
     case 6:
         // Entry mode
-        lcd_send_byte(&gLcd, lcd_display_ctrl, LCD_COMMAND);
+        lcd_send_byte(lcd, lcd_display_ctrl, LCD_COMMAND);
         time_next_secuence_us = 40;
         break;
     case 7:
         // Display clear
-        lcd_clear_display(&gLcd);
+        lcd_clear_display(lcd);
         time_next_secuence_us = 2000;
         break;
     case 8:
-        gLcd.en = true;
+        lcd->en = true;
         printf("LCD initialized\n");
         break;
     default:
         break;
     }
 
-    gLcd.pos_secuence++;
+    lcd->pos_secuence++;
 
-    if (gLcd.pos_secuence <= 8)
+    if (lcd->pos_secuence <= 8)
     {
-        // Setting the IRQ handler
-        irq_set_exclusive_handler(gLcd.num_alarm, lcd_initialization_timer_handler);
-        irq_set_enabled(gLcd.num_alarm, true);
-        hw_set_bits(&timer_hw->inte, 1u << gLcd.num_alarm); // Enable alarm0 for signal value calculation
-        timer_hw->alarm[gLcd.num_alarm] = (uint32_t)(time_us_64() + time_next_secuence_us); // Set alarm0 to trigger in t_sample
+        // Next step, the delays are minimums: no slack
+        swt_start(timer, time_next_secuence_us, 0, 0);
     }
 }
\ No newline at end of file
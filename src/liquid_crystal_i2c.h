@@ -13,10 +13,14 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "pico.h"
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+
+#include "sw_timer.h"
 //#include "pico/binary_info.h"
 
 /**
@@ -72,6 +76,12 @@
 #define LCD_CHARACTER 0x01
 #define LCD_COMMAND 0x00
 
+// Framebuffer
+#define LCD_MAX_COLS 20     ///< Up to a 20x4 display
+#define LCD_MAX_ROWS 4
+#define LCD_NIBBLES 4       ///< I2C bytes of a byte for the display: each nibble with E high, then low
+#define LCD_TX_MAX (LCD_MAX_ROWS*(LCD_MAX_COLS + 1)*LCD_NIBBLES) ///< Every cell and the address of each row
+
 /** @} */
 
 /**
@@ -91,10 +101,15 @@ typedef struct{
     uint8_t en_gpio;    ///< Enable pin
     uint8_t display;    ///< Display state
     uint8_t cursor;     ///< Cursor state
-    char *temp_message; ///< Temporary message buffer
-    uint8_t num_alarm;  ///< Number of alarms of the LCD
+    swt_timer_t timer;  ///< Timer of the initialization sequence
     uint8_t pos_secuence; ///< Position of the initialization sequence
     bool en;            ///< Flag to check if the LCD is able to send data
+    char fb[LCD_MAX_ROWS][LCD_MAX_COLS];     ///< Framebuffer: what the display should show
+    char shown[LCD_MAX_ROWS][LCD_MAX_COLS];  ///< What the display shows, or will when the transfer ends
+    uint16_t tx[LCD_TX_MAX];    ///< Data and commands of the I2C transfer (IC_DATA_CMD), written by DMA
+    uint8_t dma_chan;   ///< DMA channel of the I2C transfers
+    uint32_t flushes;   ///< Transfers started
+    uint32_t cells;     ///< Cells sent, the rest were already shown
 }lcd_t;
 
 /**
@@ -176,7 +191,7 @@ void lcd_send_char(lcd_t *lcd, uint8_t character);
 void lcd_send_str(lcd_t *lcd, uint8_t *str);
 
 /**
- * @brief Send a string to the LCD at a specific position
+ * @brief Send a string to the LCD at a specific position: write it in the framebuffer and flush it
  * 
  * @param lcd Pointer to the LCD structure
  * @param str String to be sent
@@ -186,16 +201,53 @@ void lcd_send_str(lcd_t *lcd, uint8_t *str);
 void lcd_send_str_cursor(lcd_t *lcd, uint8_t *str, uint8_t row, uint8_t col);
 
 /**
- * @brief Handler fot the lcd timer interruptions.
+ * @brief Write a string in the framebuffer at a specific position, clipped at the end of the row.
+ * Nothing is sent until lcd_flush()
+ * 
+ * @param lcd Pointer to the LCD structure
+ * @param str String to be written
+ * @param row Number of the row position
+ * @param col Number of the column position
+ */
+void lcd_print(lcd_t *lcd, const char *str, uint8_t row, uint8_t col);
+
+/**
+ * @brief Clear the framebuffer, the display is cleared by the next lcd_flush()
  * 
+ * @param lcd Pointer to the LCD structure
  */
-void lcd_send_str_callback(void);
+static inline void lcd_fb_clear(lcd_t *lcd)
+{
+    memset(lcd->fb, ' ', sizeof(lcd->fb));
+}
 
 /**
- * @brief Handler for the lcd initialization sequence.
+ * @brief Send the cells of the framebuffer that differ from the display, in one I2C transfer by DMA.
+ * Each run of changed cells of a row is its DDRAM address and its characters. It returns without waiting
  * 
+ * @param lcd Pointer to the LCD structure
+ * @return true if the display shows the framebuffer, or will when the transfer ends. false if the LCD is
+ * not initialized or the previous transfer has not ended: flush again later
  */
-void lcd_initialization_timer_handler(void);
+bool lcd_flush(lcd_t *lcd);
+
+/**
+ * @brief Handler for the lcd initialization sequence: a step, and the timer of the next one.
+ * 
+ * @param timer Timer of the LCD, its param is the LCD structure
+ */
+void lcd_initialization_timer_handler(swt_timer_t *timer);
+
+/**
+ * @brief Start the initialization sequence of the LCD, after its power on. lcd->en is set at its end
+ * 
+ * @param lcd Pointer to the LCD structure
+ */
+static inline void lcd_start_initialization(lcd_t *lcd)
+{
+    lcd->pos_secuence = 0;
+    swt_start(&lcd->timer, 0, 0, 0);
+}
 
 /**
  * @brief Enable the LCD. In hardware there is a transistor to control the power of the LCD
@@ -214,6 +266,8 @@ static inline void lcd_enable(lcd_t *lcd)
  */
 static inline void lcd_disable(lcd_t *lcd)
 {
+    swt_cancel(&lcd->timer);
+    dma_channel_abort(lcd->dma_chan);
     lcd->en = false;
     lcd->pos_secuence = 0;
     gpio_put(lcd->en_gpio, 0);
@@ -22,33 +22,44 @@
 #include "hardware/xosc.h"
 
 #include "functs.h"
+#include "dsp_core.h"
+#include "gps.h"
 
 extern system_t gSystem;
-extern flags_t gFlags;
+extern evq_t gEvents;
+extern gps_t gGps;
 
 int main() {
     stdio_init_all();
-    sleep_ms(3000);
     printf("Run Program\n");
 
     // Initialize global variables
     initGlobalVariables();
+    gSystem.boot_us = time_us_32(); // The timer counts from the reset
 
     // PWM configuration
     initPWMasPIT(0, 100, false);     // 100ms for the button debounce
     irq_set_exclusive_handler(PWM_IRQ_WRAP, pwm_handler);
 
     while(1){
-        while(gFlags.W){
-            program();
+        event_t ev;
+        while(evq_pop(&gEvents, &ev)){
+            program(&ev);
         }
         if (gSystem.state == DORMANT){
+            dsp_core_park(); // Core1 must be stopped before the clocks are
+            gps_tx_flush(&gGps); // The backup request of the GPS must leave the UART before the clocks stop
             rosc_set_dormant(); // Set the system to dormant mode
         }
-        else 
-            __wfi(); // Wait for interrupt (Will put the processor into deep sleep until woken by the RTC interrupt)
-        
-        
+        else {
+            program_idle();
+            // An event posted after the queue was found empty still wakes the core: a pending
+            // interruption ends __wfi() even while they are disabled
+            uint32_t irq = save_and_disable_interrupts();
+            if (evq_empty(&gEvents))
+                __wfi(); // Wait for interrupt (Will put the processor into deep sleep until woken by the RTC interrupt)
+            restore_interrupts(irq);
+        }
     }
 }
 
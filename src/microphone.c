@@ -12,20 +12,70 @@
  * 
  */
 
+#include <string.h>
+
 #include "microphone.h"
 
 #include "functs.h"
+#include "fmt.h"
+
+/**
+ * @brief Print a fixed point value without floating point.
+ * 
+ * @param value 
+ * @param frac Decimals of the value: 2 for centi-units, 6 for micro-units.
+ */
+static void mphone_print_fixed(int32_t value, uint8_t frac)
+{
+    char str[FMT_MAX];
+    fmt_fixed(str, value, frac, frac, 0);
+    printf("%s", str);
+}
+
+/**
+ * @brief Print the time of the day of a time stamp (s, see rec_t) as hh:mm:ss.
+ * 
+ */
+static void mphone_print_time(uint32_t time)
+{
+    char str[FMT_MAX];
+    fmt_time(str, time);
+    printf("%s", str);
+}
 
 void mphone_init(mphone_t *mphone, uint8_t gpio_num, uint32_t sample, uint8_t en_gpio)
 {
     ///< Initialize the microphone structure
     mphone->gpio_num = gpio_num;
     mphone->en_gpio = en_gpio;
-    mphone->spl_index = 0;
     mphone->en = false;
     mphone->dma_irq = 0;
     mphone->adc_chan = 26 - gpio_num; ///< channel 0 is GPIO 26, channel 1 is GPIO 27, etc.
-    mphone->sample = sample/7;
+    mphone->sample = sample;
+    mphone->block_us = (uint32_t)((uint64_t)MPHONE_BLOCK_SIZE*1000000/sample);
+    mphone->decim_en = false;
+    mphone->decim_count = 0;
+    decim_reset(&mphone->decim);
+    mphone->block_count = 0;
+    mphone->block_read = 0;
+    mphone->overruns = 0;
+    mphone->late_irqs = 0;
+    mphone->lost_results = 0;
+    mphone->curve = MPHONE_DEFAULT_WEIGHTING;
+    mphone->rec_fields = MPHONE_DEFAULT_REC_FIELDS;
+    weighting_init(&mphone->weighting, mphone->curve, mphone->sample);
+    spl_reset_dc(&mphone->meter);
+    spl_start(&mphone->meter, mphone->sample*MPHONE_MEASURE_TIME_S);
+    tw_init(&mphone->tw, mphone->sample);
+    mphone->live_cdb = 0;
+
+    spsc_init(&mphone->block_queue, mphone->block_queue_buf, sizeof(mphone_block_t), MPHONE_NUM_BLOCKS);
+    spsc_init(&mphone->result_queue, mphone->result_queue_buf, sizeof(mphone_result_t), MPHONE_NUM_RESULTS);
+
+    ///< Claim the DMA channels of the ping-pong buffer
+    for (int i = 0; i < MPHONE_NUM_DMA; i++){
+        mphone->dma_chan[i] = dma_claim_unused_channel(true);
+    }
 
     ///< Initialize the GPIO
     gpio_init(en_gpio);
@@ -34,8 +84,10 @@ void mphone_init(mphone_t *mphone, uint8_t gpio_num, uint32_t sample, uint8_t en
 
     mphone_configure_dma(mphone);
 
-    ///< Print and load the SPL values
-    mphone_load_print_spl_location(mphone);
+    ///< Find the record log and prepare its next sector, the records are decoded when they are asked
+    flog_init(&mphone->log, rec_size);
+    mphone_maintain_store(mphone);
+    mphone_load_summary(mphone);
 }
 
 void mphone_configure_dma(mphone_t *mphone)
@@ -43,7 +95,7 @@ void mphone_configure_dma(mphone_t *mphone)
     ///< Initialize the ADC
     adc_gpio_init(mphone->gpio_num);
     adc_init();
-    adc_set_clkdiv(6.5*MHZ/(mphone->sample)); ///< Set the ADC clock to the sample rate
+    adc_set_clkdiv((float)clock_get_hz(clk_adc)/mphone->sample - 1); ///< A conversion every (1 + div) cycles of clk_adc
     adc_select_input(mphone->adc_chan); ///< Select the ADC channel
     adc_fifo_setup(
         true,   ///< Write each completed conversion to the sample FIFO
@@ -53,81 +105,316 @@ void mphone_configure_dma(mphone_t *mphone)
         false   ///< Do not shift the result to 8 bits
     );
 
-    ///< Initialize the DMA
-    mphone->dma_chan = dma_claim_unused_channel(true);
-    dma_channel_config c = dma_channel_get_default_config(mphone->dma_chan);
-    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
-    channel_config_set_read_increment(&c, false);
-    channel_config_set_write_increment(&c, true);
-    channel_config_set_dreq(&c, DREQ_ADC);
-
-    dma_channel_configure(
-        mphone->dma_chan,   ///< Channel to configure 
-        &c,
-        &mphone->adc_buffer[0], ///< Write address
-        &adc_hw->fifo,      ///< Read address
-        MPHONE_SIZE_BUFFER, ///< Number of transfers
-        false               ///< Don't start immediately
-    );
+    ///< Initialize the DMA, each channel fills its block and triggers the next one
+    for (int i = 0; i < MPHONE_NUM_DMA; i++){
+        dma_channel_config c = dma_channel_get_default_config(mphone->dma_chan[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_dreq(&c, DREQ_ADC);
+        channel_config_set_chain_to(&c, mphone->dma_chan[(i + 1) % MPHONE_NUM_DMA]);
 
-    ///< Tell the DMA to raise IRQ line 0 when the channel finishes a block transfer
-    dma_channel_set_irq0_enabled(mphone->dma_chan, true);
+        dma_channel_configure(
+            mphone->dma_chan[i],   ///< Channel to configure 
+            &c,
+            mphone->adc_buffer[i], ///< Write address
+            &adc_hw->fifo,      ///< Read address
+            MPHONE_BLOCK_SIZE,  ///< Number of transfers
+            false               ///< Don't start immediately
+        );
+
+        ///< Tell the DMA to raise IRQ line 0 when the channel finishes a block transfer
+        dma_channel_set_irq0_enabled(mphone->dma_chan[i], true);
+    }
 
     ///< Enable the interrupt in the NVIC
     irq_set_exclusive_handler(DMA_IRQ_0, dma_handler);
     irq_set_enabled(DMA_IRQ_0, true);
 }
 
-void mphone_calculate_spl(mphone_t *mphone)
+void mphone_dma_trigger(mphone_t *mphone)
+{
+    mphone->block_count = 0;
+    mphone->block_read = 0;
+    mphone->overruns = 0;
+    mphone->late_irqs = 0;
+    mphone->lost_results = 0;
+    spsc_init(&mphone->block_queue, mphone->block_queue_buf, sizeof(mphone_block_t), MPHONE_NUM_BLOCKS);
+    spsc_init(&mphone->result_queue, mphone->result_queue_buf, sizeof(mphone_result_t), MPHONE_NUM_RESULTS);
+    spl_reset_dc(&mphone->meter); ///< The microphone bias is tracked again in each measurement
+    if (!weighting_init(&mphone->weighting, mphone->curve, mphone->sample)){
+        printf("No %c-weighting for %u Hz, using Z\n", weighting_letter(mphone->curve), (unsigned)mphone->sample);
+    }
+    spl_start(&mphone->meter, mphone->sample*MPHONE_MEASURE_TIME_S);
+    spl_start(&mphone->short_meter, mphone->sample/MPHONE_SHORT_INTERVAL_DIV);
+    stats_reset(&mphone->stats);
+    tw_init(&mphone->tw, mphone->sample);
+    mphone->live_cdb = 0;
+    decim_reset(&mphone->decim);
+    mphone->decim_count = 0;
+    mphone->proc_us = 0;
+    mphone->proc_max_us = 0;
+    mphone->proc_sum_us = 0;
+    memset(mphone->load_hist, 0, sizeof(mphone->load_hist));
+    mphone->headroom = 100;
+    for (int i = 0; i < MPHONE_NUM_DMA; i++){
+        dma_channel_set_write_addr(mphone->dma_chan[i], mphone->adc_buffer[i], false);
+        dma_channel_set_trans_count(mphone->dma_chan[i], MPHONE_BLOCK_SIZE, false);
+        dma_channel_set_irq0_enabled(mphone->dma_chan[i], true);
+    }
+    __dmb(); ///< Core1 sees the new measurement before the first block
+    adc_fifo_drain(); ///< Clear the FIFO
+    adc_run(true); ///< Start the ADC to free running mode
+    dma_channel_start(mphone->dma_chan[0]); ///< Start the DMA, the other channel is chained
+}
+
+bool mphone_dma_block_done(mphone_t *mphone)
+{
+    bool done = false;
+    ///< Blocks complete in order: the block k was filled by the channel k%MPHONE_NUM_DMA
+    for (int i = 0; i < MPHONE_NUM_DMA; i++){
+        uint32_t k = mphone->block_count;
+        uint8_t chan = mphone->dma_chan[k % MPHONE_NUM_DMA];
+        if (!dma_irqn_get_channel_status(mphone->dma_irq, chan)) break;
+        dma_irqn_acknowledge_channel(mphone->dma_irq, chan); ///< Acknowledge the DMA IRQ
+        mphone->block_count = k + 1;
+        done = true;
+
+        ///< The rearm is only safe if the IRQ comes less than a block late: the other channel chains to
+        ///< this one when its block ends, and a channel restarted before the rearm writes past its block
+        ///< (into the spare block when it was the last one of the ring)
+        if (dma_channel_hw_addr(chan)->transfer_count){
+            mphone->late_irqs++;
+            mphone_dma_stop(mphone);
+            break;
+        }
+        ///< The write address is not reloaded, the transfer count is
+        dma_channel_set_write_addr(chan, mphone->adc_buffer[(k + MPHONE_NUM_DMA) % MPHONE_NUM_BLOCKS], false);
+
+        ///< The rearmed channel writes the block of k - MPHONE_MAX_PENDING after the next one: if core1 has not
+        ///< processed it, the Leq would get a gap or a torn block. The measurement is stopped and flagged instead
+        mphone_block_t block = {mphone->adc_buffer[k % MPHONE_NUM_BLOCKS], k, time_us_32()};
+        if (k - mphone->block_read >= MPHONE_MAX_PENDING || !spsc_push(&mphone->block_queue, &block)){
+            mphone->overruns++;
+            mphone_dma_stop(mphone);
+            break;
+        }
+    }
+    if (done) __sev(); ///< Wake up core1
+    return done;
+}
+
+/**
+ * @brief Accumulate the samples in the short intervals, and add the level of each completed interval to the histogram.
+ * 
+ * @param mphone 
+ * @param x Weighted samples.
+ * @param n Number of samples.
+ */
+static void mphone_add_short_intervals(mphone_t *mphone, const int32_t *x, uint32_t n)
+{
+    spl_meter_t *short_meter = &mphone->short_meter;
+    while (n){
+        uint32_t len = short_meter->window - short_meter->count;
+        if (len > n) len = n;
+        if (spl_add_block(short_meter, x, len)){
+            stats_add(&mphone->stats, spl_leq_cdb(short_meter->mean_sq, MPHONE_CAL_CDB));
+            spl_start(short_meter, short_meter->window);
+        }
+        x += len;
+        n -= len;
+    }
+}
+
+void mphone_process_block(mphone_t *mphone, const mphone_block_t *block)
 {
-    uint32_t sum = 0;
-    for (int i = 0; i < MPHONE_SIZE_BUFFER; i++){
-        sum += mphone->adc_buffer[i];
+    uint32_t start = time_us_32();
+    spl_remove_dc(&mphone->meter, block->samples, mphone->work, MPHONE_BLOCK_SIZE);
+    if (mphone->decim_en){ ///< Decimate before the weighting, consumers get the flat signal
+        mphone->decim_count = decim_process(&mphone->decim, mphone->work, MPHONE_BLOCK_SIZE, mphone->decim_block);
+    }
+    weighting_process(&mphone->weighting, mphone->work, MPHONE_BLOCK_SIZE);
+    if (!mphone->meter.ready){
+        mphone_add_short_intervals(mphone, mphone->work, MPHONE_BLOCK_SIZE);
+        tw_process(&mphone->tw, mphone->work, MPHONE_BLOCK_SIZE);
+        mphone->live_cdb = spl_leq_cdb(tw_energy(&mphone->tw, TW_FAST), MPHONE_CAL_CDB);
     }
-    ///< 3.3V is the reference voltage, 4096 is the ADC resolution
-    double avg = (sum/MPHONE_SIZE_BUFFER)*(3.3/4096)*(0.046023); ///< 0.046 is the gain of the microphone
-    mphone->spl[mphone->spl_index] = 20*log10(avg/REF_PRESSURE);
-    mphone->lat[mphone->spl_index] = mphone->lat_v;
-    mphone->lon[mphone->spl_index] = mphone->lon_v;
-    mphone->spl_index++;
-    if (mphone->spl_index == MPHONE_SIZE_SPL) {
-        mphone->spl_index = 0;
+    if (spl_add_block(&mphone->meter, mphone->work, MPHONE_BLOCK_SIZE)){ ///< Accumulate the energy of the block
+        mphone_result_t result = {MPHONE_RESULT_LEQ, block->seq, mphone->meter.mean_sq};
+        uint64_t peak = mphone->meter.peak;
+        stats_get_levels(&mphone->stats, spl_leq_cdb(peak*peak, MPHONE_CAL_CDB), &result.levels);
+        for (int i = 0; i < TW_NUM; i++){
+            result.tw_max[i] = spl_leq_cdb(tw_max_energy(&mphone->tw, i), MPHONE_CAL_CDB);
+        }
+        if (!spsc_push(&mphone->result_queue, &result)) mphone->lost_results++; ///< Core0 discards the measurement
     }
+    mphone->block_read = block->seq + 1;
+
+    ///< Throughput of the block
+    mphone->proc_us = time_us_32() - start;
+    if (mphone->proc_us > mphone->proc_max_us) mphone->proc_max_us = mphone->proc_us;
+    mphone->proc_sum_us += mphone->proc_us;
+    uint32_t bin = 10*mphone->proc_us/mphone->block_us;
+    mphone->load_hist[bin < MPHONE_LOAD_BINS ? bin : MPHONE_LOAD_BINS - 1]++;
+    mphone->headroom = (mphone->proc_us >= mphone->block_us) ? 0 : 100 - 100*mphone->proc_us/mphone->block_us;
 }
 
-void mphone_store_spl_location(mphone_t *mphone)
+void mphone_calculate_spl(mphone_t *mphone, const mphone_result_t *result)
 {
-    // An array of 256 bytes, multiple of FLASH_PAGE_SIZE. Database is 60 bytes.
-    uint32_t buf[3*FLASH_PAGE_SIZE/sizeof(uint32_t)]; ///< The spl array sizes 200 bytes.
+    rec_t *record = &mphone->record;
+    record->flags = mphone->rec_fields; ///< The other fields are kept in RAM for the console
+    record->leq = (int16_t)spl_leq_cdb(result->mean_sq, MPHONE_CAL_CDB);
+    record->lat = mphone->lat_v;
+    record->lon = mphone->lon_v;
+    record->time = mphone->time_v;
+    record->ttff_ms = mphone->ttff_v;
+    record->gps_start = mphone->gps_start_v;
+    record->duration = MPHONE_MEASURE_TIME_S;
+    record->levels = result->levels;
+    for (int i = 0; i < REC_NUM_TW; i++){
+        record->tw_max[i] = (int16_t)result->tw_max[i];
+    }
+}
 
-    // Copy the database into the buffer
-    for (int i = 0; i < 3*MPHONE_SIZE_SPL; i += 3){
-        buf[i + 0] = (int32_t)(mphone->spl[i/3]*1000000);
-        buf[i + 1] = (int32_t)(mphone->lat[i/3]*1000000);
-        buf[i + 2] = (int32_t)(mphone->lon[i/3]*1000000);
+void mphone_print_time_weighting(mphone_t *mphone, const mphone_result_t *result)
+{
+    const char detector[TW_NUM] = {'F', 'S', 'I'};
+    for (int i = 0; i < TW_NUM; i++){
+        printf("L%c%cmax ", weighting_letter(mphone->weighting.curve), detector[i]);
+        mphone_print_fixed(result->tw_max[i], 2);
+        printf(i < TW_NUM - 1 ? "dB, " : "dB\n");
     }
-    // Program buf[] into the first page of this sector
-    // Each page is 256 bytes, and each sector is 4K bytes
-    // Erase the last sector of the flash
-    flash_safe_execute(mphone_wrapper, NULL, 500);
+}
 
-    uint32_t ints = save_and_disable_interrupts();
-    flash_range_program(FLASH_TARGET_OFFSET, (uint8_t *)buf, 3*FLASH_PAGE_SIZE);
-    restore_interrupts (ints);
+void mphone_print_throughput(mphone_t *mphone)
+{
+    uint32_t headroom = (mphone->proc_max_us >= mphone->block_us) ? 0 : 100 - 100*mphone->proc_max_us/mphone->block_us;
+    uint32_t processed = 0;
+    for (int i = 0; i < MPHONE_LOAD_BINS; i++) processed += mphone->load_hist[i];
+    uint32_t mean_us = processed ? (uint32_t)(mphone->proc_sum_us/processed) : 0;
+    printf("Blocks: %lu (%lu overruns, %lu late interrupts, %lu lost results), %lu samples/s, max %lu us, mean %lu us of %lu us per block, headroom %lu%%\n",
+            (unsigned long)mphone->block_count, (unsigned long)mphone->overruns, (unsigned long)mphone->late_irqs,
+            (unsigned long)mphone->lost_results, (unsigned long)mphone->sample, (unsigned long)mphone->proc_max_us, (unsigned long)mean_us, (unsigned long)mphone->block_us, (unsigned long)headroom);
+    printf("Load:");
+    for (int i = 0; i < MPHONE_LOAD_BINS; i++){ ///< Only the bins with blocks, "<10%: 790" is 790 blocks below 10%
+        if (!mphone->load_hist[i]) continue;
+        if (i < MPHONE_LOAD_BINS - 1) printf(" <%d%%: %lu", 10*(i + 1), (unsigned long)mphone->load_hist[i]);
+        else printf(" >=100%%: %lu", (unsigned long)mphone->load_hist[i]);
+    }
+    printf("\n");
 }
 
-void mphone_load_print_spl_location(mphone_t *mphone)
+bool mphone_store_spl_location(mphone_t *mphone)
 {
-    // Compute the memory-mapped address, remembering to include the offset for RAM
-    uint32_t addr = XIP_BASE +  FLASH_TARGET_OFFSET;
-    uint32_t *ptr = (uint32_t *)addr; ///< Place an int pointer at our memory-mapped address
+    ///< The first record of a page is absolute, so the log can be read from any page
+    uint8_t buf[REC_MAX_SIZE];
+    size_t len = rec_encode(&mphone->record, mphone->last_valid ? &mphone->last : NULL, buf);
+    if (mphone->last_valid && flog_starts_page(&mphone->log, len)){
+        len = rec_encode(&mphone->record, NULL, buf);
+    }
 
-    // Load the inventory from the flash memory
-    printf("SPL, Latitude, Longitude\n");
-    for (int i = 0, j = 0, w = 0; i < 3*MPHONE_SIZE_SPL; i += 3){///< Casting? (uint32_t)
-        mphone->spl[i/3] = (double_t)((int32_t)ptr[i + 0])/1000000; printf("%fdB, ", mphone->spl[i/3]);
-        mphone->lat[i/3] = (double_t)((int32_t)ptr[i + 1])/1000000; printf("%f, ", mphone->lat[i/3]);
-        mphone->lon[i/3] = (double_t)((int32_t)ptr[i + 2])/1000000; printf("%f\n", mphone->lon[i/3]);
+    ///< Only the page of the new record is programmed, the sectors are erased by mphone_maintain_store()
+    if (!flog_append(&mphone->log, buf, len)){
+        printf("The record could not be stored\n");
+        return false;
+    }
+    mphone->last = mphone->record;
+    mphone->last_valid = true;
+    if (mphone->range_valid){
+        if (mphone->record.leq < mphone->leq_min) mphone->leq_min = mphone->record.leq;
+        if (mphone->record.leq > mphone->leq_max) mphone->leq_max = mphone->record.leq;
+    }
+    return true;
+}
+
+/**
+ * @brief Decode the next record of a reader of the log.
+ * 
+ * @param it 
+ * @param prev Previous record, the reference of the deltas.
+ * @param valid The previous record is valid, updated with the result of the decoding.
+ * @param rec Decoded record.
+ * @return false at the end of the log.
+ */
+static bool mphone_next_record(flog_iter_t *it, rec_t *prev, bool *valid, rec_t *rec)
+{
+    const uint8_t *data;
+    uint16_t len;
+    bool page_start;
+    if (!(data = flog_next(it, &len, &page_start))) return false;
+    *valid = rec_decode(data, len, *valid ? prev : NULL, rec);
+    if (*valid) *prev = *rec; ///< If damaged, the records until the next absolute one are lost
+    return true;
+}
+
+void mphone_load_summary(mphone_t *mphone)
+{
+    flog_iter_t it;
+    rec_t rec;
+    mphone->last_valid = false;
+    mphone->range_valid = false;
+    flog_last_page(&mphone->log, &it); ///< The first record of the page is absolute
+    while (mphone_next_record(&it, &mphone->last, &mphone->last_valid, &rec));
+}
+
+void mphone_print_summary(mphone_t *mphone)
+{
+    printf("Records: %lu", (unsigned long)mphone->log.count);
+    if (mphone->log.count && mphone->last_valid){
+        printf(", newest ");
+        mphone_print_time(mphone->last.time);
+        printf(" ");
+        mphone_print_fixed(mphone->last.leq, 2); printf("dB");
+    }
+    printf("\n");
+}
+
+bool mphone_leq_range(mphone_t *mphone, int16_t *min, int16_t *max)
+{
+    if (!mphone->log.count) return false;
+    if (!mphone->range_valid){
+        flog_iter_t it;
+        rec_t prev, rec;
+        bool valid = false;
+        mphone->leq_min = INT16_MAX;
+        mphone->leq_max = INT16_MIN;
+        flog_first(&mphone->log, &it);
+        while (mphone_next_record(&it, &prev, &valid, &rec)){
+            if (!valid) continue;
+            if (rec.leq < mphone->leq_min) mphone->leq_min = rec.leq;
+            if (rec.leq > mphone->leq_max) mphone->leq_max = rec.leq;
+        }
+        mphone->range_valid = true;
+    }
+    *min = mphone->leq_min;
+    *max = mphone->leq_max;
+    return true;
+}
+
+void mphone_print_records(mphone_t *mphone)
+{
+    printf("Time, SPL, Latitude, Longitude, L5, L10, L50, L90, L95, Lmax, Lmin, Lpeak, LFmax, LSmax, LImax\n");
+    flog_iter_t it;
+    rec_t prev, rec;
+    bool valid = false;
+    flog_first(&mphone->log, &it);
+    while (mphone_next_record(&it, &prev, &valid, &rec)){
+        if (!valid) continue;
+        const rec_t *record = &rec;
+        mphone_print_time(record->time);
+        printf(", ");
+        mphone_print_fixed(record->leq, 2); printf("dB, ");
+        mphone_print_fixed(record->lat, 6); printf(", ");
+        mphone_print_fixed(record->lon, 6);
+        const int16_t levels[] = {record->levels.l5, record->levels.l10, record->levels.l50, record->levels.l90,
+                                  record->levels.l95, record->levels.lmax, record->levels.lmin, record->levels.lpeak,
+                                  record->tw_max[0], record->tw_max[1], record->tw_max[2]};
+        for (int j = 0; j < 11; j++){ ///< Empty columns for the fields the record does not have
+            printf(", ");
+            if (record->flags & ((j < 8) ? REC_F_STATS : REC_F_TW)) mphone_print_fixed(levels[j], 2);
+        }
+        printf("\n");
     }
+    if (it.damaged) printf("%u damaged pages, their records are lost\n", (unsigned)it.damaged);
     printf("\n");
 }
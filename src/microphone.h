@@ -23,11 +23,58 @@
 #include "hardware/sync.h"
 #include "pico/flash.h"
 
-#define MPHONE_SIZE_BUFFER 25600 ///< Size of the ADC buffer.
-#define MPHONE_SIZE_SPL 50 ///< Size of the Sound Pressure Level array.
+#include "spl.h"
+#include "weighting.h"
+#include "decimator.h"
+#include "spsc_queue.h"
+#include "stats.h"
+#include "time_weighting.h"
+#include "flash_log.h"
+#include "record.h"
+
+#define MPHONE_BLOCK_SIZE 600 ///< Number of samples of each DMA block.
+#define MPHONE_NUM_BLOCKS 4 ///< Number of DMA blocks, power of 2 (size of the block queue).
+#define MPHONE_NUM_DMA 2 ///< Number of chained DMA channels (ping-pong).
+#define MPHONE_MAX_PENDING (MPHONE_NUM_BLOCKS - MPHONE_NUM_DMA) ///< Blocks waiting for core1 before they are overwritten.
+#define MPHONE_NUM_RESULTS 4 ///< Size of the result queue, power of 2.
+#define MPHONE_SPARE_BLOCKS 1 ///< After the ring: writes of a channel not rearmed in time, the IRQ was late.
+#define MPHONE_SIZE_BUFFER (MPHONE_NUM_BLOCKS*MPHONE_BLOCK_SIZE) ///< Size of the ADC buffer.
+#define MPHONE_LOAD_BINS 11 ///< Bins of 10% of the block period for the processing load, the last one is 100% or more.
+#define MPHONE_MEASURE_TIME_S 10 ///< Duration of one measurement in seconds.
+#define MPHONE_SHORT_INTERVAL_DIV 8 ///< Short intervals per second (125 ms) for the statistical levels.
+#define MPHONE_SIZE_DECIM (MPHONE_BLOCK_SIZE/DECIM_FACTOR + 1) ///< Size of the decimated block.
 #define MPHONE_SAMPLES_PER_PLACE 10 ///< Number of samples to calculate the SPL in one place.
-#define FLASH_TARGET_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE) ///< Flash-based address of the last sector
 #define REF_PRESSURE 0.000020
+#define MPHONE_VREF 3.3 ///< Reference voltage of the ADC
+#define MPHONE_ADC_RANGE 4096 ///< Resolution of the ADC
+#define MPHONE_GAIN 0.046023 ///< Gain of the microphone
+#define MPHONE_CAL_CDB 536 ///< Level of an RMS of 1 ADC code: 100*20*log10((MPHONE_VREF/MPHONE_ADC_RANGE)*MPHONE_GAIN/REF_PRESSURE)
+#define MPHONE_DEFAULT_WEIGHTING WEIGHTING_A ///< Frequency weighting of the measurements
+#define MPHONE_DEFAULT_REC_FIELDS 0 ///< Optional fields of the records (REC_F_STATS, REC_F_TW, REC_F_GPS): about 9 bytes without, 23 with all
+
+/**
+ * @brief Descriptor of a block filled by the DMA, pushed by core0 in the block queue.
+ * 
+ */
+typedef struct{
+    uint16_t *samples; ///< Samples of the block
+    uint32_t seq;      ///< Number of the block since the trigger
+    uint32_t time;     ///< Time stamp of the end of the block, in us
+}mphone_block_t;
+
+/**
+ * @brief Result posted by core1 in the result queue.
+ * 
+ */
+typedef struct{
+    enum{
+        MPHONE_RESULT_LEQ   ///< The integration window of the measurement is complete
+    } type;
+    uint32_t seq;       ///< Last block of the result
+    uint64_t mean_sq;   ///< Mean square of the window, in Q(2*SPL_AC_Q) codes^2
+    stats_levels_t levels; ///< Statistical levels of the window, in centi-dB
+    int32_t tw_max[TW_NUM]; ///< Maximum Fast, Slow and Impulse levels of the window, in centi-dB
+}mphone_result_t;
 
 /**
  * @typedef mphone_t 
@@ -37,21 +84,54 @@
  */
 typedef struct _mphone_t{
     uint8_t adc_chan;
-    uint8_t dma_chan;
+    uint8_t dma_chan[MPHONE_NUM_DMA]; ///< Chained DMA channels, block k is filled by the channel k%MPHONE_NUM_DMA.
     uint8_t dma_irq;
     uint8_t adc_irq;
-    uint32_t sample;
+    uint32_t sample; ///< Sample rate in Hz.
     uint8_t gpio_num; ///< GPIO number of the microphone input.
     uint8_t en_gpio; ///< GPIO to enable the microphone.
-    uint16_t adc_buffer[MPHONE_SIZE_BUFFER];
-    double lat[MPHONE_SIZE_SPL]; ///< SPL array to store the Latitude values of each SPL value.
-    double lon[MPHONE_SIZE_SPL]; ///< SPL array to store the Longitude values of each SPL value.
-    double spl[MPHONE_SIZE_SPL];
-    double lat_v;
-    double lon_v;
-    uint8_t spl_index; ///< Index of the SPL array. It is going to count up to MPHONE_SIZE_SPL.
-    uint32_t dma_time; ///< Time which takes the DMA to transfer the data.
-    bool dma_done; ///< Flag to indicate that the DMA has finished the transfer.
+    uint16_t adc_buffer[MPHONE_NUM_BLOCKS + MPHONE_SPARE_BLOCKS][MPHONE_BLOCK_SIZE]; ///< Blocks filled in turn by the DMA.
+    volatile uint32_t block_count; ///< Number of blocks filled by the DMA since the trigger (core0).
+    volatile uint32_t block_read; ///< Number of blocks already processed (core1).
+    volatile uint32_t overruns; ///< Blocks core1 did not process in time: the acquisition was stopped.
+    volatile uint32_t late_irqs; ///< DMA interrupts served more than a block late: the acquisition was stopped.
+    volatile uint32_t lost_results; ///< Results core1 could not post, the result queue was full (core1).
+    spsc_queue_t block_queue; ///< Blocks from the DMA handler (core0) to the processing (core1).
+    mphone_block_t block_queue_buf[MPHONE_NUM_BLOCKS];
+    spsc_queue_t result_queue; ///< Results from the processing (core1) to program() (core0).
+    mphone_result_t result_queue_buf[MPHONE_NUM_RESULTS];
+    int32_t work[MPHONE_BLOCK_SIZE]; ///< Samples of the block being processed, without DC and weighted.
+    weighting_t weighting; ///< Frequency weighting filter of the current measurement.
+    weighting_curve_t curve; ///< Frequency weighting selected for the next measurement.
+    uint8_t rec_fields; ///< Optional fields stored in the records, REC_F_STATS, REC_F_TW and REC_F_GPS.
+    spl_meter_t meter; ///< Energy accumulator of the current measurement.
+    spl_meter_t short_meter; ///< Energy accumulator of the current short interval.
+    stats_t stats; ///< Histogram of the short interval levels of the current measurement.
+    tw_t tw; ///< Fast, Slow and Impulse detectors of the current measurement.
+    volatile int32_t live_cdb; ///< Fast level of the last block (centi-dB), written by core1 for the LCD.
+    decim_t decim; ///< Decimator of the signal without weighting.
+    bool decim_en; ///< The decimated block is computed for the consumers at a lower rate.
+    int32_t decim_block[MPHONE_SIZE_DECIM]; ///< Decimated samples of the last block.
+    uint32_t decim_count; ///< Number of samples in decim_block.
+    uint32_t block_us; ///< Duration of a block at the sample rate, in us.
+    uint32_t proc_us; ///< Time spent processing the last block, in us.
+    uint32_t proc_max_us; ///< Maximum time spent processing a block in the current measurement, in us.
+    uint64_t proc_sum_us; ///< Time spent processing the blocks of the current measurement, in us.
+    uint32_t load_hist[MPHONE_LOAD_BINS]; ///< Blocks of the current measurement per load (processing time / block_us).
+    uint8_t headroom; ///< CPU headroom of the last block, percentage of block_us not used to process it.
+    rec_t record; ///< Level, location and statistics of the last measurement.
+    rec_t last; ///< Last record of the log, reference of the deltas of the next one.
+    bool last_valid; ///< The last record of the log could be decoded.
+    bool range_valid; ///< leq_min and leq_max cover the records of the log, computed when they are asked.
+    int16_t leq_min; ///< Minimum Leq of the log, in centi-dB.
+    int16_t leq_max; ///< Maximum Leq of the log, in centi-dB.
+    flog_t log; ///< Log of the records in the flash.
+    int32_t lat_v; ///< Latitude (microdegrees) of the current measurement.
+    int32_t lon_v; ///< Longitude (microdegrees) of the current measurement.
+    uint32_t time_v; ///< UTC time stamp (s, see rec_t) of the current measurement.
+    uint32_t ttff_v; ///< Time to the first fix (ms) of the GPS session of the current measurement.
+    uint8_t gps_start_v; ///< Start of the GPS session of the current measurement, 0: cold, 1: hot.
+    uint32_t dma_time; ///< Time stamp of the last block transferred by the DMA.
     bool en;
 }mphone_t;
 
@@ -60,63 +140,214 @@ typedef struct _mphone_t{
  * 
  * @param mphone 
  * @param gpio_num must be between 26 and 29.
- * @param sample sample rate in Hz for the ADC.
+ * @param sample sample rate in Hz for the ADC, up to 500 kHz. The weighting filters need 48000 Hz or 44100 Hz.
  */
 void mphone_init(mphone_t *mphone, uint8_t gpio_num, uint32_t sample, uint8_t en_gpio);
 
 /**
  * @brief Configure the DMA to transfer the data from the ADC to the buffer.
+ * The DMA channels are chained in ping-pong: while one channel fills its block, 
+ * the other block is available for processing. The acquisition runs until mphone_dma_stop().
  * 
  * @param mphone 
  */
 void mphone_configure_dma(mphone_t *mphone);
 
 /**
- * @brief Trigger the DMA to start the data transfer.
+ * @brief Trigger the DMA to start the continuous data transfer, and reset the measurement.
+ * Core1 must be paused (dsp_core_pause()): the queues and the state of the processing are reset here.
+ * 
+ * @param mphone 
+ */
+void mphone_dma_trigger(mphone_t *mphone);
+
+/**
+ * @brief The acquisition of the measurement was stopped by an overrun or a late interrupt, its Leq would have a gap,
+ * or its result was lost.
+ * 
+ * @param mphone 
+ * @return true if the measurement must be discarded.
+ */
+static inline bool mphone_failed(mphone_t *mphone)
+{
+    return mphone->overruns || mphone->late_irqs || mphone->lost_results;
+}
+
+/**
+ * @brief Select the frequency weighting of the next measurement.
+ * 
+ * @param mphone 
+ * @param curve WEIGHTING_A, WEIGHTING_C or WEIGHTING_Z.
+ */
+static inline void mphone_set_weighting(mphone_t *mphone, weighting_curve_t curve)
+{
+    mphone->curve = curve;
+}
+
+/**
+ * @brief Select the optional fields stored in the next records. The statistical and maximum levels
+ * and the TTFF are always printed with the measurement, this only decides if the log keeps them.
+ * 
+ * @param mphone 
+ * @param fields REC_F_STATS, REC_F_TW and REC_F_GPS, 0 for the Leq, the position and the time alone.
+ */
+static inline void mphone_set_record_fields(mphone_t *mphone, uint8_t fields)
+{
+    mphone->rec_fields = fields & (REC_F_STATS | REC_F_TW | REC_F_GPS);
+}
+
+/**
+ * @brief Enable or disable the decimated output (sample/DECIM_FACTOR) of each processed block.
+ * Disabled by default, it costs core1 time on every block.
+ * 
+ * @param mphone 
+ * @param enable 
+ */
+static inline void mphone_set_decimation(mphone_t *mphone, bool enable)
+{
+    mphone->decim_en = enable;
+}
+
+/**
+ * @brief Stop the continuous data transfer.
+ * 
+ * @param mphone 
+ */
+static inline void mphone_dma_stop(mphone_t *mphone)
+{
+    adc_run(false);
+    for (int i = 0; i < MPHONE_NUM_DMA; i++){
+        dma_channel_set_irq0_enabled(mphone->dma_chan[i], false); ///< Abort can raise a spurious IRQ
+        dma_channel_abort(mphone->dma_chan[i]);
+        dma_irqn_acknowledge_channel(mphone->dma_irq, mphone->dma_chan[i]);
+    }
+    adc_fifo_drain();
+}
+
+/**
+ * @brief Acknowledge the DMA IRQ and push the blocks which have been filled in the block queue (core0).
+ * The channel is rearmed to the block after the one being filled by the other channel.
+ * 
+ * @param mphone 
+ * @return true if a block was completed.
+ */
+bool mphone_dma_block_done(mphone_t *mphone);
+
+/**
+ * @brief Pop the next block to process from the block queue (core1).
  * 
  * @param mphone 
+ * @param block 
+ * @return false if there are no blocks.
  */
-static inline void mphone_dma_trigger(mphone_t *mphone)
+static inline bool mphone_pop_block(mphone_t *mphone, mphone_block_t *block)
 {
-    adc_fifo_drain(); ///< Clear the FIFO
-    adc_run(true); ///< Start the ADC to free running mode
-    dma_channel_set_read_addr(mphone->dma_chan, &adc_hw->fifo, true); ///< Start the DMA
+    return spsc_pop(&mphone->block_queue, block);
+}
+
+/**
+ * @brief Process a block (core1): remove the DC, decimate (if enabled), apply the frequency weighting, accumulate the energy
+ * and update the histogram of the short interval levels. The processing time, the CPU headroom and the load histogram are updated,
+ * and a result is posted when the measurement has all its samples.
+ * 
+ * @param mphone 
+ * @param block 
+ */
+void mphone_process_block(mphone_t *mphone, const mphone_block_t *block);
+
+/**
+ * @brief Pop a result of the processing (core0).
+ * 
+ * @param mphone 
+ * @param result 
+ * @return false if there are no results.
+ */
+static inline bool mphone_pop_result(mphone_t *mphone, mphone_result_t *result)
+{
+    return spsc_pop(&mphone->result_queue, result);
 }
 
 /**
  * @brief Calculate the Sound Pressure Level.
- * From the ADC buffer, calculate one sigle point of SPL, and store it in the SPL array.
+ * From the energy of the MPHONE_RESULT_LEQ result, calculate one sigle point of SPL, and store it in the SPL array
+ * with its location and statistical levels.
  * As said in the ISO 1683-1:1998, the SPL is calculated as: Lp = 20 * log10(Pa/Pref) dB, 
- * where Pa is the ponderated pressure, and Pref is the reference pressure, 20uPa.
+ * where Pa is the RMS pressure without the DC bias, and Pref is the reference pressure, 20uPa.
+ * 
+ * @param mphone 
+ * @param result Result of the measurement.
+ */
+void mphone_calculate_spl(mphone_t *mphone, const mphone_result_t *result);
+
+/**
+ * @brief Print the maximum Fast, Slow and Impulse levels of a result.
+ * 
+ * @param mphone 
+ * @param result 
+ */
+void mphone_print_time_weighting(mphone_t *mphone, const mphone_result_t *result);
+
+/**
+ * @brief Print the throughput of the blocks of the last measurement: the worst and the mean processing time,
+ * and the distribution of the load of the blocks in bins of 10% of the block period.
+ * 
+ * @param mphone 
+ */
+void mphone_print_throughput(mphone_t *mphone);
+
+/**
+ * @brief Append the record of the last measurement to the log in the flash. Only its page is programmed.
  * 
  * @param mphone 
- * @param lat Latitude of the place where the SPL was measured.
- * @param lon Longitude of the place where the SPL was measured.
+ * @return false if the log has no prepared page, see mphone_maintain_store().
  */
-void mphone_calculate_spl(mphone_t *mphone);
+bool mphone_store_spl_location(mphone_t *mphone);
 
 /**
- * @brief Store the SPL array in non-volatile memory.
+ * @brief Load the summary of the log: only the page of the newest record is decoded.
  * 
  * @param mphone 
  */
-void mphone_store_spl_location(mphone_t *mphone);
+void mphone_load_summary(mphone_t *mphone);
 
 /**
- * @brief Load and print all the information (SPL, Latitude, Longitud) from non-volatile memory.
+ * @brief Print the number of records of the log and the newest one.
  * 
  * @param mphone 
  */
-void mphone_load_print_spl_location(mphone_t *mphone);
+void mphone_print_summary(mphone_t *mphone);
 
 /**
- * @brief Definition of the wrapper function for the flash_safe_execute function,
- * which is used to erase the last sector of the flash memory.
+ * @brief Minimum and maximum Leq of the log. The whole log is decoded the first time, then they are
+ * updated with each new record.
  * 
+ * @param mphone 
+ * @param min Centi-dB.
+ * @param max Centi-dB.
+ * @return false if the log has no records.
+ */
+bool mphone_leq_range(mphone_t *mphone, int16_t *min, int16_t *max);
+
+/**
+ * @brief Decode and print all the records (SPL, Latitude, Longitud, statistical levels) of the log in the flash.
+ * 
+ * @param mphone 
+ */
+void mphone_print_records(mphone_t *mphone);
+
+/**
+ * @brief Erase the flash sector the next records need, reclaiming the oldest records when the log is full.
+ * Call it when there is no measurement in progress.
+ * 
+ * @param mphone 
  */
-static inline void mphone_wrapper()
+static inline void mphone_maintain_store(mphone_t *mphone)
 {
-    flash_range_erase((PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE), FLASH_SECTOR_SIZE);
+    uint32_t count = mphone->log.count;
+    if (!flog_maintain(&mphone->log)){
+        printf("The record log could not be erased\n");
+    }
+    if (mphone->log.count != count) mphone->range_valid = false; ///< Records were reclaimed
 }
 /**
  * @brief Enable the microphone. In this case, the microphone is enabled by setting the EN pin to 0.
@@ -138,6 +369,7 @@ static inline void mphone_enable(mphone_t *mphone)
  */
 static inline void mphone_disable(mphone_t *mphone)
 {
+    mphone_dma_stop(mphone);
     gpio_put(mphone->en_gpio, 0);
     mphone->en = false;
 }
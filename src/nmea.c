@@ -0,0 +1,341 @@
+/**
+ * \file        nmea.c
+ * \brief       Incremental NMEA 0183 parser, fed one byte at a time from the UART path.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+#include "nmea.h"
+
+static const uint32_t nmea_pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+/**
+ * @brief Value of the current field scaled by 10^scale, truncated.
+ *
+ */
+static int32_t nmea_scaled(const nmea_parser_t *nmea, uint8_t scale)
+{
+    uint64_t v = (nmea->frac <= scale) ? nmea->num*nmea_pow10[scale - nmea->frac] : nmea->num/nmea_pow10[nmea->frac - scale];
+    return nmea->neg ? -(int32_t)v : (int32_t)v;
+}
+
+/**
+ * @brief Coordinate of the current field ((d)ddmm.mmmm) in microdegrees, rounded.
+ *
+ */
+static int32_t nmea_coordinate(const nmea_parser_t *nmea)
+{
+    uint64_t unit = 100*(uint64_t)nmea_pow10[nmea->frac];    ///< One degree in the digits of the field
+    uint64_t deg = nmea->num/unit;
+    uint64_t min = nmea->num % unit;                        ///< Minutes with frac decimals
+    uint64_t div = 60*(uint64_t)nmea_pow10[nmea->frac];
+    return (int32_t)(deg*1000000 + (min*1000000 + div/2)/div);
+}
+
+/**
+ * @brief Time of the current field (hhmmss.sss) in ms of the day.
+ *
+ */
+static uint32_t nmea_time_ms(const nmea_parser_t *nmea)
+{
+    uint32_t v = (uint32_t)nmea_scaled(nmea, 3);             ///< hhmmss with ms
+    return (v/10000000)*3600000 + (v/100000 % 100)*60000 + v % 100000;
+}
+
+/**
+ * @brief Time field of GGA and RMC: a new time starts a new epoch.
+ *
+ */
+static void nmea_epoch(nmea_parser_t *nmea)
+{
+    if (nmea->empty) return;
+    uint32_t time_ms = nmea_time_ms(nmea);
+    if (time_ms != nmea->work.time_ms){
+        nmea->work.time_ms = time_ms;
+        nmea->work.epoch_mask = 0;
+    }
+}
+
+/**
+ * @brief Position fields, in the same order in GGA and RMC.
+ *
+ * @param nmea
+ * @param f 0: latitude, 1: N/S, 2: longitude, 3: E/W
+ */
+static void nmea_position(nmea_parser_t *nmea, uint8_t f)
+{
+    nmea_fix_t *w = &nmea->work;
+    switch (f){
+    case 0:
+        w->lat = nmea->empty ? 0 : nmea_coordinate(nmea);
+        break;
+    case 1:
+        w->lat_area = (nmea->chr == 'N' || nmea->chr == 'S') ? nmea->chr : 0;
+        if (nmea->chr == 'S') w->lat = -w->lat;
+        break;
+    case 2:
+        w->lon = nmea->empty ? 0 : nmea_coordinate(nmea);
+        break;
+    case 3:
+        w->lon_area = (nmea->chr == 'E' || nmea->chr == 'W') ? nmea->chr : 0;
+        if (nmea->chr == 'W') w->lon = -w->lon;
+        break;
+    }
+}
+
+///< $--GGA,hhmmss.ss,llll.ll,a,yyyyy.yy,a,x,xx,x.x,x.x,M,x.x,M,x.x,xxxx
+static void nmea_gga(nmea_parser_t *nmea, uint8_t f)
+{
+    nmea_fix_t *w = &nmea->work;
+    switch (f){
+    case 1:
+        nmea_epoch(nmea);
+        break;
+    case 2: case 3: case 4: case 5:
+        nmea_position(nmea, f - 2);
+        break;
+    case 6:
+        w->fix_quality = (uint8_t)nmea->num;
+        break;
+    case 7:
+        w->num_satellites = (uint8_t)nmea->num;
+        break;
+    case 8:
+        w->hdop = nmea->empty ? 0 : (uint16_t)nmea_scaled(nmea, 2);
+        break;
+    case 9:
+        w->alt_dm = nmea_scaled(nmea, 1);
+        break;
+    }
+}
+
+///< $--RMC,hhmmss.ss,A,llll.ll,a,yyyyy.yy,a,x.x,x.x,ddmmyy,x.x,a,m
+static void nmea_rmc(nmea_parser_t *nmea, uint8_t f)
+{
+    nmea_fix_t *w = &nmea->work;
+    switch (f){
+    case 1:
+        nmea_epoch(nmea);
+        break;
+    case 2:
+        w->status = (nmea->chr == 'A');
+        break;
+    case 3: case 4: case 5: case 6:
+        nmea_position(nmea, f - 3);
+        break;
+    case 7:
+        w->speed_cms = (uint16_t)(nmea_scaled(nmea, 2)*5144/10000); ///< Knots x100 to cm/s
+        break;
+    case 8:
+        if (!nmea->empty) w->course_cdeg = (uint16_t)nmea_scaled(nmea, 2);
+        break;
+    case 9:
+        w->date = nmea->empty ? 0 : (uint32_t)nmea->num;
+        break;
+    }
+}
+
+///< $--GSA,a,x,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,x.x,x.x,x.x[,h]
+static void nmea_gsa(nmea_parser_t *nmea, uint8_t f)
+{
+    nmea_fix_t *w = &nmea->work;
+    switch (f){
+    case 2:
+        w->fix_type = (uint8_t)nmea->num;
+        break;
+    case 15:
+        w->pdop = nmea->empty ? 0 : (uint16_t)nmea_scaled(nmea, 2);
+        break;
+    case 16:
+        w->hdop = nmea->empty ? 0 : (uint16_t)nmea_scaled(nmea, 2);
+        break;
+    case 17:
+        w->vdop = nmea->empty ? 0 : (uint16_t)nmea_scaled(nmea, 2);
+        break;
+    }
+}
+
+///< $--VTG,x.x,T,x.x,M,x.x,N,x.x,K[,m]
+static void nmea_vtg(nmea_parser_t *nmea, uint8_t f)
+{
+    nmea_fix_t *w = &nmea->work;
+    switch (f){
+    case 1:
+        if (!nmea->empty) w->course_cdeg = (uint16_t)nmea_scaled(nmea, 2);
+        break;
+    case 7:
+        w->speed_cms = (uint16_t)(nmea_scaled(nmea, 2)*1000/3600); ///< km/h x100 to cm/s
+        break;
+    }
+}
+
+/**
+ * @brief Decoder of a sentence: called at the end of each of its fields (1...) with the field index.
+ *
+ */
+typedef struct{
+    char formatter[4];  ///< Sentence formatter, after the talker ID
+    void (*field)(nmea_parser_t *nmea, uint8_t f);
+}nmea_dispatch_t;
+
+static const nmea_dispatch_t nmea_dispatch[NMEA_NUM] = {
+    [NMEA_GGA] = {"GGA", nmea_gga},
+    [NMEA_RMC] = {"RMC", nmea_rmc},
+    [NMEA_GSA] = {"GSA", nmea_gsa},
+    [NMEA_VTG] = {"VTG", nmea_vtg},
+};
+
+/**
+ * @brief Identify the sentence from the address field, the talker ID is not checked.
+ *
+ */
+static uint8_t nmea_sentence(const nmea_parser_t *nmea)
+{
+    if (nmea->len != 7) return NMEA_NONE; ///< '$', five characters and the comma
+    for (uint8_t i = NMEA_NONE + 1; i < NMEA_NUM; i++){
+        if (!memcmp(&nmea->address[2], nmea_dispatch[i].formatter, 3)) return i;
+    }
+    return NMEA_NONE;
+}
+
+/**
+ * @brief Store the field that has just ended in the working fix.
+ *
+ */
+static void nmea_end_field(nmea_parser_t *nmea)
+{
+    if (nmea->field == 0){
+        nmea->sentence = nmea_sentence(nmea);
+    }else if (nmea->sentence != NMEA_NONE){
+        nmea_dispatch[nmea->sentence].field(nmea, nmea->field);
+    }
+}
+
+static void nmea_start_field(nmea_parser_t *nmea)
+{
+    nmea->num = 0;
+    nmea->frac = 0;
+    nmea->dot = false;
+    nmea->neg = false;
+    nmea->empty = true;
+    nmea->chr = 0;
+}
+
+static uint8_t nmea_hex(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return 0xFF;
+}
+
+void nmea_init(nmea_parser_t *nmea)
+{
+    memset(nmea, 0, sizeof(*nmea));
+    nmea->state = NMEA_IDLE;
+}
+
+bool nmea_feed(nmea_parser_t *nmea, char c)
+{
+    if (c == '$'){ ///< A new sentence, even in the middle of another one
+        if (nmea->state != NMEA_IDLE) nmea->errors++;
+        nmea->state = NMEA_BODY;
+        nmea->len = 1;
+        nmea->checksum = 0;
+        nmea->field = 0;
+        nmea->sentence = NMEA_NONE;
+        nmea->work = nmea->fix; ///< Only the writer changes the fix, no lock to read it here
+        nmea_start_field(nmea);
+        return false;
+    }
+    if (nmea->state == NMEA_IDLE) return false;
+    if (++nmea->len > NMEA_MAX_LEN || c < ' ' || c > '~'){ ///< Too long, or the line ended without a checksum
+        nmea->errors++;
+        nmea->state = NMEA_IDLE;
+        return false;
+    }
+
+    switch (nmea->state){
+    case NMEA_BODY:
+        if (c == '*'){
+            nmea_end_field(nmea);
+            nmea->state = NMEA_CS_HIGH;
+            break;
+        }
+        nmea->checksum ^= (uint8_t)c;
+        if (c == ','){
+            nmea_end_field(nmea);
+            nmea->field++;
+            nmea_start_field(nmea);
+        }
+        else if (nmea->field == 0){
+            if (nmea->len <= 6) nmea->address[nmea->len - 2] = c;
+        }
+        else if (nmea->sentence == NMEA_NONE){
+            ///< Only the checksum of the sentences that are not decoded
+        }
+        else if (c >= '0' && c <= '9'){
+            if (!nmea->dot){
+                nmea->num = nmea->num*10 + (c - '0');
+            }else if (nmea->frac < NMEA_MAX_FRAC){
+                nmea->num = nmea->num*10 + (c - '0');
+                nmea->frac++;
+            }
+            nmea->empty = false;
+        }
+        else if (c == '.'){
+            nmea->dot = true;
+        }
+        else if (c == '-' && nmea->empty){
+            nmea->neg = true;
+        }
+        else if (!nmea->chr){
+            nmea->chr = c;
+        }
+        break;
+    case NMEA_CS_HIGH:
+        nmea->rx_checksum = nmea_hex(c); ///< Raw digit: an invalid one (0xFF) is not truncated by the shift
+        nmea->state = NMEA_CS_LOW;
+        break;
+    case NMEA_CS_LOW:{
+        nmea->state = NMEA_IDLE;
+        uint8_t low = nmea_hex(c);
+        if (nmea->rx_checksum > 0x0F || low > 0x0F || (uint8_t)(nmea->rx_checksum << 4 | low) != nmea->checksum){
+            nmea->errors++;
+            return false;
+        }
+        if (nmea->sentence == NMEA_NONE) return false;
+
+        ///< Publish: odd sequence while the fix changes
+        nmea->work.sentence = nmea->sentence;
+        nmea->work.epoch_mask |= NMEA_MASK(nmea->sentence);
+        nmea->seq++;
+        __sync_synchronize();
+        nmea->fix = nmea->work;
+        nmea->sentences++;
+        __sync_synchronize();
+        nmea->seq++;
+        return true;
+    }
+    default:
+        nmea->state = NMEA_IDLE;
+        break;
+    }
+    return false;
+}
+
+uint32_t nmea_read(nmea_parser_t *nmea, nmea_fix_t *fix)
+{
+    uint32_t seq, sentences;
+    do{
+        seq = nmea->seq;
+        __sync_synchronize();
+        *fix = nmea->fix;
+        sentences = nmea->sentences;
+        __sync_synchronize();
+    }while ((seq & 1) || seq != nmea->seq);
+    return sentences;
+}
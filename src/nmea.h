@@ -0,0 +1,132 @@
+/**
+ * \file        nmea.h
+ * \brief       Incremental NMEA 0183 parser, fed one byte at a time from the UART path.
+ * \details     A state machine follows the sentence from '$' to the checksum, accumulating each
+ *              field as an integer and its decimals, so there are no buffers, no allocations and
+ *              no floating point: the coordinates are converted to microdegrees and the time to
+ *              ms of the day. The fields are written in a working copy of the fix, and only a
+ *              sentence with a correct checksum publishes it, with a sequence lock: the writer
+ *              (the UART interrupt) never waits, and a reader copies again if a sentence was
+ *              published during its copy. The sentences are decoded through a dispatch table
+ *              (GGA, RMC, GSA and VTG, with any talker ID, e.g. $GN of multi-constellation
+ *              receivers) into one fix: GGA and RMC start a new epoch when their time changes, and
+ *              the sentences without a time (GSA, VTG) are merged in the current one.
+ *              Portable C, it is also built by the host benchmark.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __NMEA_H__
+#define __NMEA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NMEA_MAX_FRAC 7 ///< Decimals kept of a field, the next ones are ignored.
+#define NMEA_MAX_LEN 82 ///< Maximum length of a sentence, longer ones are discarded.
+
+/**
+ * @brief Sentences decoded.
+ *
+ */
+typedef enum{
+    NMEA_NONE,
+    NMEA_GGA,   ///< Time, position, fix quality, satellites, HDOP, altitude
+    NMEA_RMC,   ///< Time, status, position, speed, course, date
+    NMEA_GSA,   ///< Fix type, PDOP, HDOP, VDOP
+    NMEA_VTG,   ///< Course, speed
+    NMEA_NUM
+}nmea_sentence_t;
+
+#define NMEA_MASK(sentence) (1u << (sentence)) ///< Bit of a sentence in nmea_fix_t::epoch_mask
+
+/**
+ * @brief Fix published by the parser, the fields keep the value of the last sentence that had them.
+ *
+ */
+typedef struct{
+    uint32_t time_ms;       ///< UTC time of the day, in ms
+    uint32_t date;          ///< UTC date as ddmmyy (RMC), 0 if unknown
+    int32_t lat;            ///< Latitude in microdegrees, negative to the south
+    int32_t lon;            ///< Longitude in microdegrees, negative to the west
+    int32_t alt_dm;         ///< Altitude above the mean sea level, in dm (GGA)
+    uint16_t hdop;          ///< Horizontal dilution of precision x100 (GGA, GSA), 0 if unknown
+    uint16_t pdop;          ///< Position dilution of precision x100 (GSA), 0 if unknown
+    uint16_t vdop;          ///< Vertical dilution of precision x100 (GSA), 0 if unknown
+    uint16_t speed_cms;     ///< Speed over ground in cm/s (RMC, VTG)
+    uint16_t course_cdeg;   ///< Course over ground in centidegrees from the true north (RMC, VTG)
+    uint8_t fix_quality;    ///< 0: invalid, 1: GPS fix, 2: DGPS fix (GGA)
+    uint8_t fix_type;       ///< 1: no fix, 2: 2D, 3: 3D (GSA), 0 if unknown
+    uint8_t num_satellites; ///< Satellites used (GGA)
+    char lat_area;          ///< 'N' or 'S', 0 if there is no position
+    char lon_area;          ///< 'E' or 'W', 0 if there is no position
+    bool status;            ///< The RMC status is active ('A')
+    uint8_t sentence;       ///< nmea_sentence_t of the last sentence published
+    uint8_t epoch_mask;     ///< NMEA_MASK() of the sentences merged in the epoch of time_ms
+}nmea_fix_t;
+
+/**
+ * @brief States of the parser.
+ *
+ */
+typedef enum{
+    NMEA_IDLE,      ///< Waiting for '$'
+    NMEA_BODY,      ///< Fields, until '*'
+    NMEA_CS_HIGH,   ///< First digit of the checksum
+    NMEA_CS_LOW     ///< Second digit of the checksum
+}nmea_state_t;
+
+/**
+ * @typedef nmea_parser_t
+ *
+ * @brief State of the parser and the last fix published.
+ *
+ */
+typedef struct _nmea_parser_t{
+    uint8_t state;          ///< nmea_state_t
+    uint8_t len;            ///< Bytes of the sentence
+    uint8_t checksum;       ///< XOR of the bytes between '$' and '*'
+    uint8_t rx_checksum;    ///< High digit of the checksum received, 0xFF if it is not hexadecimal
+    uint8_t field;          ///< Index of the current field, 0 is the address
+    uint8_t sentence;       ///< nmea_sentence_t of the current sentence
+    char address[5];        ///< Talker and sentence formatter
+    uint64_t num;           ///< Digits of the current field
+    uint8_t frac;           ///< Decimals in num
+    bool dot;               ///< The decimal point was found
+    bool neg;               ///< The field has a minus sign
+    bool empty;             ///< The field has no digits
+    char chr;               ///< First character of the field
+    nmea_fix_t work;        ///< Fix being decoded
+    volatile uint32_t seq;  ///< Sequence lock: odd while the fix is being published
+    nmea_fix_t fix;         ///< Last fix published
+    uint32_t sentences;     ///< Sentences published
+    uint32_t errors;        ///< Sentences discarded by the checksum or the length
+}nmea_parser_t;
+
+/**
+ * @brief Initialize the parser, without a fix.
+ *
+ * @param nmea
+ */
+void nmea_init(nmea_parser_t *nmea);
+
+/**
+ * @brief Feed a byte received from the GPS.
+ *
+ * @param nmea
+ * @param c
+ * @return true if the byte completes a decoded sentence with a correct checksum, and a fix was published.
+ */
+bool nmea_feed(nmea_parser_t *nmea, char c);
+
+/**
+ * @brief Copy the last fix published, consistent even if the parser runs in an interrupt.
+ *
+ * @param nmea
+ * @param fix
+ * @return Number of sentences published, 0 if there is no fix yet.
+ */
+uint32_t nmea_read(nmea_parser_t *nmea, nmea_fix_t *fix);
+
+#endif // __NMEA_H__
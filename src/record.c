@@ -0,0 +1,192 @@
+/**
+ * \file        record.c
+ * \brief       Packed and versioned binary format of the measurement records.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include "record.h"
+
+/**
+ * @brief Cursor over the bytes of a record being decoded.
+ *
+ */
+typedef struct{
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    bool error;             ///< A field was past the end of the record
+}rec_reader_t;
+
+static uint8_t *rec_put_varint(uint8_t *p, uint32_t v)
+{
+    while (v >= 0x80){
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static uint8_t *rec_put_zigzag(uint8_t *p, int32_t v)
+{
+    return rec_put_varint(p, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+static uint8_t rec_get_byte(rec_reader_t *r)
+{
+    if (r->pos >= r->len){
+        r->error = true;
+        return 0;
+    }
+    return r->buf[r->pos++];
+}
+
+static uint32_t rec_get_varint(rec_reader_t *r)
+{
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7){
+        if (r->pos >= r->len){
+            r->error = true;
+            return 0;
+        }
+        uint8_t b = r->buf[r->pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r->error = true; ///< More than 5 bytes
+    return 0;
+}
+
+static int32_t rec_get_zigzag(rec_reader_t *r)
+{
+    uint32_t v = rec_get_varint(r);
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * @brief A level in centi-dB as a delta in steps of REC_LEVEL_STEP_CDB against the Leq, rounded and saturated.
+ *
+ */
+static uint8_t rec_level_delta(int16_t level, int16_t leq)
+{
+    int32_t d = (int32_t)level - leq;
+    d = (d >= 0) ? (d + REC_LEVEL_STEP_CDB/2)/REC_LEVEL_STEP_CDB : (d - REC_LEVEL_STEP_CDB/2)/REC_LEVEL_STEP_CDB;
+    if (d > REC_LEVEL_MAX) d = REC_LEVEL_MAX;
+    if (d < -REC_LEVEL_MAX) d = -REC_LEVEL_MAX;
+    return (uint8_t)(int8_t)d;
+}
+
+static int16_t rec_level(uint8_t delta, int16_t leq)
+{
+    return (int16_t)(leq + REC_LEVEL_STEP_CDB*(int8_t)delta);
+}
+
+uint16_t rec_crc16(const uint8_t *buf, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++){
+        crc ^= (uint16_t)buf[i] << 8;
+        for (int b = 0; b < 8; b++){
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t rec_encode(const rec_t *rec, const rec_t *prev, uint8_t *buf)
+{
+    uint32_t ref_duration = prev ? prev->duration : REC_DEFAULT_DURATION;
+    uint8_t flags = (rec->flags & (REC_F_STATS | REC_F_TW | REC_F_GPS)) | (prev ? 0 : REC_F_ABS) |
+                    ((rec->duration != ref_duration) ? REC_F_DURATION : 0);
+    uint8_t *p = buf;
+    *p++ = (REC_VERSION << REC_VERSION_SHIFT) | flags;
+    *p++ = (uint8_t)rec->leq;
+    *p++ = (uint8_t)((uint16_t)rec->leq >> 8);
+    if (prev){
+        p = rec_put_zigzag(p, rec->lat - prev->lat);
+        p = rec_put_zigzag(p, rec->lon - prev->lon);
+        p = rec_put_zigzag(p, (int32_t)(rec->time - prev->time));
+    }else{
+        p = rec_put_zigzag(p, rec->lat);
+        p = rec_put_zigzag(p, rec->lon);
+        p = rec_put_varint(p, rec->time);
+    }
+    if (flags & REC_F_DURATION) p = rec_put_varint(p, rec->duration);
+    if (flags & REC_F_STATS){
+        const int16_t levels[] = {rec->levels.l5, rec->levels.l10, rec->levels.l50, rec->levels.l90,
+                                  rec->levels.l95, rec->levels.lmax, rec->levels.lmin, rec->levels.lpeak};
+        for (int i = 0; i < 8; i++){
+            *p++ = rec_level_delta(levels[i], rec->leq);
+        }
+    }
+    if (flags & REC_F_TW){
+        for (int i = 0; i < REC_NUM_TW; i++){
+            *p++ = rec_level_delta(rec->tw_max[i], rec->leq);
+        }
+    }
+    if (flags & REC_F_GPS){
+        p = rec_put_varint(p, rec->ttff_ms);
+        *p++ = rec->gps_start;
+    }
+    return p - buf;
+}
+
+size_t rec_size(const uint8_t *buf, size_t avail)
+{
+    if (avail < 3 || buf[0] >> REC_VERSION_SHIFT != REC_VERSION) return 0;
+    if (avail > REC_MAX_SIZE) avail = REC_MAX_SIZE;
+    rec_reader_t r = {buf, avail, 3, false};
+    uint8_t flags = buf[0] & REC_FLAGS_MASK;
+    for (int i = 0; i < 3; i++) rec_get_varint(&r); ///< Position and time stamp
+    if (flags & REC_F_DURATION) rec_get_varint(&r);
+    if (flags & REC_F_STATS) r.pos += 8;
+    if (flags & REC_F_TW) r.pos += REC_NUM_TW;
+    if (flags & REC_F_GPS){
+        rec_get_varint(&r);
+        r.pos++;
+    }
+    return (r.error || r.pos > r.len) ? 0 : r.pos;
+}
+
+bool rec_decode(const uint8_t *buf, size_t len, const rec_t *prev, rec_t *rec)
+{
+    if (len < 3 || len > REC_MAX_SIZE) return false;
+    if (buf[0] >> REC_VERSION_SHIFT != REC_VERSION) return false;
+
+    rec_reader_t r = {buf, len, 3, false};
+    rec->flags = buf[0] & REC_FLAGS_MASK;
+    if (!(rec->flags & REC_F_ABS) && !prev) return false;
+    rec->leq = (int16_t)(buf[1] | (uint16_t)buf[2] << 8);
+    if (rec->flags & REC_F_ABS){
+        rec->lat = rec_get_zigzag(&r);
+        rec->lon = rec_get_zigzag(&r);
+        rec->time = rec_get_varint(&r);
+    }else{
+        rec->lat = prev->lat + rec_get_zigzag(&r);
+        rec->lon = prev->lon + rec_get_zigzag(&r);
+        rec->time = prev->time + (uint32_t)rec_get_zigzag(&r);
+    }
+    if (rec->flags & REC_F_DURATION) rec->duration = rec_get_varint(&r);
+    else rec->duration = (rec->flags & REC_F_ABS) ? REC_DEFAULT_DURATION : prev->duration;
+    int16_t levels[8] = {0};
+    if (rec->flags & REC_F_STATS){
+        for (int i = 0; i < 8; i++){
+            levels[i] = rec_level(rec_get_byte(&r), rec->leq);
+        }
+    }
+    rec->levels = (stats_levels_t){levels[0], levels[1], levels[2], levels[3],
+                                   levels[4], levels[5], levels[6], levels[7]};
+    for (int i = 0; i < REC_NUM_TW; i++){
+        rec->tw_max[i] = (rec->flags & REC_F_TW) ? rec_level(rec_get_byte(&r), rec->leq) : 0;
+    }
+    rec->ttff_ms = 0;
+    rec->gps_start = 0;
+    if (rec->flags & REC_F_GPS){
+        rec->ttff_ms = rec_get_varint(&r);
+        rec->gps_start = rec_get_byte(&r);
+    }
+    return !r.error && r.pos == r.len;
+}
@@ -0,0 +1,101 @@
+/**
+ * \file        record.h
+ * \brief       Packed and versioned binary format of the measurement records.
+ * \details     A record is a byte of version and flags, the Leq (int16, centi-dB), the position
+ *              (microdegrees) and the time stamp as zigzag varints, and the optional fields its
+ *              flags announce. The position and the time stamp are deltas against the previous
+ *              record, except in a record with REC_F_ABS, so a reader must start at one of them
+ *              (the first record of each flash page). The duration is only present (varint) when
+ *              it differs from the one of the previous record, or from REC_DEFAULT_DURATION in an
+ *              absolute record. The optional levels are one byte each, the delta against the Leq
+ *              in steps of REC_LEVEL_STEP_CDB, saturated. The GPS field is the TTFF of the session
+ *              in ms as a varint followed by the start byte. Multi-byte fixed fields are little
+ *              endian. There is no length nor CRC: the fields give the length (rec_size()) and the
+ *              flash log protects its pages with a CRC. The first byte of a record is never 0xFF,
+ *              the free space of a flash page. Portable C, it is also built by the host tools.
+ *              A record of the tracker without the optional fields is about 9 bytes with the
+ *              deltas and 16 when absolute (12 for the three int32 of the format before).
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __RECORD_H__
+#define __RECORD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stats.h"
+
+#define REC_VERSION 2 ///< Version of the format, 3 bits.
+#define REC_VERSION_SHIFT 5
+#define REC_FLAGS_MASK 0x1F
+#define REC_F_ABS 0x01 ///< Position and time stamp are absolute
+#define REC_F_STATS 0x02 ///< Statistical levels are present
+#define REC_F_TW 0x04 ///< Maximum Fast, Slow and Impulse levels are present
+#define REC_F_GPS 0x08 ///< Time to the first fix of the GPS session and its start are present
+#define REC_F_DURATION 0x10 ///< The duration is present, it differs from the one of the reference
+#define REC_NUM_TW 3 ///< Levels of the REC_F_TW field
+#define REC_DEFAULT_DURATION 10 ///< Duration (s) of the reference of an absolute record
+#define REC_LEVEL_STEP_CDB 50 ///< Resolution of the optional levels, 0.5 dB
+#define REC_LEVEL_MAX 127 ///< Largest delta of an optional level, in steps (+-63.5 dB)
+#define REC_MAX_SIZE 40 ///< Bytes of the largest record, with every field.
+
+/**
+ * @brief Decoded record.
+ *
+ */
+typedef struct{
+    uint8_t flags;          ///< REC_F_* fields present
+    int16_t leq;            ///< Leq in centi-dB
+    int32_t lat;            ///< Latitude in microdegrees
+    int32_t lon;            ///< Longitude in microdegrees
+    uint32_t time;          ///< UTC time stamp of the start in s since 2000-01-01, only the time of day if the date is unknown
+    uint32_t duration;      ///< Duration of the measurement in s
+    stats_levels_t levels;  ///< Statistical levels in centi-dB (REC_F_STATS), stored with REC_LEVEL_STEP_CDB resolution
+    int16_t tw_max[REC_NUM_TW]; ///< Maximum Fast, Slow and Impulse levels in centi-dB (REC_F_TW), same resolution
+    uint32_t ttff_ms;       ///< Time to the first fix of the GPS session of the measurement, in ms (REC_F_GPS)
+    uint8_t gps_start;      ///< Start of that session, 0: cold (the receiver was off), 1: hot (from backup) (REC_F_GPS)
+}rec_t;
+
+/**
+ * @brief Encode a record.
+ *
+ * @param rec Record, its REC_F_ABS and REC_F_DURATION flags are ignored.
+ * @param prev Previous record of the page, NULL to encode an absolute record.
+ * @param buf At least REC_MAX_SIZE bytes.
+ * @return Bytes of the record.
+ */
+size_t rec_encode(const rec_t *rec, const rec_t *prev, uint8_t *buf);
+
+/**
+ * @brief Length of the record at buf, from its flags and its varints.
+ *
+ * @param buf
+ * @param avail Bytes that can be read from buf.
+ * @return Bytes of the record, 0 if it is not of this version or it does not end within avail.
+ */
+size_t rec_size(const uint8_t *buf, size_t avail);
+
+/**
+ * @brief Decode a record.
+ *
+ * @param buf
+ * @param len Bytes of the record.
+ * @param prev Previous decoded record, only needed if the record is not absolute.
+ * @param rec Decoded record.
+ * @return false if the version or the length are wrong, or if there is no reference for a delta.
+ */
+bool rec_decode(const uint8_t *buf, size_t len, const rec_t *prev, rec_t *rec);
+
+/**
+ * @brief CRC16-CCITT (polynomial 0x1021, initial value 0xFFFF).
+ *
+ * @param buf
+ * @param len
+ * @return uint16_t
+ */
+uint16_t rec_crc16(const uint8_t *buf, size_t len);
+
+#endif // __RECORD_H__
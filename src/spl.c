@@ -0,0 +1,69 @@
+/**
+ * \file        spl.c
+ * \brief       Streaming sound level engine for the microphone blocks.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include "spl.h"
+
+void spl_start(spl_meter_t *spl, uint32_t window)
+{
+    spl->sum_sq = 0;
+    spl->count = 0;
+    spl->window = window;
+    spl->mean_sq = 0;
+    spl->peak = 0;
+    spl->ready = false;
+}
+
+void spl_remove_dc(spl_meter_t *spl, const uint16_t *raw, int32_t *ac, uint32_t n)
+{
+    if (!spl->dc_valid && n){
+        spl->dc = (int32_t)(raw[0] & SPL_ADC_MASK) << SPL_DC_Q; ///< Seed the DC tracker
+        spl->dc_valid = true;
+    }
+
+    int32_t dc = spl->dc;
+    for (uint32_t i = 0; i < n; i++){
+        int32_t x = (int32_t)(raw[i] & SPL_ADC_MASK) << SPL_DC_Q;
+        dc += (x - dc) >> SPL_DC_SHIFT; ///< First order DC tracker
+        ac[i] = (x - dc) >> (SPL_DC_Q - SPL_AC_Q);
+    }
+    spl->dc = dc;
+}
+
+bool spl_add_block(spl_meter_t *spl, const int32_t *ac, uint32_t n)
+{
+    if (spl->ready) return false;
+    if (spl->window && n > spl->window - spl->count){
+        n = spl->window - spl->count; ///< Only the samples inside the window
+    }
+
+    uint64_t sum_sq = spl->sum_sq;
+    uint32_t peak = spl->peak;
+    for (uint32_t i = 0; i < n; i++){
+        int32_t x = ac[i];
+        uint32_t a = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+        if (a > SPL_AC_MAX) a = SPL_AC_MAX;
+        if (a > peak) peak = a;
+        sum_sq += a*a;
+    }
+    spl->sum_sq = sum_sq;
+    spl->peak = peak;
+    spl->count += n;
+
+    if (spl->window && spl->count >= spl->window){
+        spl->mean_sq = spl->sum_sq/spl->count; ///< Latch the result of the window
+        spl->ready = true;
+    }
+    return spl->ready;
+}
+
+uint64_t spl_running_mean_sq(spl_meter_t *spl)
+{
+    if (spl->count == 0) return 0;
+    return spl->sum_sq/spl->count;
+}
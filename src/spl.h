@@ -0,0 +1,103 @@
+/**
+ * \file        spl.h
+ * \brief       Streaming sound level engine for the microphone blocks.
+ * \details     The samples of each DMA block are accumulated as they arrive: the DC bias of the
+ *              microphone is removed by a first order tracker, the block goes through the weighting
+ *              filter, and the squares of the acoustic part are summed in a 64-bit integer. At the end of the integration window the
+ *              mean square is latched, so the Leq is ready as soon as the last sample lands.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __SPL_H__
+#define __SPL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "db.h"
+
+#define SPL_ADC_MASK 0x0FFF ///< Bits of the conversion, bit 15 is the ADC error flag.
+#define SPL_DC_Q 16 ///< Fractional bits of the DC estimate.
+#define SPL_AC_Q 2 ///< Fractional bits of the samples without DC (resolution of 1/4 of code).
+#define SPL_DC_SHIFT 10 ///< Time constant of the DC tracker, 2^SPL_DC_SHIFT samples.
+#define SPL_AC_MAX 0xFFFF ///< Saturation of the samples, so their square fits in 32 bits.
+
+/**
+ * @typedef spl_meter_t
+ * 
+ * @brief Structure to accumulate the energy of the samples over an integration window.
+ * 
+ */
+typedef struct _spl_meter_t{
+    int32_t dc;         ///< DC estimate in Q(SPL_DC_Q) ADC codes.
+    bool dc_valid;      ///< The DC estimate has been seeded with the first sample.
+    uint64_t sum_sq;    ///< Sum of squares of the samples without DC, in Q(2*SPL_AC_Q) codes^2.
+    uint32_t count;     ///< Number of samples accumulated in the current window.
+    uint32_t window;    ///< Integration window in samples, 0 means endless.
+    uint64_t mean_sq;   ///< Mean square latched at the end of the window, in Q(2*SPL_AC_Q) codes^2.
+    uint32_t peak;      ///< Maximum absolute value of the samples of the window, in Q(SPL_AC_Q) codes.
+    bool ready;         ///< The window is complete and mean_sq is valid.
+}spl_meter_t;
+
+/**
+ * @brief Start a new integration window. The DC estimate is kept between windows.
+ * 
+ * @param spl 
+ * @param window Number of samples of the window, 0 for an endless window (read it with spl_running_mean_sq()).
+ */
+void spl_start(spl_meter_t *spl, uint32_t window);
+
+/**
+ * @brief Reset the DC estimate, it will be seeded with the next sample.
+ * 
+ * @param spl 
+ */
+static inline void spl_reset_dc(spl_meter_t *spl)
+{
+    spl->dc_valid = false;
+    spl->dc = 0;
+}
+
+/**
+ * @brief Remove the DC bias of a block of raw ADC samples.
+ * 
+ * @param spl 
+ * @param raw Raw ADC samples (12 bits).
+ * @param ac Output samples without DC, in Q(SPL_AC_Q) codes.
+ * @param n Number of samples of the block.
+ */
+void spl_remove_dc(spl_meter_t *spl, const uint16_t *raw, int32_t *ac, uint32_t n);
+
+/**
+ * @brief Accumulate the energy of a block of samples. Samples after the end of the window are ignored.
+ * 
+ * @param spl 
+ * @param ac Samples without DC (and weighted), in Q(SPL_AC_Q) codes.
+ * @param n Number of samples of the block.
+ * @return true if the window has been completed with this block.
+ */
+bool spl_add_block(spl_meter_t *spl, const int32_t *ac, uint32_t n);
+
+/**
+ * @brief Mean square of the samples accumulated so far in the current window.
+ * 
+ * @param spl 
+ * @return Mean square in Q(2*SPL_AC_Q) codes^2.
+ */
+uint64_t spl_running_mean_sq(spl_meter_t *spl);
+
+/**
+ * @brief Equivalent continuous level of the mean square, Leq = 10*log10(mean_sq) + cal, in integer arithmetic.
+ * 
+ * @param mean_sq Mean square in Q(2*SPL_AC_Q) codes^2.
+ * @param cal_cdb Level in centi-dB of an RMS of 1 ADC code.
+ * @return Level in centi-dB.
+ */
+static inline int32_t spl_leq_cdb(uint64_t mean_sq, int32_t cal_cdb)
+{
+    return db_energy_cdb(mean_sq) - db_energy_cdb(1u << (2*SPL_AC_Q)) + cal_cdb;
+}
+
+#endif // __SPL_H__
@@ -0,0 +1,97 @@
+/**
+ * \file        spsc_queue.h
+ * \brief       Lock-free single-producer/single-consumer queue.
+ * \details     The producer only writes head and the consumer only writes tail, so a producer
+ *              on one core (or an ISR) and a consumer on the other core need no lock. The
+ *              memory barriers order the copy of the item with the update of the index.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __SPSC_QUEUE_H__
+#define __SPSC_QUEUE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "pico.h"
+
+/**
+ * @typedef spsc_queue_t
+ * 
+ * @brief Ring of fixed size items.
+ * 
+ */
+typedef struct{
+    uint8_t *buf;           ///< Storage of size*elem_size bytes
+    uint16_t elem_size;     ///< Size of an item in bytes
+    uint16_t size;          ///< Number of items of the ring, power of 2
+    volatile uint32_t head; ///< Items pushed, written only by the producer
+    volatile uint32_t tail; ///< Items popped, written only by the consumer
+}spsc_queue_t;
+
+/**
+ * @brief Initialize an empty queue. It must not be used by the other side while it is initialized.
+ * 
+ * @param q 
+ * @param buf Storage of size*elem_size bytes.
+ * @param elem_size Size of an item in bytes.
+ * @param size Number of items, power of 2.
+ */
+static inline void spsc_init(spsc_queue_t *q, void *buf, uint16_t elem_size, uint16_t size)
+{
+    q->buf = (uint8_t *)buf;
+    q->elem_size = elem_size;
+    q->size = size;
+    q->head = 0;
+    q->tail = 0;
+}
+
+/**
+ * @brief Number of items in the queue.
+ * 
+ * @param q 
+ * @return uint32_t 
+ */
+static inline uint32_t spsc_count(spsc_queue_t *q)
+{
+    return q->head - q->tail;
+}
+
+/**
+ * @brief Push an item (producer side).
+ * 
+ * @param q 
+ * @param item 
+ * @return false if the queue is full.
+ */
+static inline bool spsc_push(spsc_queue_t *q, const void *item)
+{
+    uint32_t head = q->head;
+    if (head - q->tail >= q->size) return false;
+    memcpy(&q->buf[(head & (q->size - 1))*q->elem_size], item, q->elem_size);
+    __dmb(); ///< The item is written before it is published
+    q->head = head + 1;
+    return true;
+}
+
+/**
+ * @brief Pop an item (consumer side).
+ * 
+ * @param q 
+ * @param item 
+ * @return false if the queue is empty.
+ */
+static inline bool spsc_pop(spsc_queue_t *q, void *item)
+{
+    uint32_t tail = q->tail;
+    if (q->head == tail) return false;
+    __dmb(); ///< The item is read after its publication is seen
+    memcpy(item, &q->buf[(tail & (q->size - 1))*q->elem_size], q->elem_size);
+    __dmb(); ///< The item is read before its slot is released
+    q->tail = tail + 1;
+    return true;
+}
+
+#endif // __SPSC_QUEUE_H__
@@ -0,0 +1,71 @@
+/**
+ * \file        stats.c
+ * \brief       Statistical levels of a measurement from a histogram of short interval levels.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+
+#include "stats.h"
+
+void stats_reset(stats_t *stats)
+{
+    memset(stats->bins, 0, sizeof(stats->bins));
+    stats->count = 0;
+    stats->max = INT32_MIN;
+    stats->min = INT32_MAX;
+}
+
+void stats_add(stats_t *stats, int32_t level_cdb)
+{
+    int32_t bin = (level_cdb - STATS_MIN_CDB)/STATS_BIN_CDB;
+    if (bin < 0) bin = 0;
+    else if (bin >= STATS_NUM_BINS) bin = STATS_NUM_BINS - 1;
+    if (stats->bins[bin] != UINT16_MAX) stats->bins[bin]++;
+
+    stats->count++;
+    if (level_cdb > stats->max) stats->max = level_cdb;
+    if (level_cdb < stats->min) stats->min = level_cdb;
+}
+
+int32_t stats_percentile(stats_t *stats, uint8_t percent)
+{
+    if (stats->count == 0) return 0;
+    uint32_t target = (stats->count*percent + 99)/100; ///< Intervals above the level, rounded up
+    uint32_t acc = 0;
+    for (int32_t bin = STATS_NUM_BINS - 1; bin >= 0; bin--){
+        acc += stats->bins[bin];
+        if (acc >= target){
+            return STATS_MIN_CDB + bin*STATS_BIN_CDB + STATS_BIN_CDB/2;
+        }
+    }
+    return STATS_MIN_CDB + STATS_BIN_CDB/2;
+}
+
+/**
+ * @brief Saturate a level in centi-dB to 16 bits.
+ * 
+ * @param level 
+ * @return int16_t 
+ */
+static inline int16_t stats_to_int16(int32_t level)
+{
+    if (level > INT16_MAX) return INT16_MAX;
+    if (level < INT16_MIN) return INT16_MIN;
+    return (int16_t)level;
+}
+
+void stats_get_levels(stats_t *stats, int32_t peak_cdb, stats_levels_t *levels)
+{
+    levels->l5 = stats_to_int16(stats_percentile(stats, 5));
+    levels->l10 = stats_to_int16(stats_percentile(stats, 10));
+    levels->l50 = stats_to_int16(stats_percentile(stats, 50));
+    levels->l90 = stats_to_int16(stats_percentile(stats, 90));
+    levels->l95 = stats_to_int16(stats_percentile(stats, 95));
+    levels->lmax = stats->count ? stats_to_int16(stats->max) : 0;
+    levels->lmin = stats->count ? stats_to_int16(stats->min) : 0;
+    levels->lpeak = stats_to_int16(peak_cdb);
+}
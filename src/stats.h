@@ -0,0 +1,85 @@
+/**
+ * \file        stats.h
+ * \brief       Statistical levels of a measurement from a histogram of short interval levels.
+ * \details     Each short interval level (125 ms in the microphone) increments one bin of 
+ *              STATS_BIN_CDB centi-dB, so the memory is constant whatever the duration. The levels
+ *              exceeded N% of the time (L5, L10, L50, L90, L95) are read from the histogram at the
+ *              end of the measurement, with the resolution of a bin.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STATS_BIN_CDB 10 ///< Width of a bin, 0.1 dB.
+#define STATS_MIN_CDB 0 ///< Level of the first bin, lower levels go to it.
+#define STATS_MAX_CDB 14000 ///< Level of the end of the last bin, higher levels go to it.
+#define STATS_NUM_BINS ((STATS_MAX_CDB - STATS_MIN_CDB)/STATS_BIN_CDB)
+
+/**
+ * @brief Statistical levels of a measurement, in centi-dB.
+ * 
+ */
+typedef struct{
+    int16_t l5;     ///< Level exceeded 5% of the time
+    int16_t l10;    ///< Level exceeded 10% of the time
+    int16_t l50;    ///< Level exceeded 50% of the time
+    int16_t l90;    ///< Level exceeded 90% of the time
+    int16_t l95;    ///< Level exceeded 95% of the time
+    int16_t lmax;   ///< Maximum short interval level
+    int16_t lmin;   ///< Minimum short interval level
+    int16_t lpeak;  ///< Peak level of the samples
+}stats_levels_t;
+
+/**
+ * @typedef stats_t
+ * 
+ * @brief Histogram of the short interval levels.
+ * 
+ */
+typedef struct _stats_t{
+    uint16_t bins[STATS_NUM_BINS]; ///< Number of intervals of each bin (saturated)
+    uint32_t count; ///< Number of intervals
+    int32_t max;    ///< Maximum level, in centi-dB
+    int32_t min;    ///< Minimum level, in centi-dB
+}stats_t;
+
+/**
+ * @brief Clear the histogram.
+ * 
+ * @param stats 
+ */
+void stats_reset(stats_t *stats);
+
+/**
+ * @brief Add the level of a short interval. 
+ * 
+ * @param stats 
+ * @param level_cdb Level in centi-dB.
+ */
+void stats_add(stats_t *stats, int32_t level_cdb);
+
+/**
+ * @brief Level exceeded n% of the time: the center of the bin where the count from the top reaches n%.
+ * 
+ * @param stats 
+ * @param percent Between 1 and 99.
+ * @return Level in centi-dB, 0 if the histogram is empty.
+ */
+int32_t stats_percentile(stats_t *stats, uint8_t percent);
+
+/**
+ * @brief Compute all the statistical levels.
+ * 
+ * @param stats 
+ * @param peak_cdb Peak level of the samples, in centi-dB.
+ * @param levels 
+ */
+void stats_get_levels(stats_t *stats, int32_t peak_cdb, stats_levels_t *levels);
+
+#endif // __STATS_H__
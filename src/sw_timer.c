@@ -0,0 +1,145 @@
+/**
+ * \file        sw_timer.c
+ * \brief       One-shot and periodic software timers on a single hardware alarm.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+#include "sw_timer.h"
+
+static swt_timer_t *swt_head;   ///< Active timers, ordered by expiration
+static swt_stats_t swt_stats;
+
+/**
+ * @brief Insert a timer in the list, after the ones that expire at the same time.
+ *
+ */
+static void swt_insert(swt_timer_t *timer)
+{
+    swt_timer_t **p = &swt_head;
+    while (*p && (int32_t)(timer->expire_us - (*p)->expire_us) >= 0) p = &(*p)->next;
+    timer->next = *p;
+    *p = timer;
+    timer->active = true;
+}
+
+static void swt_remove(swt_timer_t *timer)
+{
+    for (swt_timer_t **p = &swt_head; *p; p = &(*p)->next){
+        if (*p == timer){
+            *p = timer->next;
+            break;
+        }
+    }
+    timer->next = NULL;
+    timer->active = false;
+}
+
+/**
+ * @brief Set the alarm to the latest time the timers may wait: the earliest expiration plus slack.
+ *
+ */
+static void swt_arm(void)
+{
+    if (!swt_head){
+        hw_clear_bits(&timer_hw->inte, 1u << SWT_ALARM);
+        timer_hw->armed = 1u << SWT_ALARM; ///< Write 1 to disarm
+        return;
+    }
+    uint32_t target = swt_head->expire_us + swt_head->slack_us;
+    for (swt_timer_t *t = swt_head->next; t && (int32_t)(t->expire_us - target) < 0; t = t->next){
+        if ((int32_t)(t->expire_us + t->slack_us - target) < 0) target = t->expire_us + t->slack_us;
+    }
+    hw_set_bits(&timer_hw->inte, 1u << SWT_ALARM);
+    timer_hw->alarm[SWT_ALARM] = target;
+    if ((int32_t)(target - timer_hw->timerawl) <= 0){ ///< The alarm only matches a future time: force the interrupt
+        hw_set_bits(&timer_hw->intf, 1u << SWT_ALARM);
+    }
+}
+
+/**
+ * @brief Interrupt of the alarm: run the expired timers and set the alarm again.
+ *
+ */
+static void swt_handler(void)
+{
+    hw_clear_bits(&timer_hw->intf, 1u << SWT_ALARM);
+    timer_hw->intr = 1u << SWT_ALARM; ///< Write 1 to clear
+    swt_stats.wakeups++;
+
+    uint32_t now = time_us_32();
+    while (swt_head && (int32_t)(now - swt_head->expire_us) >= 0){
+        swt_timer_t *t = swt_head;
+        uint32_t late = now - t->expire_us;
+        if (late > swt_stats.late_max_us) swt_stats.late_max_us = late;
+        swt_remove(t);
+        if (t->period_us){ ///< Next period from the expiration, or from now if some were missed
+            t->expire_us += t->period_us;
+            if ((int32_t)(now - t->expire_us) >= 0) t->expire_us = now + t->period_us;
+            swt_insert(t);
+        }
+        swt_stats.expirations++;
+        t->callback(t); ///< It may restart or cancel any timer
+    }
+    swt_arm();
+}
+
+void swt_init(void)
+{
+    swt_head = NULL;
+    swt_stats = (swt_stats_t){0};
+    hardware_alarm_claim(SWT_ALARM); ///< Panics if another module uses it
+    irq_set_exclusive_handler(TIMER_IRQ_0 + SWT_ALARM, swt_handler);
+    irq_set_enabled(TIMER_IRQ_0 + SWT_ALARM, true);
+}
+
+void swt_timer_init(swt_timer_t *timer, swt_callback_t callback, void *param)
+{
+    timer->next = NULL;
+    timer->active = false;
+    timer->period_us = 0;
+    timer->slack_us = 0;
+    timer->callback = callback;
+    timer->param = param;
+}
+
+void swt_start(swt_timer_t *timer, uint32_t delay_us, uint32_t period_us, uint32_t slack_us)
+{
+    uint32_t irq = save_and_disable_interrupts(); ///< The list is also changed by the callbacks
+    if (timer->active) swt_remove(timer);
+    timer->expire_us = time_us_32() + delay_us;
+    timer->period_us = period_us;
+    timer->slack_us = slack_us;
+    swt_insert(timer);
+    swt_arm();
+    restore_interrupts(irq);
+}
+
+void swt_cancel(swt_timer_t *timer)
+{
+    uint32_t irq = save_and_disable_interrupts();
+    if (timer->active){
+        swt_remove(timer);
+        swt_arm();
+    }
+    restore_interrupts(irq);
+}
+
+const swt_stats_t *swt_get_stats(void)
+{
+    return &swt_stats;
+}
+
+void swt_print_stats(void)
+{
+    printf("Timers: %lu wakeups, %lu callbacks, max %lu us late\n", (unsigned long)swt_stats.wakeups,
+           (unsigned long)swt_stats.expirations, (unsigned long)swt_stats.late_max_us);
+}
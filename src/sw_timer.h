@@ -0,0 +1,114 @@
+/**
+ * \file        sw_timer.h
+ * \brief       One-shot and periodic software timers on a single hardware alarm.
+ * \details     The active timers are kept in a list ordered by expiration. The hardware alarm
+ *              SWT_ALARM is set to the earliest expiration plus the slack of its timer (the latest
+ *              time it may run), and its interrupt runs every timer that has expired by then, so the
+ *              timers that expire close together share one wakeup. A timer never runs before its
+ *              expiration, nor later than its slack (unless the interrupts are held). A periodic
+ *              timer is rescheduled from its expiration, without drift. The callbacks run in the
+ *              interrupt of the alarm; they can start or cancel any timer, themselves included.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __SW_TIMER_H__
+#define __SW_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SWT_ALARM 0 ///< Hardware alarm of the timers, TIMER_IRQ_1 to TIMER_IRQ_3 are free
+
+struct _swt_timer_t;
+
+/**
+ * @brief Callback of a timer, in the interrupt of the alarm.
+ *
+ */
+typedef void (*swt_callback_t)(struct _swt_timer_t *timer);
+
+/**
+ * @typedef swt_timer_t
+ *
+ * @brief A software timer, owned by its module.
+ *
+ */
+typedef struct _swt_timer_t{
+    struct _swt_timer_t *next;  ///< Next timer to expire
+    uint32_t expire_us;         ///< time_us_32() of the expiration
+    uint32_t period_us;         ///< 0: one-shot
+    uint32_t slack_us;          ///< It may run this late, to share the wakeup of a later timer
+    swt_callback_t callback;
+    void *param;                ///< For the callback
+    bool active;                ///< In the list
+}swt_timer_t;
+
+/**
+ * @brief Counters of the timer service.
+ *
+ */
+typedef struct{
+    uint32_t wakeups;       ///< Interrupts of the alarm
+    uint32_t expirations;   ///< Callbacks run
+    uint32_t late_max_us;   ///< Longest delay of a callback after its expiration
+}swt_stats_t;
+
+/**
+ * @brief Claim the alarm and install its handler, without timers.
+ *
+ */
+void swt_init(void);
+
+/**
+ * @brief Set the callback of a timer, stopped.
+ *
+ * @param timer
+ * @param callback
+ * @param param
+ */
+void swt_timer_init(swt_timer_t *timer, swt_callback_t callback, void *param);
+
+/**
+ * @brief Start a timer, or restart it if it is active.
+ *
+ * @param timer
+ * @param delay_us Time to the first expiration, 0 to run it as soon as possible.
+ * @param period_us Period of the next expirations, 0 for a one-shot timer.
+ * @param slack_us How late it may run to share a wakeup.
+ */
+void swt_start(swt_timer_t *timer, uint32_t delay_us, uint32_t period_us, uint32_t slack_us);
+
+/**
+ * @brief Stop a timer, nothing is done if it is not active.
+ *
+ * @param timer
+ */
+void swt_cancel(swt_timer_t *timer);
+
+/**
+ * @brief Check if a timer is waiting for its expiration.
+ *
+ * @param timer
+ * @return true if it is active.
+ */
+static inline bool swt_active(const swt_timer_t *timer)
+{
+    return timer->active;
+}
+
+/**
+ * @brief Counters since swt_init().
+ *
+ * @return swt_stats_t*
+ */
+const swt_stats_t *swt_get_stats(void);
+
+/**
+ * @brief Print the wakeups and the callbacks run.
+ *
+ */
+void swt_print_stats(void);
+
+#endif // __SW_TIMER_H__
@@ -0,0 +1,69 @@
+/**
+ * \file        time_weighting.c
+ * \brief       Exponential time weighting detectors (Fast, Slow and Impulse) of IEC 61672-1.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include "time_weighting.h"
+#include "spl.h"
+
+/**
+ * @brief Coefficient of a detector: T/tau in Q(TW_ALPHA_Q), where T is the duration of a group of samples.
+ * 1 - exp(-T/tau) differs from T/tau in less than 0.2% for the time constants used.
+ * 
+ * @param fs Sample rate in Hz.
+ * @param tau_ms Time constant in ms.
+ * @return uint32_t 
+ */
+static uint32_t tw_alpha(uint32_t fs, uint32_t tau_ms)
+{
+    return (uint32_t)(((uint64_t)TW_DECIM*1000 << TW_ALPHA_Q)/((uint64_t)fs*tau_ms));
+}
+
+void tw_init(tw_t *tw, uint32_t fs)
+{
+    tw->alpha[TW_FAST] = tw_alpha(fs, TW_FAST_MS);
+    tw->alpha[TW_SLOW] = tw_alpha(fs, TW_SLOW_MS);
+    tw->alpha[TW_IMPULSE] = tw_alpha(fs, TW_IMPULSE_RISE_MS);
+    tw->alpha_decay = tw_alpha(fs, TW_IMPULSE_DECAY_MS);
+    tw_reset(tw);
+}
+
+void tw_reset(tw_t *tw)
+{
+    for (int i = 0; i < TW_NUM; i++){
+        tw->y[i] = 0;
+        tw->max[i] = 0;
+    }
+    tw->impulse_avg = 0;
+    tw->acc = 0;
+    tw->phase = 0;
+}
+
+void tw_process(tw_t *tw, const int32_t *x, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++){
+        uint32_t a = (x[i] < 0) ? -(uint32_t)x[i] : (uint32_t)x[i];
+        if (a > SPL_AC_MAX) a = SPL_AC_MAX;
+        tw->acc += a*a;
+        if (++tw->phase < TW_DECIM) continue;
+
+        ///< Mean square of the group, with the extra fractional bits of the state
+        int64_t e = (int64_t)((tw->acc << TW_STATE_Q)/TW_DECIM);
+        tw->acc = 0;
+        tw->phase = 0;
+
+        tw->y[TW_FAST] += ((e - tw->y[TW_FAST])*tw->alpha[TW_FAST]) >> TW_ALPHA_Q;
+        tw->y[TW_SLOW] += ((e - tw->y[TW_SLOW])*tw->alpha[TW_SLOW]) >> TW_ALPHA_Q;
+        tw->impulse_avg += ((e - tw->impulse_avg)*tw->alpha[TW_IMPULSE]) >> TW_ALPHA_Q;
+        tw->y[TW_IMPULSE] -= (tw->y[TW_IMPULSE]*tw->alpha_decay) >> TW_ALPHA_Q;
+        if (tw->impulse_avg > tw->y[TW_IMPULSE]) tw->y[TW_IMPULSE] = tw->impulse_avg;
+
+        for (int d = 0; d < TW_NUM; d++){
+            if (tw->y[d] > tw->max[d]) tw->max[d] = tw->y[d];
+        }
+    }
+}
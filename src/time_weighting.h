@@ -0,0 +1,103 @@
+/**
+ * \file        time_weighting.h
+ * \brief       Exponential time weighting detectors (Fast, Slow and Impulse) of IEC 61672-1.
+ * \details     The squares of the weighted samples are averaged in groups of TW_DECIM samples, and
+ *              each group updates the detectors: y += alpha*(x^2 - y), with alpha = T/tau in 
+ *              Q(TW_ALPHA_Q), T the duration of a group. The Impulse detector averages with 35 ms
+ *              and holds the peak of the average with a decay of 1.5 s, so steady signals read the
+ *              same level in the three detectors. The updates are incremental per block.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __TIME_WEIGHTING_H__
+#define __TIME_WEIGHTING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TW_DECIM 8 ///< Samples averaged before each update of the detectors.
+#define TW_ALPHA_Q 20 ///< Fractional bits of the coefficients.
+#define TW_STATE_Q 8 ///< Extra fractional bits of the energy of the detectors.
+#define TW_FAST_MS 125 ///< Time constant of the Fast detector.
+#define TW_SLOW_MS 1000 ///< Time constant of the Slow detector.
+#define TW_IMPULSE_RISE_MS 35 ///< Rising time constant of the Impulse detector.
+#define TW_IMPULSE_DECAY_MS 1500 ///< Decaying time constant of the Impulse detector.
+
+/**
+ * @brief Detectors.
+ * 
+ */
+typedef enum{
+    TW_FAST,
+    TW_SLOW,
+    TW_IMPULSE,
+    TW_NUM
+}tw_detector_t;
+
+/**
+ * @typedef tw_t
+ * 
+ * @brief State of the time weighting detectors.
+ * 
+ */
+typedef struct _tw_t{
+    uint32_t alpha[TW_NUM];     ///< Coefficients, for the Impulse detector the averaging one
+    uint32_t alpha_decay;       ///< Decaying coefficient of the peak of the Impulse detector
+    int64_t impulse_avg;        ///< 35 ms average of the Impulse detector
+    int64_t y[TW_NUM];          ///< Energy of the detectors, in Q(2*SPL_AC_Q + TW_STATE_Q) codes^2
+    int64_t max[TW_NUM];        ///< Maximum energy of the detectors since the reset
+    uint64_t acc;               ///< Sum of squares of the current group
+    uint8_t phase;              ///< Samples in the current group
+}tw_t;
+
+/**
+ * @brief Compute the coefficients for the sample rate and reset the detectors.
+ * 
+ * @param tw 
+ * @param fs Sample rate in Hz.
+ */
+void tw_init(tw_t *tw, uint32_t fs);
+
+/**
+ * @brief Reset the detectors and their maximum.
+ * 
+ * @param tw 
+ */
+void tw_reset(tw_t *tw);
+
+/**
+ * @brief Update the detectors with a block of weighted samples.
+ * 
+ * @param tw 
+ * @param x Samples in Q(SPL_AC_Q) codes.
+ * @param n Number of samples.
+ */
+void tw_process(tw_t *tw, const int32_t *x, uint32_t n);
+
+/**
+ * @brief Current energy of a detector.
+ * 
+ * @param tw 
+ * @param det 
+ * @return Energy in Q(2*SPL_AC_Q) codes^2, as the mean square of spl_meter_t.
+ */
+static inline uint64_t tw_energy(tw_t *tw, tw_detector_t det)
+{
+    return (uint64_t)tw->y[det] >> TW_STATE_Q;
+}
+
+/**
+ * @brief Maximum energy of a detector since the reset.
+ * 
+ * @param tw 
+ * @param det 
+ * @return Energy in Q(2*SPL_AC_Q) codes^2.
+ */
+static inline uint64_t tw_max_energy(tw_t *tw, tw_detector_t det)
+{
+    return (uint64_t)tw->max[det] >> TW_STATE_Q;
+}
+
+#endif // __TIME_WEIGHTING_H__
@@ -0,0 +1,200 @@
+/**
+ * \file        ubx.c
+ * \brief       u-blox UBX binary protocol: frames, parser of the navigation messages.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+#include "ubx.h"
+
+static uint16_t ubx_u16(const uint8_t *p)
+{
+    return p[0] | (uint16_t)p[1] << 8;
+}
+
+static uint32_t ubx_u32(const uint8_t *p)
+{
+    return ubx_u16(p) | (uint32_t)ubx_u16(p + 2) << 16;
+}
+
+/**
+ * @brief Degrees x10^7 to microdegrees, rounded.
+ *
+ */
+static int32_t ubx_microdeg(int32_t v)
+{
+    return (v >= 0) ? (v + 5)/10 : (v - 5)/10;
+}
+
+/**
+ * @brief Start a new epoch when the iTOW of the message changes.
+ *
+ */
+static void ubx_epoch(ubx_parser_t *ubx, uint32_t itow)
+{
+    if (itow != ubx->work.itow){
+        ubx->work.itow = itow;
+        ubx->work.epoch_mask = 0;
+    }
+}
+
+/**
+ * @brief Merge a navigation message with a correct checksum in the working fix.
+ *
+ * @return true if it is a navigation message of the fix.
+ */
+static bool ubx_nav(ubx_parser_t *ubx)
+{
+    const uint8_t *p = ubx->payload;
+    ubx_fix_t *w = &ubx->work;
+    switch (ubx->id){
+    case UBX_NAV_POSLLH:
+        if (ubx->len != UBX_NAV_POSLLH_LEN) return false;
+        ubx_epoch(ubx, ubx_u32(p));
+        w->lon = ubx_microdeg((int32_t)ubx_u32(p + 4));
+        w->lat = ubx_microdeg((int32_t)ubx_u32(p + 8));
+        w->hmsl_dm = (int32_t)ubx_u32(p + 16)/100;
+        w->h_acc_mm = ubx_u32(p + 20);
+        w->v_acc_mm = ubx_u32(p + 24);
+        w->epoch_mask |= 1u << UBX_MSG_POSLLH;
+        return true;
+    case UBX_NAV_STATUS:
+        if (ubx->len != UBX_NAV_STATUS_LEN) return false;
+        ubx_epoch(ubx, ubx_u32(p));
+        w->gps_fix = p[4];
+        w->fix_ok = p[5] & 0x01;    ///< gpsFixOk
+        w->ttff_ms = ubx_u32(p + 8);
+        w->epoch_mask |= 1u << UBX_MSG_STATUS;
+        return true;
+    case UBX_NAV_SOL:
+        if (ubx->len != UBX_NAV_SOL_LEN) return false;
+        ubx_epoch(ubx, ubx_u32(p));
+        w->num_sv = p[47];          ///< numSV
+        w->epoch_mask |= 1u << UBX_MSG_SOL;
+        return true;
+    case UBX_NAV_TIMEUTC:
+        if (ubx->len != UBX_NAV_TIMEUTC_LEN) return false;
+        ubx_epoch(ubx, ubx_u32(p));
+        w->utc_valid = p[19] & 0x04; ///< validUTC
+        if (w->utc_valid){
+            int32_t nano = (int32_t)ubx_u32(p + 8);
+            w->time_ms = (p[16]*3600u + p[17]*60u + p[18])*1000u + (nano > 0 ? nano/1000000 : 0);
+            w->date = p[15]*10000u + p[14]*100u + ubx_u16(p + 12) % 100;
+        }
+        w->epoch_mask |= 1u << UBX_MSG_TIMEUTC;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ubx_init(ubx_parser_t *ubx)
+{
+    memset(ubx, 0, sizeof(*ubx));
+    ubx->state = UBX_SYNC1;
+}
+
+bool ubx_feed(ubx_parser_t *ubx, uint8_t c)
+{
+    switch (ubx->state){
+    case UBX_SYNC1:
+        if (c == UBX_SYNC_1) ubx->state = UBX_SYNC2;
+        return false;
+    case UBX_SYNC2:
+        ubx->state = (c == UBX_SYNC_2) ? UBX_CLASS : (c == UBX_SYNC_1) ? UBX_SYNC2 : UBX_SYNC1;
+        return false;
+    case UBX_CLASS:
+        ubx->cls = c;
+        ubx->ck_a = ubx->ck_b = 0;
+        ubx->state = UBX_ID;
+        break;
+    case UBX_ID:
+        ubx->id = c;
+        ubx->state = UBX_LEN1;
+        break;
+    case UBX_LEN1:
+        ubx->len = c;
+        ubx->state = UBX_LEN2;
+        break;
+    case UBX_LEN2:
+        ubx->len |= (uint16_t)c << 8;
+        ubx->pos = 0;
+        ubx->state = ubx->len ? UBX_PAYLOAD : UBX_CK_A;
+        break;
+    case UBX_PAYLOAD:
+        if (ubx->pos < UBX_MAX_PAYLOAD) ubx->payload[ubx->pos] = c;
+        if (++ubx->pos == ubx->len) ubx->state = UBX_CK_A;
+        break;
+    case UBX_CK_A:
+        ubx->state = (c == ubx->ck_a) ? UBX_CK_B : UBX_SYNC1;
+        if (c != ubx->ck_a) ubx->errors++;
+        return false;
+    case UBX_CK_B:
+        ubx->state = UBX_SYNC1;
+        if (c != ubx->ck_b){
+            ubx->errors++;
+            return false;
+        }
+        if (ubx->len > UBX_MAX_PAYLOAD) return false; ///< Not stored, none of ours
+        if (ubx->cls == UBX_CLASS_ACK && ubx->len == 2){
+            ubx->ack_cls = ubx->payload[0];
+            ubx->ack_id = ubx->payload[1];
+            ubx->ack = (ubx->id == UBX_ACK_ACK) ? UBX_ACK_OK : UBX_ACK_FAIL;
+            return false;
+        }
+        if (ubx->cls != UBX_CLASS_NAV) return false;
+
+        ubx->work = ubx->fix; ///< Only the writer changes the fix, no lock to read it here
+        if (!ubx_nav(ubx)) return false;
+        ///< Publish: odd sequence while the fix changes
+        ubx->seq++;
+        __sync_synchronize();
+        ubx->fix = ubx->work;
+        ubx->frames++;
+        __sync_synchronize();
+        ubx->seq++;
+        return true;
+    default:
+        ubx->state = UBX_SYNC1;
+        return false;
+    }
+    ///< Fletcher checksum of class, id, length and payload
+    ubx->ck_a += c;
+    ubx->ck_b += ubx->ck_a;
+    return false;
+}
+
+uint32_t ubx_read(ubx_parser_t *ubx, ubx_fix_t *fix)
+{
+    uint32_t seq, frames;
+    do{
+        seq = ubx->seq;
+        __sync_synchronize();
+        *fix = ubx->fix;
+        frames = ubx->frames;
+        __sync_synchronize();
+    }while ((seq & 1) || seq != ubx->seq);
+    return frames;
+}
+
+uint16_t ubx_frame(uint8_t *buf, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len)
+{
+    uint8_t ck_a = 0, ck_b = 0;
+    buf[0] = UBX_SYNC_1;
+    buf[1] = UBX_SYNC_2;
+    buf[2] = cls;
+    buf[3] = id;
+    buf[4] = (uint8_t)len;
+    buf[5] = (uint8_t)(len >> 8);
+    if (len) memcpy(&buf[6], payload, len);
+    for (uint16_t i = 2; i < 6 + len; i++){
+        ck_a += buf[i];
+        ck_b += ck_a;
+    }
+    buf[6 + len] = ck_a;
+    buf[7 + len] = ck_b;
+    return len + UBX_OVERHEAD;
+}
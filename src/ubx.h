@@ -0,0 +1,186 @@
+/**
+ * \file        ubx.h
+ * \brief       u-blox UBX binary protocol: frames, parser of the navigation messages.
+ * \details     A frame is 0xB5 0x62, class, id, length (little endian), payload and the 8 bit
+ *              Fletcher checksum of class to payload. The parser is a state machine fed one byte
+ *              at a time, like the NMEA one, and NAV-POSLLH, NAV-STATUS, NAV-SOL and NAV-TIMEUTC
+ *              are merged into one fix, published with a sequence lock. The messages of the same
+ *              navigation epoch have the same iTOW. ACK-ACK and ACK-NAK are kept for the commands.
+ *              Portable C, the payloads are read little endian.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __UBX_H__
+#define __UBX_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UBX_SYNC_1 0xB5
+#define UBX_SYNC_2 0x62
+#define UBX_OVERHEAD 8          ///< Bytes of a frame besides the payload
+#define UBX_MAX_PAYLOAD 52      ///< Longer payloads are checked but not stored
+
+// Classes and ids
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_ACK 0x05
+#define UBX_CLASS_CFG 0x06
+#define UBX_CLASS_RXM 0x02
+#define UBX_CLASS_NMEA 0xF0     ///< Standard NMEA messages, for CFG-MSG
+#define UBX_NAV_POSLLH 0x02     ///< Geodetic position
+#define UBX_NAV_STATUS 0x03     ///< Fix type and flags, TTFF
+#define UBX_NAV_SOL 0x06        ///< Navigation solution, satellites used
+#define UBX_NAV_TIMEUTC 0x21    ///< UTC time and date
+#define UBX_ACK_NAK 0x00
+#define UBX_ACK_ACK 0x01
+#define UBX_CFG_PRT 0x00        ///< Port configuration
+#define UBX_CFG_MSG 0x01        ///< Message rate
+#define UBX_CFG_RATE 0x08       ///< Measurement rate
+#define UBX_RXM_PMREQ 0x41      ///< Power management request (backup mode)
+
+// Payload lengths
+#define UBX_NAV_POSLLH_LEN 28
+#define UBX_NAV_STATUS_LEN 16
+#define UBX_NAV_SOL_LEN 52
+#define UBX_NAV_TIMEUTC_LEN 20
+#define UBX_CFG_PRT_LEN 20
+#define UBX_CFG_MSG_LEN 3
+#define UBX_CFG_RATE_LEN 6
+#define UBX_RXM_PMREQ_LEN 8
+
+/**
+ * @brief Navigation messages merged in the fix, bits of ubx_fix_t::epoch_mask.
+ *
+ */
+typedef enum{
+    UBX_MSG_POSLLH,
+    UBX_MSG_STATUS,
+    UBX_MSG_SOL,
+    UBX_MSG_TIMEUTC
+}ubx_msg_t;
+
+/**
+ * @brief gpsFix of NAV-STATUS.
+ *
+ */
+typedef enum{
+    UBX_FIX_NONE,
+    UBX_FIX_DR,         ///< Dead reckoning only
+    UBX_FIX_2D,
+    UBX_FIX_3D,
+    UBX_FIX_GPS_DR,     ///< GPS and dead reckoning
+    UBX_FIX_TIME        ///< Time only
+}ubx_gps_fix_t;
+
+/**
+ * @brief Fix published by the parser, the fields keep the value of the last message that had them.
+ *
+ */
+typedef struct{
+    uint32_t itow;          ///< GPS time of week of the epoch, in ms
+    int32_t lat;            ///< Latitude in microdegrees (POSLLH)
+    int32_t lon;            ///< Longitude in microdegrees (POSLLH)
+    int32_t hmsl_dm;        ///< Height above the mean sea level, in dm (POSLLH)
+    uint32_t h_acc_mm;      ///< Horizontal accuracy estimate, in mm (POSLLH)
+    uint32_t v_acc_mm;      ///< Vertical accuracy estimate, in mm (POSLLH)
+    uint32_t ttff_ms;       ///< Time to the first fix (STATUS)
+    uint32_t time_ms;       ///< UTC time of the day, in ms (TIMEUTC)
+    uint32_t date;          ///< UTC date as ddmmyy, 0 if unknown (TIMEUTC)
+    uint8_t num_sv;         ///< Satellites used in the solution (SOL)
+    uint8_t gps_fix;        ///< ubx_gps_fix_t (STATUS)
+    bool fix_ok;            ///< The fix is within the limits of the receiver (STATUS)
+    bool utc_valid;         ///< The UTC time is valid (TIMEUTC)
+    uint8_t epoch_mask;     ///< Bits (ubx_msg_t) of the messages merged in the epoch of itow
+}ubx_fix_t;
+
+/**
+ * @brief States of the parser.
+ *
+ */
+typedef enum{
+    UBX_SYNC1,
+    UBX_SYNC2,
+    UBX_CLASS,
+    UBX_ID,
+    UBX_LEN1,
+    UBX_LEN2,
+    UBX_PAYLOAD,
+    UBX_CK_A,
+    UBX_CK_B
+}ubx_state_t;
+
+/**
+ * @brief Acknowledge of the last CFG command.
+ *
+ */
+typedef enum{
+    UBX_ACK_NONE,
+    UBX_ACK_OK,
+    UBX_ACK_FAIL
+}ubx_ack_t;
+
+/**
+ * @typedef ubx_parser_t
+ *
+ * @brief State of the parser and the last fix published.
+ *
+ */
+typedef struct _ubx_parser_t{
+    uint8_t state;          ///< ubx_state_t
+    uint8_t cls;            ///< Class of the frame
+    uint8_t id;             ///< Id of the frame
+    uint16_t len;           ///< Length of the payload
+    uint16_t pos;           ///< Bytes of the payload received
+    uint8_t ck_a;           ///< Fletcher checksum
+    uint8_t ck_b;
+    uint8_t payload[UBX_MAX_PAYLOAD];
+    ubx_fix_t work;         ///< Fix being merged
+    volatile uint32_t seq;  ///< Sequence lock: odd while the fix is being published
+    ubx_fix_t fix;          ///< Last fix published
+    uint32_t frames;        ///< Navigation frames published
+    uint32_t errors;        ///< Frames discarded by the checksum
+    volatile uint8_t ack;   ///< ubx_ack_t of the last ACK frame
+    uint8_t ack_cls;        ///< Class of the command acknowledged
+    uint8_t ack_id;         ///< Id of the command acknowledged
+}ubx_parser_t;
+
+/**
+ * @brief Initialize the parser, without a fix.
+ *
+ * @param ubx
+ */
+void ubx_init(ubx_parser_t *ubx);
+
+/**
+ * @brief Feed a byte received from the GPS.
+ *
+ * @param ubx
+ * @param c
+ * @return true if the byte completes a navigation frame with a correct checksum, and a fix was published.
+ */
+bool ubx_feed(ubx_parser_t *ubx, uint8_t c);
+
+/**
+ * @brief Copy the last fix published, consistent even if the parser runs in an interrupt.
+ *
+ * @param ubx
+ * @param fix
+ * @return Number of navigation frames published, 0 if there is no fix yet.
+ */
+uint32_t ubx_read(ubx_parser_t *ubx, ubx_fix_t *fix);
+
+/**
+ * @brief Build a frame.
+ *
+ * @param buf At least len + UBX_OVERHEAD bytes.
+ * @param cls
+ * @param id
+ * @param payload
+ * @param len
+ * @return Bytes of the frame.
+ */
+uint16_t ubx_frame(uint8_t *buf, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len);
+
+#endif // __UBX_H__
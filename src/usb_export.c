@@ -0,0 +1,97 @@
+/**
+ * \file        usb_export.c
+ * \brief       Binary export of the record log over the USB CDC.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <string.h>
+#include <stddef.h>
+#include "pico/stdio_usb.h"
+#include "usb_export.h"
+#include "record.h"
+
+/**
+ * @brief Send a response, the payload goes straight from its address (the XIP flash) to the USB.
+ *
+ * @param req
+ * @param status
+ * @param payload
+ * @param len
+ */
+static void uexp_respond(const uexp_request_t *req, uexp_status_t status, const uint8_t *payload, uint16_t len)
+{
+    uexp_response_t rsp = {
+        .magic = UEXP_RSP_MAGIC,
+        .cmd = req->cmd,
+        .seq = req->seq,
+        .offset = req->offset,
+        .len = (status == UEXP_OK) ? len : 0,
+        .status = status,
+        .reserved = 0,
+    };
+    rsp.payload_crc = rec_crc16(payload, rsp.len);
+    rsp.crc = rec_crc16((const uint8_t *)&rsp, offsetof(uexp_response_t, crc));
+    stdio_usb.out_chars((const char *)&rsp, sizeof(rsp)); ///< Raw driver, no CR/LF translation
+    if (rsp.len) stdio_usb.out_chars((const char *)payload, rsp.len);
+}
+
+/**
+ * @brief Answer a complete request.
+ *
+ */
+static void uexp_handle(uexp_t *uexp, const uexp_request_t *req, flog_t *log, bool busy)
+{
+    uexp->requests++;
+    if (rec_crc16((const uint8_t *)req, offsetof(uexp_request_t, crc)) != req->crc){
+        uexp->errors++;
+        uexp_respond(req, UEXP_ERR_CRC, NULL, 0);
+        return;
+    }
+    if (busy){
+        uexp_respond(req, UEXP_ERR_BUSY, NULL, 0);
+        return;
+    }
+
+    switch (req->cmd){
+    case UEXP_CMD_INFO:{
+        uexp_info_t info = {UEXP_REGION_SIZE, FLASH_SECTOR_SIZE, FLASH_PAGE_SIZE, log->count, log->next_index};
+        uexp_respond(req, UEXP_OK, (const uint8_t *)&info, sizeof(info));
+        break;
+    }
+    case UEXP_CMD_READ:
+        if (req->len > UEXP_MAX_CHUNK || req->offset > UEXP_REGION_SIZE || req->len > UEXP_REGION_SIZE - req->offset){
+            uexp_respond(req, UEXP_ERR_RANGE, NULL, 0);
+        }else {
+            uexp_respond(req, UEXP_OK, (const uint8_t *)(XIP_BASE + FLOG_OFFSET + req->offset), req->len);
+        }
+        break;
+    default:
+        uexp_respond(req, UEXP_ERR_CMD, NULL, 0);
+        break;
+    }
+}
+
+void uexp_init(uexp_t *uexp)
+{
+    uexp->rx_len = 0;
+    uexp->requests = 0;
+    uexp->errors = 0;
+}
+
+void uexp_poll(uexp_t *uexp, flog_t *log, bool busy)
+{
+    char c;
+    while (stdio_usb.in_chars(&c, 1) == 1){
+        if (uexp->rx_len == 0 && (uint8_t)c != UEXP_REQ_MAGIC) continue; ///< Resynchronize on the magic
+        uexp->rx[uexp->rx_len++] = (uint8_t)c;
+        if (uexp->rx_len == sizeof(uexp->rx)){
+            uexp_request_t req;
+            memcpy(&req, uexp->rx, sizeof(req));
+            uexp->rx_len = 0;
+            uexp_handle(uexp, &req, log, busy);
+        }
+    }
+}
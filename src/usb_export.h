@@ -0,0 +1,122 @@
+/**
+ * \file        usb_export.h
+ * \brief       Binary export of the record log over the USB CDC.
+ * \details     The host sends requests of UEXP_REQUEST_SIZE bytes and the device answers each one
+ *              with a response header followed by its payload. A READ request gives the offset and
+ *              the length of a chunk of the log region, which is sent straight from the XIP flash
+ *              (no copies and no formatting), so a transfer can be resumed from any offset. The
+ *              headers and the payload are protected by CRC16-CCITT (rec_crc16()), and the sequence
+ *              number of the request is echoed. Bytes before the magic of a request are discarded,
+ *              and the host does the same with the text the device prints. Little endian.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __USB_EXPORT_H__
+#define __USB_EXPORT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flash_log.h"
+
+#define UEXP_REQ_MAGIC 0xA5 ///< First byte of a request
+#define UEXP_RSP_MAGIC 0x5A ///< First byte of a response
+#define UEXP_MAX_CHUNK 1024 ///< Maximum payload of a READ response
+#define UEXP_REGION_SIZE (FLOG_NUM_SECTORS*FLASH_SECTOR_SIZE) ///< Bytes of the log region
+
+/**
+ * @brief Commands of the requests.
+ *
+ */
+typedef enum{
+    UEXP_CMD_INFO = 1,  ///< Payload: uexp_info_t
+    UEXP_CMD_READ = 2   ///< Payload: len bytes of the log region from offset
+}uexp_cmd_t;
+
+/**
+ * @brief Status of the responses, the payload is empty if it is not UEXP_OK.
+ *
+ */
+typedef enum{
+    UEXP_OK = 0,
+    UEXP_ERR_CRC,       ///< The request is damaged
+    UEXP_ERR_CMD,       ///< Unknown command
+    UEXP_ERR_RANGE,     ///< The chunk is out of the region or too long
+    UEXP_ERR_BUSY       ///< A measurement is in progress, try later
+}uexp_status_t;
+
+/**
+ * @brief Request of the host.
+ *
+ */
+typedef struct __attribute__((packed)){
+    uint8_t magic;      ///< UEXP_REQ_MAGIC
+    uint8_t cmd;        ///< uexp_cmd_t
+    uint16_t seq;       ///< Sequence number, echoed in the response
+    uint32_t offset;    ///< Offset in the log region (READ)
+    uint16_t len;       ///< Bytes to read (READ)
+    uint16_t crc;       ///< CRC of the previous bytes
+}uexp_request_t;
+
+/**
+ * @brief Header of a response, followed by len bytes of payload.
+ *
+ */
+typedef struct __attribute__((packed)){
+    uint8_t magic;      ///< UEXP_RSP_MAGIC
+    uint8_t cmd;        ///< Command of the request
+    uint16_t seq;       ///< Sequence number of the request
+    uint32_t offset;    ///< Offset of the payload in the log region
+    uint16_t len;       ///< Bytes of the payload
+    uint8_t status;     ///< uexp_status_t
+    uint8_t reserved;
+    uint16_t payload_crc; ///< CRC of the payload
+    uint16_t crc;       ///< CRC of the previous bytes of the header
+}uexp_response_t;
+
+/**
+ * @brief Payload of the INFO response.
+ *
+ */
+typedef struct __attribute__((packed)){
+    uint32_t region_size;   ///< Bytes of the log region, UEXP_REGION_SIZE
+    uint16_t sector_size;   ///< Bytes of a sector
+    uint16_t page_size;     ///< Bytes of a page
+    uint32_t count;         ///< Records in the log
+    uint32_t next_index;    ///< Index of the next record
+}uexp_info_t;
+
+#define UEXP_REQUEST_SIZE sizeof(uexp_request_t)
+
+/**
+ * @typedef uexp_t
+ *
+ * @brief Receiver of the requests.
+ *
+ */
+typedef struct _uexp_t{
+    uint8_t rx[sizeof(uexp_request_t)]; ///< Bytes of the request being received
+    uint8_t rx_len;         ///< Bytes received
+    uint32_t requests;      ///< Requests answered
+    uint32_t errors;        ///< Damaged requests
+}uexp_t;
+
+/**
+ * @brief Initialize the receiver.
+ *
+ * @param uexp
+ */
+void uexp_init(uexp_t *uexp);
+
+/**
+ * @brief Read the bytes the host has sent and answer the complete requests.
+ * Call it when the USB has characters available.
+ *
+ * @param uexp
+ * @param log Log to export.
+ * @param busy A measurement is in progress, the requests are answered with UEXP_ERR_BUSY.
+ */
+void uexp_poll(uexp_t *uexp, flog_t *log, bool busy);
+
+#endif // __USB_EXPORT_H__
@@ -0,0 +1,97 @@
+/**
+ * \file        weighting.c
+ * \brief       Frequency weighting (A, C and Z) of the microphone samples.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "weighting.h"
+
+// Sections: high pass at 20.6 Hz (double), high pass at 107.7 Hz and 737.9 Hz, low pass at 12194 Hz (double)
+static const weighting_biquad_t weighting_a_48000[] = {
+    {  535652757, -1071305514,   535652757, -1070850482,   533983463},
+    {  635330812, -1270661625,   635330812, -1016763980,   480585242},
+    {  106483374,   212966748,   106483374,  -120558904,     6768130},
+};
+static const weighting_biquad_t weighting_c_48000[] = {
+    {  535652757, -1071305514,   535652757, -1070850482,   533983463},
+    {  106483374,   212966748,   106483374,  -120558904,     6768130},
+};
+static const weighting_biquad_t weighting_a_44100[] = {
+    {  535525102, -1071050204,   535525102, -1070595160,   533728859},
+    {  632300967, -1264601935,   632300967, -1011948636,   475893904},
+    {  116800876,   233601751,   116800876,   -75449735,     2650853},
+};
+static const weighting_biquad_t weighting_c_44100[] = {
+    {  535525102, -1071050204,   535525102, -1070595160,   533728859},
+    {  116800876,   233601751,   116800876,   -75449735,     2650853},
+};
+
+/**
+ * @brief Coefficient set of the curves for one sample rate.
+ * 
+ */
+typedef struct{
+    uint32_t fs;
+    const weighting_biquad_t *a;
+    const weighting_biquad_t *c;
+}weighting_table_t;
+
+static const weighting_table_t weighting_tables[] = {
+    {48000, weighting_a_48000, weighting_c_48000},
+    {44100, weighting_a_44100, weighting_c_44100},
+};
+
+bool weighting_init(weighting_t *w, weighting_curve_t curve, uint32_t fs)
+{
+    w->curve = WEIGHTING_Z;
+    w->fs = fs;
+    w->biquad = NULL;
+    w->num_sections = 0;
+    weighting_reset(w);
+    if (curve == WEIGHTING_Z) return true;
+
+    for (size_t i = 0; i < sizeof(weighting_tables)/sizeof(weighting_tables[0]); i++){
+        if (weighting_tables[i].fs == fs){
+            w->curve = curve;
+            w->biquad = (curve == WEIGHTING_A) ? weighting_tables[i].a : weighting_tables[i].c;
+            w->num_sections = (curve == WEIGHTING_A) ? 3 : 2;
+            return true;
+        }
+    }
+    return false; ///< No coefficients for this sample rate
+}
+
+void weighting_reset(weighting_t *w)
+{
+    memset(w->state, 0, sizeof(w->state));
+}
+
+void weighting_process(weighting_t *w, int32_t *x, uint32_t n)
+{
+    for (uint8_t s = 0; s < w->num_sections; s++){
+        const weighting_biquad_t *c = &w->biquad[s];
+        weighting_state_t *st = &w->state[s];
+        int32_t x1 = st->x1, x2 = st->x2, y1 = st->y1, y2 = st->y2;
+        int64_t err = st->err;
+
+        for (uint32_t i = 0; i < n; i++){
+            int32_t x0 = x[i];
+            int64_t acc = err
+                        + (int64_t)c->b0*x0 + (int64_t)c->b1*x1 + (int64_t)c->b2*x2
+                        - (int64_t)c->a1*y1 - (int64_t)c->a2*y2;
+            int32_t y0 = (int32_t)(acc >> WEIGHTING_Q);
+            err = acc - ((int64_t)y0 << WEIGHTING_Q); ///< Fed back in the next sample
+            x2 = x1; x1 = x0;
+            y2 = y1; y1 = y0;
+            x[i] = y0;
+        }
+        st->x1 = x1; st->x2 = x2; st->y1 = y1; st->y2 = y2;
+        st->err = err;
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * \file        weighting.h
+ * \brief       Frequency weighting (A, C and Z) of the microphone samples.
+ * \details     The A and C curves of IEC 61672-1 are implemented as cascaded biquads in direct 
+ *              form I, with coefficients in Q(WEIGHTING_Q) and first order error feedback to keep
+ *              the precision of the 20.6 Hz double pole. The coefficients come from the bilinear 
+ *              transform of the analog poles and each section is normalized to 0 dB at 1 kHz.
+ *              At 48 kHz and 44.1 kHz the response is inside the class 1 tolerances up to 20 kHz.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __WEIGHTING_H__
+#define __WEIGHTING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define WEIGHTING_Q 29 ///< Fractional bits of the coefficients (the A curve needs |c| > 2).
+#define WEIGHTING_MAX_SECTIONS 3 ///< Number of biquads of the A curve.
+
+/**
+ * @brief Frequency weighting curves.
+ * 
+ */
+typedef enum{
+    WEIGHTING_Z,    ///< Flat response (no filter)
+    WEIGHTING_A,    ///< A-weighting
+    WEIGHTING_C     ///< C-weighting
+}weighting_curve_t;
+
+/**
+ * @brief Coefficients of a biquad in Q(WEIGHTING_Q): y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+ * 
+ */
+typedef struct{
+    int32_t b0, b1, b2, a1, a2;
+}weighting_biquad_t;
+
+/**
+ * @brief State of a biquad in direct form I.
+ * 
+ */
+typedef struct{
+    int32_t x1, x2; ///< Last inputs
+    int32_t y1, y2; ///< Last outputs
+    int64_t err;    ///< Truncation error of the last output (error feedback)
+}weighting_state_t;
+
+/**
+ * @typedef weighting_t
+ * 
+ * @brief Structure to manage the weighting filter of a measurement.
+ * 
+ */
+typedef struct _weighting_t{
+    weighting_curve_t curve;    ///< Curve applied by the filter
+    uint32_t fs;                ///< Sample rate in Hz
+    const weighting_biquad_t *biquad; ///< Coefficients of the sections
+    uint8_t num_sections;       ///< Number of sections, 0 for the Z curve
+    weighting_state_t state[WEIGHTING_MAX_SECTIONS];
+}weighting_t;
+
+/**
+ * @brief Select the curve of the filter for the sample rate and reset its state.
+ * 
+ * @param w 
+ * @param curve Weighting curve.
+ * @param fs Sample rate in Hz, there are coefficients for 48000 Hz and 44100 Hz.
+ * @return false if there are no coefficients for the sample rate, then the Z curve is selected.
+ */
+bool weighting_init(weighting_t *w, weighting_curve_t curve, uint32_t fs);
+
+/**
+ * @brief Clear the state of the filter.
+ * 
+ * @param w 
+ */
+void weighting_reset(weighting_t *w);
+
+/**
+ * @brief Filter a block of samples in place.
+ * 
+ * @param w 
+ * @param x Samples without DC, the output has the same format.
+ * @param n Number of samples.
+ */
+void weighting_process(weighting_t *w, int32_t *x, uint32_t n);
+
+/**
+ * @brief Character to tag a level with its curve: 'A', 'C' or 'Z'.
+ * 
+ * @param curve 
+ * @return char 
+ */
+static inline char weighting_letter(weighting_curve_t curve)
+{
+    return curve == WEIGHTING_A ? 'A' : (curve == WEIGHTING_C ? 'C' : 'Z');
+}
+
+#endif // __WEIGHTING_H__
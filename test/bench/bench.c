@@ -0,0 +1,531 @@
+/**
+ * \file        bench.c
+ * \brief       Microbenchmarks of the hot kernels of the tracker, the same source on the host and on the RP2040.
+ * \details     Each kernel runs on fixed inputs, generated with the same seed on both targets, for
+ *              BENCH_RUNS runs after a warm up one. The best run of each counter is reported per
+ *              unit of work (sample, call, byte, record, frame) as one JSON document on stdout, a
+ *              kernel per line, so two revisions or the two targets compare with diff or jq:
+ *              - spl_accumulate: spl_remove_dc() and spl_add_block() over MPHONE_SIZE_BUFFER samples.
+ *              - db_energy: db_energy_cdb() over energies of the whole range.
+ *              - db_log10f: the same levels with 1000*log10f(), the floating point baseline.
+ *              - nmea_gga: nmea_feed() over a stream of GGA sentences.
+ *              - rec_encode: rec_encode() of records, each one against the previous.
+ *              - lcd_frame: the fields of the measurement screen, lcd_print() and the diff of lcd_flush().
+ *              The two level kernels also report max_err_cdb, their largest error against
+ *              1000*log10() in double over the 32-bit range of energies.
+ *
+ *              Host: ns of CLOCK_MONOTONIC, cycles and instructions of the process with
+ *              perf_event_open(); without access to the counters the cycles are the TSC on x86.
+ *              cmake -S src -B build -DTRACKER_HOST=ON -DCMAKE_BUILD_TYPE=Release && cmake --build build --target bench
+ *              ./build/host/bench > bench.json
+ *
+ *              RP2040: us of time_us_32() and cycles of SysTick on the processor clock. SysTick
+ *              has 24 bits, a run longer than 2^24 cycles (134 ms at 125 MHz) reports no cycles.
+ *              The bench target of the pico build (bench.uf2) prints the document on the USB
+ *              serial port once a terminal connects.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+
+#include "microphone.h"
+#include "spl.h"
+#include "db.h"
+#include "nmea.h"
+#include "record.h"
+#include "fmt.h"
+#include "liquid_crystal_i2c.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "pico/stdio_usb.h"
+#else
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#ifndef BENCH_REVISION
+#define BENCH_REVISION "unknown"    ///< Set by CMake from git
+#endif
+
+#define BENCH_RUNS 32               ///< Measured runs of each kernel
+#define BENCH_NONE UINT64_MAX       ///< Counter not available, null in the output
+#define BENCH_DB_VALUES 256         ///< Energies of a run of db_energy
+#define BENCH_DB_DENSE 4096         ///< Energies checked one by one, where the rounding of small values matters
+#define BENCH_DB_OCTAVE_STEPS 2048  ///< Energies checked per octave above, up to 2^32
+#define BENCH_NMEA_SENTENCES 16     ///< Sentences of a run of nmea_gga
+#define BENCH_NMEA_LINE 96          ///< Bytes of a sentence in the stream, with its CR/LF
+#define BENCH_RECORDS 64            ///< Records of a run of rec_encode
+#define BENCH_LCD_FRAMES 16         ///< Frames of a run of lcd_frame, each one with a new level
+
+// The display of the tracker (functs.c)
+#define BENCH_LCD_ADDR 0x20
+#define BENCH_LCD_SDA 14
+#define BENCH_LCD_SCL 15
+#define BENCH_LCD_EN_GPIO 12
+
+/**
+ * @brief Counters of a run.
+ *
+ */
+typedef struct{
+    uint64_t ns;            ///< Time
+    uint64_t cycles;        ///< Processor cycles, BENCH_NONE if not available
+    uint64_t instructions;  ///< Instructions retired, BENCH_NONE if not available
+}bench_count_t;
+
+// -------------------------------------------------------------
+// ---------------- Counters of each target --------------------
+// -------------------------------------------------------------
+
+#if PICO_ON_DEVICE
+
+#define BENCH_TARGET "rp2040"
+#define BENCH_SYSTICK_MAX 0x00FFFFFF
+
+typedef struct{
+    uint32_t us;
+    uint32_t systick;       ///< Counts down
+}bench_mark_t;
+
+static const char *bench_cycle_counter = "systick";
+
+static void bench_counters_init(void)
+{
+    systick_hw->csr = 0;
+    systick_hw->rvr = BENCH_SYSTICK_MAX;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_ENABLE_BITS | M0PLUS_SYST_CSR_CLKSOURCE_BITS; ///< Processor clock, no interrupt
+}
+
+static inline void bench_mark(bench_mark_t *m)
+{
+    m->systick = systick_hw->cvr;
+    m->us = time_us_32();
+}
+
+static uint32_t bench_clock_hz(void)
+{
+    return clock_get_hz(clk_sys);
+}
+
+static void bench_elapsed(const bench_mark_t *start, const bench_mark_t *end, bench_count_t *count)
+{
+    uint32_t us = end->us - start->us;
+    count->ns = (uint64_t)us*1000;
+    ///< The counter may have wrapped more than once if the run took more than its period
+    bool wrapped = (uint64_t)us*(bench_clock_hz()/1000000) >= BENCH_SYSTICK_MAX;
+    count->cycles = wrapped ? BENCH_NONE : ((start->systick - end->systick) & BENCH_SYSTICK_MAX);
+    count->instructions = BENCH_NONE;
+}
+
+#else
+
+#define BENCH_TARGET "host"
+
+typedef struct{
+    uint64_t ns;
+    uint64_t cycles;
+    uint64_t instructions;
+}bench_mark_t;
+
+static const char *bench_cycle_counter = "none";
+static int bench_perf_fd = -1;      ///< Leader of the group: cycles, then instructions
+static uint32_t bench_perf_events;  ///< Counters of the group
+
+static int bench_perf_open(uint64_t config, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+static void bench_counters_init(void)
+{
+    bench_perf_fd = bench_perf_open(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (bench_perf_fd >= 0) {
+        bench_cycle_counter = "perf";
+        bench_perf_events = 1;
+        if (bench_perf_open(PERF_COUNT_HW_INSTRUCTIONS, bench_perf_fd) >= 0) bench_perf_events = 2;
+        return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    bench_cycle_counter = "tsc";    ///< Reference cycles, at a constant rate whatever the clock of the core
+#endif
+}
+
+static inline void bench_mark(bench_mark_t *m)
+{
+    struct timespec ts;
+    m->cycles = BENCH_NONE;
+    m->instructions = BENCH_NONE;
+    if (bench_perf_fd >= 0) {
+        uint64_t group[3]; ///< Number of counters, then their values
+        if (read(bench_perf_fd, group, sizeof(group)) > 0) {
+            m->cycles = group[1];
+            if (bench_perf_events > 1) m->instructions = group[2];
+        }
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    else {
+        uint32_t lo, hi;
+        __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+        m->cycles = (uint64_t)hi << 32 | lo;
+    }
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    m->ns = (uint64_t)ts.tv_sec*1000000000u + ts.tv_nsec;
+}
+
+static uint32_t bench_clock_hz(void)
+{
+    return 0; ///< Not fixed, null in the output
+}
+
+static void bench_elapsed(const bench_mark_t *start, const bench_mark_t *end, bench_count_t *count)
+{
+    count->ns = end->ns - start->ns;
+    count->cycles = start->cycles == BENCH_NONE ? BENCH_NONE : end->cycles - start->cycles;
+    count->instructions = start->instructions == BENCH_NONE ? BENCH_NONE : end->instructions - start->instructions;
+}
+
+#endif
+
+// -------------------------------------------------------------
+// ---------------- Runner and output --------------------------
+// -------------------------------------------------------------
+
+/**
+ * @brief A kernel: its run over the inputs and the work of a run.
+ *
+ */
+typedef struct{
+    const char *name;
+    const char *unit;       ///< Unit of work of the output
+    uint32_t items;         ///< Units of a run
+    void (*run)(void);
+    uint32_t (*max_err)(void); ///< Largest error of its level in thousandths of centi-dB, NULL if not checked
+}bench_kernel_t;
+
+static uint32_t bench_seed = 1;
+
+/**
+ * @brief Pseudo-random numbers, the same sequence on every target.
+ *
+ */
+static uint32_t bench_rand(void)
+{
+    bench_seed = bench_seed*1664525u + 1013904223u;
+    return bench_seed;
+}
+
+/**
+ * @brief A counter per unit, 3 decimals.
+ *
+ */
+static void bench_print_per_unit(const char *key, uint64_t value, uint32_t items)
+{
+    char buf[FMT_MAX];
+    if (value == BENCH_NONE) {
+        printf(", \"%s\": null", key);
+        return;
+    }
+    uint64_t milli = (value*1000 + items/2)/items;
+    fmt_fixed(buf, milli > INT32_MAX ? INT32_MAX : (int32_t)milli, 3, 3, 0);
+    printf(", \"%s\": %s", key, buf);
+}
+
+/**
+ * @brief Warm up run, then the best of BENCH_RUNS runs of each counter.
+ *
+ */
+static void bench_kernel(const bench_kernel_t *kernel, bool last)
+{
+    bench_count_t best = {BENCH_NONE, BENCH_NONE, BENCH_NONE};
+    kernel->run();
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        bench_mark_t start, end;
+        bench_count_t count;
+        bench_mark(&start);
+        kernel->run();
+        bench_mark(&end);
+        bench_elapsed(&start, &end, &count);
+        if (count.ns < best.ns) best.ns = count.ns;
+        if (count.cycles < best.cycles) best.cycles = count.cycles;
+        if (count.instructions < best.instructions) best.instructions = count.instructions;
+    }
+    printf("    {\"name\": \"%s\", \"unit\": \"%s\", \"items\": %lu, \"runs\": %d",
+           kernel->name, kernel->unit, (unsigned long)kernel->items, BENCH_RUNS);
+    bench_print_per_unit("ns_per_unit", best.ns, kernel->items);
+    bench_print_per_unit("cycles_per_unit", best.cycles, kernel->items);
+    bench_print_per_unit("instructions_per_unit", best.instructions, kernel->items);
+    if (kernel->max_err) {
+        char buf[FMT_MAX];
+        fmt_fixed(buf, (int32_t)kernel->max_err(), 3, 3, 0);
+        printf(", \"max_err_cdb\": %s", buf);
+    }
+    printf("}%s\n", last ? "" : ",");
+}
+
+// -------------------------------------------------------------
+// ---------------- Kernels ------------------------------------
+// -------------------------------------------------------------
+
+///< spl_accumulate: the ADC buffer, in blocks as the DMA delivers them
+static uint16_t bench_raw[MPHONE_SIZE_BUFFER];
+static int32_t bench_ac[MPHONE_BLOCK_SIZE];
+static spl_meter_t bench_meter;
+
+static void bench_spl_setup(void)
+{
+    for (uint32_t i = 0; i < MPHONE_SIZE_BUFFER; i++) {
+        int32_t tone = (i & 16) ? 300 : -300; ///< A square wave over the bias and the noise
+        bench_raw[i] = (uint16_t)(2048 + tone + (int32_t)(bench_rand() >> 24) - 128);
+    }
+    spl_reset_dc(&bench_meter);
+}
+
+static void bench_spl_run(void)
+{
+    spl_start(&bench_meter, 0);
+    for (uint32_t i = 0; i < MPHONE_SIZE_BUFFER; i += MPHONE_BLOCK_SIZE) {
+        spl_remove_dc(&bench_meter, &bench_raw[i], bench_ac, MPHONE_BLOCK_SIZE);
+        spl_add_block(&bench_meter, bench_ac, MPHONE_BLOCK_SIZE);
+    }
+}
+
+///< db_energy: energies of every magnitude, as the windows and the percentiles see them
+static uint64_t bench_energy[BENCH_DB_VALUES];
+static volatile int32_t bench_db_sink;
+
+static void bench_db_setup(void)
+{
+    for (int i = 0; i < BENCH_DB_VALUES; i++) {
+        uint64_t e = (uint64_t)bench_rand() << 32 | bench_rand();
+        bench_energy[i] = e >> (i % 64);
+    }
+}
+
+static void bench_db_run(void)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_DB_VALUES; i++) sum += db_energy_cdb(bench_energy[i]);
+    bench_db_sink = sum;
+}
+
+/**
+ * @brief The level in floating point, as the tracker would compute it without db.c.
+ *
+ */
+static int32_t bench_log10f_cdb(uint64_t e)
+{
+    if (e == 0) return DB_FLOOR_CDB;
+    return (int32_t)(1000.0f*log10f((float)e) + 0.5f);
+}
+
+static void bench_log10f_run(void)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < BENCH_DB_VALUES; i++) sum += bench_log10f_cdb(bench_energy[i]);
+    bench_db_sink = sum;
+}
+
+/**
+ * @brief Largest error of a level against 1000*log10() in double, in thousandths of centi-dB:
+ * every energy below BENCH_DB_DENSE, then BENCH_DB_OCTAVE_STEPS energies per octave up to 2^32 - 1.
+ *
+ */
+static uint32_t bench_level_max_err(int32_t (*level)(uint64_t))
+{
+    double worst = 0;
+    for (uint64_t e = 1; e < 0x100000000ull; ) {
+        double err = fabs(level(e) - 1000*log10((double)e));
+        if (err > worst) worst = err;
+        if (e < BENCH_DB_DENSE) e++;
+        else if (e == 0xFFFFFFFFull) break;
+        else {
+            uint64_t step = e/BENCH_DB_OCTAVE_STEPS;
+            e = (e + step > 0xFFFFFFFFull) ? 0xFFFFFFFFull : e + step;
+        }
+    }
+    return (uint32_t)(worst*1000 + 0.5);
+}
+
+static uint32_t bench_db_max_err(void)
+{
+    return bench_level_max_err(db_energy_cdb);
+}
+
+static uint32_t bench_log10f_max_err(void)
+{
+    return bench_level_max_err(bench_log10f_cdb);
+}
+
+///< nmea_gga: the sentences the GPS sends each second, with their checksum
+static char bench_stream[BENCH_NMEA_SENTENCES*BENCH_NMEA_LINE];
+static uint32_t bench_stream_len;
+static nmea_parser_t bench_nmea;
+
+static void bench_nmea_setup(void)
+{
+    char *line = bench_stream;
+    for (int i = 0; i < BENCH_NMEA_SENTENCES; i++) {
+        unsigned lat_min = bench_rand() % (90*600000);     ///< Minutes x10^4
+        unsigned lon_min = bench_rand() % (180*600000);
+        int len = sprintf(line, "$GPGGA,%02u%02u%02u.000,%02u%02u.%04u,%c,%03u%02u.%04u,%c,1,%02u,1.%02u,%u.%u,M,-34.2,M,,",
+                          12u, (unsigned)i, 0u, lat_min/600000, lat_min/10000 % 60, lat_min % 10000, (i & 1) ? 'N' : 'S',
+                          lon_min/600000, lon_min/10000 % 60, lon_min % 10000, (i & 2) ? 'E' : 'W',
+                          4 + (unsigned)(bench_rand() % 8), (unsigned)(bench_rand() % 100),
+                          (unsigned)(bench_rand() % 3000), (unsigned)(bench_rand() % 10));
+        uint8_t cs = 0;
+        for (int j = 1; j < len; j++) cs ^= (uint8_t)line[j];
+        len += sprintf(line + len, "*%02X\r\n", cs);
+        line += len;
+    }
+    bench_stream_len = line - bench_stream;
+}
+
+static void bench_nmea_run(void)
+{
+    nmea_init(&bench_nmea);
+    for (uint32_t i = 0; i < bench_stream_len; i++) nmea_feed(&bench_nmea, bench_stream[i]);
+}
+
+///< rec_encode: records of a session, each one a delta of the previous
+static rec_t bench_records[BENCH_RECORDS];
+static uint8_t bench_rec_buf[REC_MAX_SIZE];
+static volatile size_t bench_rec_sink;
+
+static void bench_rec_setup(void)
+{
+    int32_t lat = 40416775, lon = -3703790;
+    uint32_t time = 829958400;
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        rec_t *rec = &bench_records[i];
+        memset(rec, 0, sizeof(*rec));
+        lat += (int32_t)(bench_rand() % 2001) - 1000;
+        lon += (int32_t)(bench_rand() % 2001) - 1000;
+        time += 60 + bench_rand() % 600;
+        rec->flags = REC_F_STATS | REC_F_TW | ((i % 8) ? 0 : REC_F_ABS | REC_F_GPS);
+        rec->leq = (int16_t)(4000 + bench_rand() % 5000);
+        rec->lat = lat;
+        rec->lon = lon;
+        rec->time = time;
+        rec->duration = 30;
+        rec->levels.l5 = rec->leq + 600;
+        rec->levels.l10 = rec->leq + 400;
+        rec->levels.l50 = rec->leq;
+        rec->levels.l90 = rec->leq - 500;
+        rec->levels.l95 = rec->leq - 700;
+        rec->levels.lmax = rec->leq + 900;
+        rec->levels.lmin = rec->leq - 900;
+        rec->levels.lpeak = rec->leq + 2000;
+        for (int j = 0; j < REC_NUM_TW; j++) rec->tw_max[j] = rec->leq + 500 + 100*j;
+        rec->ttff_ms = 1000 + bench_rand() % 30000;
+        rec->gps_start = i & 1;
+    }
+}
+
+static void bench_rec_run(void)
+{
+    size_t len = 0;
+    for (int i = 0; i < BENCH_RECORDS; i++) {
+        len += rec_encode(&bench_records[i], i ? &bench_records[i - 1] : NULL, bench_rec_buf);
+    }
+    bench_rec_sink = len;
+}
+
+///< lcd_frame: the measurement screen of service_lcd() with a new level each frame
+static lcd_t bench_lcd;
+static int32_t bench_levels[BENCH_LCD_FRAMES];
+
+static void bench_lcd_setup(void)
+{
+    lcd_init(&bench_lcd, BENCH_LCD_ADDR, i2c1, 16, 2, 100, BENCH_LCD_SDA, BENCH_LCD_SCL, BENCH_LCD_EN_GPIO);
+    bench_lcd.en = true; ///< Without the initialization sequence: nothing is shown
+    ///< The transfers are started but never paced by the I2C: the bench measures the rendering, not the bus
+    i2c_get_hw(bench_lcd.i2c)->dma_cr = 0;
+    for (int i = 0; i < BENCH_LCD_FRAMES; i++) bench_levels[i] = -(int32_t)(3000 + bench_rand() % 6000);
+}
+
+static void bench_lcd_run(void)
+{
+    char str[FMT_MAX];
+    for (int i = 0; i < BENCH_LCD_FRAMES; i++) {
+        str[0] = 'L';
+        str[1] = 'A';
+        str[2] = 'F';
+        fmt_fixed(&str[3], bench_levels[i], 2, 1, 7);
+        lcd_print(&bench_lcd, str, 0, 0);
+        lcd_print(&bench_lcd, " dB", 0, 10);
+        lcd_print(&bench_lcd, "Y:", 1, 0);
+        fmt_fixed(str, -3703790 - i, 6, 6, 11);
+        lcd_print(&bench_lcd, str, 1, 2);
+        fmt_uint(str, 1, 1, ' ');
+        lcd_print(&bench_lcd, str, 0, 15);
+        fmt_uint(str, 8, 2, ' ');
+        lcd_print(&bench_lcd, str, 1, 14);
+        lcd_flush(&bench_lcd);
+        dma_channel_abort(bench_lcd.dma_chan);
+    }
+}
+
+int main(void)
+{
+    stdio_init_all();
+#if PICO_ON_DEVICE
+    while (!stdio_usb_connected()) sleep_ms(100);
+#endif
+    bench_counters_init();
+    bench_spl_setup();
+    bench_db_setup();
+    bench_nmea_setup();
+    bench_rec_setup();
+    bench_lcd_setup();
+
+    const bench_kernel_t kernels[] = {
+        {"spl_accumulate", "sample", MPHONE_SIZE_BUFFER, bench_spl_run, NULL},
+        {"db_energy", "call", BENCH_DB_VALUES, bench_db_run, bench_db_max_err},
+        {"db_log10f", "call", BENCH_DB_VALUES, bench_log10f_run, bench_log10f_max_err},
+        {"nmea_gga", "byte", bench_stream_len, bench_nmea_run, NULL},
+        {"rec_encode", "record", BENCH_RECORDS, bench_rec_run, NULL},
+        {"lcd_frame", "frame", BENCH_LCD_FRAMES, bench_lcd_run, NULL},
+    };
+    printf("{\"target\": \"%s\", \"revision\": \"%s\", \"cycle_counter\": \"%s\", \"clock_hz\": ",
+           BENCH_TARGET, BENCH_REVISION, bench_cycle_counter);
+    if (bench_clock_hz()) printf("%lu", (unsigned long)bench_clock_hz());
+    else printf("null");
+    printf(", \"kernels\": [\n");
+    for (uint32_t i = 0; i < count_of(kernels); i++) bench_kernel(&kernels[i], i == count_of(kernels) - 1);
+    printf("]}\n");
+
+    ///< The inputs were decoded: a kernel that skips its work is not measured
+    nmea_fix_t fix;
+    if (nmea_read(&bench_nmea, &fix) != BENCH_NMEA_SENTENCES) {
+        fprintf(stderr, "nmea_gga: %lu sentences of %d\n", (unsigned long)nmea_read(&bench_nmea, &fix), BENCH_NMEA_SENTENCES);
+        return 1;
+    }
+    stdio_flush();
+#if PICO_ON_DEVICE
+    while (true) __wfi();
+#endif
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * \file        decimator_test.c
+ * \brief       Host check of the CIC+FIR decimator: passband, rejection of the aliases and throughput.
+ * \details     Tones go through decim_process() in blocks of the microphone at 48 kHz and the
+ *              output (6 kHz) is measured on whole periods after the transient, as the amplitude
+ *              of the bin of the tone or of its alias. Checked against decimator.h:
+ *              - passband: every tone up to DECIM_PASS_HZ within +TEST_PASS_UP_DB/-TEST_PASS_DOWN_DB,
+ *              - aliasing: every tone above the output Nyquist rate that folds into the passband is
+ *                attenuated at least TEST_ALIAS_DB with respect to the gain at 1 kHz.
+ *              Then reports cycles (or ns without a cycle counter) per input sample.
+ *              The exit status is the number of tones out of tolerance.
+ *
+ *              gcc -O2 -Wall -I../../src -o decimator_test decimator_test.c ../../src/decimator.c -lm
+ *              ./decimator_test
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include "decimator.h"
+
+#define TEST_FS 48000           ///< Sample rate of the microphone
+#define TEST_FS_OUT (TEST_FS/DECIM_FACTOR)
+#define TEST_BLOCK 600          ///< MPHONE_BLOCK_SIZE: the decimator runs on the blocks of the DMA
+#define TEST_AMPLITUDE 30000.0  ///< Q(SPL_AC_Q) codes, below the saturation of spl_remove_dc()
+#define TEST_SETTLE 200         ///< Output samples of the transient, not measured
+#define TEST_MEASURE 6000       ///< Output samples measured, at least (1 s)
+#define TEST_STEP_HZ 50         ///< Spacing of the tones
+#define TEST_PASS_UP_DB 0.5     ///< Ripple allowed above 0 dB in the passband
+#define TEST_PASS_DOWN_DB 2.3   ///< Droop allowed at the edge of the passband, -2.2 dB in decimator.h
+#define TEST_ALIAS_DB 40.0      ///< Minimum rejection of the aliases into the passband (decimator.h)
+#define TEST_BENCH_S 4          ///< Samples of noise of the throughput, in seconds
+
+#define DECIM_PASS_HZ 2000      ///< Passband of decimator.h
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return (uint64_t)hi << 32 | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000u + ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Frequency of a tone at the output rate, folded into 0..TEST_FS_OUT/2.
+ *
+ */
+static double alias_hz(double f)
+{
+    double a = fmod(f, TEST_FS_OUT);
+    return (a > TEST_FS_OUT/2) ? TEST_FS_OUT - a : a;
+}
+
+/**
+ * @brief Gain of the decimator for a tone, at the frequency it has at the output, in dB.
+ *
+ */
+static double measure_db(double f)
+{
+    decim_t d;
+    decim_reset(&d);
+    double fo = alias_hz(f);
+    uint32_t measure = TEST_MEASURE;
+    if (fo > 0) measure = (uint32_t)lround(ceil(TEST_MEASURE*fo/TEST_FS_OUT)*TEST_FS_OUT/fo); ///< Whole periods
+    int32_t block[TEST_BLOCK], out[TEST_BLOCK/DECIM_FACTOR + 1];
+    double re = 0, im = 0;
+    uint32_t n_out = 0;
+    for (uint32_t start = 0; n_out < TEST_SETTLE + measure; start += TEST_BLOCK){
+        for (uint32_t i = 0; i < TEST_BLOCK; i++) block[i] = (int32_t)lround(TEST_AMPLITUDE*sin(2*M_PI*f*(start + i)/TEST_FS));
+        uint32_t count = decim_process(&d, block, TEST_BLOCK, out);
+        for (uint32_t i = 0; i < count; i++, n_out++){
+            if (n_out < TEST_SETTLE || n_out >= TEST_SETTLE + measure) continue;
+            re += out[i]*cos(2*M_PI*fo*n_out/TEST_FS_OUT);
+            im += out[i]*sin(2*M_PI*fo*n_out/TEST_FS_OUT);
+        }
+    }
+    return 20*log10(2*sqrt(re*re + im*im)/measure/TEST_AMPLITUDE);
+}
+
+/**
+ * @brief Passband: tones from TEST_STEP_HZ to DECIM_PASS_HZ.
+ *
+ * @return Tones out of tolerance.
+ */
+static int check_passband(void)
+{
+    int failures = 0;
+    double lo = INFINITY, hi = -INFINITY;
+    for (double f = TEST_STEP_HZ; f <= DECIM_PASS_HZ; f += TEST_STEP_HZ){
+        double g = measure_db(f);
+        bool ok = g <= TEST_PASS_UP_DB && g >= -TEST_PASS_DOWN_DB;
+        if (!ok){
+            failures++;
+            printf("  %6.0f Hz gain %+6.2f dB FAIL\n", f, g);
+        }
+        if (g < lo) lo = g;
+        if (g > hi) hi = g;
+    }
+    printf("Passband up to %d Hz: gain from %+.2f to %+.2f dB, limits +%.1f/-%.1f, %d out of tolerance\n",
+            DECIM_PASS_HZ, lo, hi, TEST_PASS_UP_DB, TEST_PASS_DOWN_DB, failures);
+    return failures;
+}
+
+/**
+ * @brief Aliasing: tones above TEST_FS_OUT/2 that fold into the passband, up to the input Nyquist rate.
+ *
+ * @return Tones out of tolerance.
+ */
+static int check_aliases(void)
+{
+    int failures = 0;
+    double ref = measure_db(1000);
+    double worst = INFINITY, worst_f = 0;
+    for (double f = TEST_FS_OUT/2 + TEST_STEP_HZ; f < TEST_FS/2; f += TEST_STEP_HZ){
+        if (alias_hz(f) > DECIM_PASS_HZ) continue;
+        double rejection = ref - measure_db(f);
+        if (rejection < TEST_ALIAS_DB){
+            failures++;
+            printf("  %6.0f Hz into %4.0f Hz rejection %5.1f dB FAIL\n", f, alias_hz(f), rejection);
+        }
+        if (rejection < worst){
+            worst = rejection;
+            worst_f = f;
+        }
+    }
+    printf("Aliases into the passband: worst rejection %.1f dB at %.0f Hz, limit %.0f dB, %d out of tolerance\n",
+            worst, worst_f, TEST_ALIAS_DB, failures);
+    return failures;
+}
+
+/**
+ * @brief Cycles per input sample of the decimator on noise, in the blocks of the microphone.
+ *
+ */
+static double bench(void)
+{
+    static int32_t noise[TEST_BLOCK], out[TEST_BLOCK/DECIM_FACTOR + 1];
+    decim_t d;
+    decim_reset(&d);
+    srand(1);
+    for (int i = 0; i < TEST_BLOCK; i++) noise[i] = rand() % 20001 - 10000;
+    uint32_t blocks = TEST_BENCH_S*TEST_FS/TEST_BLOCK;
+    uint64_t total = 0;
+    for (uint32_t b = 0; b < blocks; b++){
+        uint64_t c0 = cycles();
+        decim_process(&d, noise, TEST_BLOCK, out);
+        total += cycles() - c0;
+    }
+    return (double)total/((uint64_t)blocks*TEST_BLOCK);
+}
+
+int main(void)
+{
+    int failures = check_passband();
+    failures += check_aliases();
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char *unit = "cycles/sample";
+#else
+    const char *unit = "ns/sample";
+#endif
+    printf("Decimation by %d at %d Hz: %.2f %s\n", DECIM_FACTOR, TEST_FS, bench(), unit);
+    printf("%d tones out of tolerance\n", failures);
+    return failures;
+}
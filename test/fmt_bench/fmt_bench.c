@@ -0,0 +1,140 @@
+/**
+ * \file        fmt_bench.c
+ * \brief       Host check and benchmark of the fixed width formatting against snprintf.
+ * \details     Formats random microdegrees, centi-dB, integers and time stamps with fmt.c and with
+ *              the equivalent snprintf formats, compares the strings, checks that no field is
+ *              wider than asked, and reports cycles (or ns without a cycle counter) per call of
+ *              each one. The flash saved on the RP2040 is the float support of printf, see the
+ *              memory usage printed by the link of the tracker.
+ *
+ *              gcc -O2 -I../../src -o fmt_bench fmt_bench.c ../../src/fmt.c
+ *              ./fmt_bench [values]
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "fmt.h"
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return (uint64_t)hi << 32 | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000u + ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Reference: the formats the tracker used with sprintf, in fixed width fields.
+ *
+ */
+static int ref_fixed(char *buf, int32_t value, uint32_t scale, uint32_t shown_div, int decimals, int width)
+{
+    uint32_t abs_value = value < 0 ? -(uint32_t)value : (uint32_t)value;
+    char tmp[32];
+    int n = decimals ? snprintf(tmp, sizeof(tmp), "%s%lu.%0*lu", value < 0 ? "-" : "", (unsigned long)(abs_value/scale),
+                                decimals, (unsigned long)(abs_value % scale/shown_div))
+                     : snprintf(tmp, sizeof(tmp), "%s%lu", value < 0 ? "-" : "", (unsigned long)(abs_value/scale));
+    if (width && n > width){
+        memset(buf, '*', width);
+        buf[width] = '\0';
+        return width;
+    }
+    return snprintf(buf, FMT_MAX, "%*s", width, tmp);
+}
+
+static int32_t rand32(void)
+{
+    return (int32_t)((uint32_t)rand() << 16 ^ (uint32_t)rand());
+}
+
+int main(int argc, char *argv[])
+{
+    int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int32_t *values = malloc(n*sizeof(int32_t));
+    srand(1);
+    for (int i = 0; i < n; i++){
+        switch (i % 4){ ///< Longitudes, levels, any integer, small integers
+        case 0: values[i] = rand32() % 180000001; break;
+        case 1: values[i] = rand32() % 20000; break;
+        case 2: values[i] = rand32(); break;
+        default: values[i] = rand32() % 1000; break;
+        }
+    }
+
+    ///< Correctness against snprintf, and the width of the fields
+    static const struct{ uint8_t frac, shown, width; }cases[] = {
+        {6, 6, 11}, {2, 1, 6}, {2, 2, 0}, {0, 0, 2}, {0, 0, 11}, {3, 1, 4}, {9, 9, 0},
+    };
+    int errors = 0;
+    char a[FMT_MAX], b[FMT_MAX];
+    for (int i = 0; i < n; i++){
+        for (size_t c = 0; c < sizeof(cases)/sizeof(cases[0]); c++){
+            uint32_t scale = 1, div = 1;
+            for (int k = 0; k < cases[c].frac; k++) scale *= 10;
+            for (int k = cases[c].shown; k < cases[c].frac; k++) div *= 10;
+            int la = fmt_fixed(a, values[i], cases[c].frac, cases[c].shown, cases[c].width);
+            int lb = ref_fixed(b, values[i], scale, div, cases[c].shown, cases[c].width);
+            if (la != lb || strcmp(a, b) || (cases[c].width && la != cases[c].width)){
+                if (errors++ < 5) printf("fmt_fixed(%ld, %u, %u, %u): \"%s\" != \"%s\"\n", (long)values[i],
+                                         cases[c].frac, cases[c].shown, cases[c].width, a, b);
+            }
+        }
+        fmt_int(a, values[i], 0);
+        snprintf(b, sizeof(b), "%ld", (long)values[i]);
+        if (strcmp(a, b)) errors++;
+        fmt_uint(a, (uint32_t)values[i], 12, '0');
+        snprintf(b, sizeof(b), "%012lu", (unsigned long)(uint32_t)values[i]);
+        if (strcmp(a, b)) errors++;
+        uint32_t t = (uint32_t)values[i];
+        fmt_time(a, t);
+        snprintf(b, sizeof(b), "%02lu:%02lu:%02lu", (unsigned long)(t % 86400/3600), (unsigned long)(t % 86400/60 % 60),
+                 (unsigned long)(t % 60));
+        if (strcmp(a, b)) errors++;
+    }
+    printf("fmt: %d mismatches with snprintf\n", errors);
+
+    ///< Throughput: a coordinate of the LCD (fixed width microdegrees)
+    volatile char sink = 0;
+    uint64_t c0 = cycles();
+    for (int i = 0; i < n; i++){
+        fmt_fixed(a, values[i], 6, 6, 11);
+        sink ^= a[0];
+    }
+    uint64_t c_fmt = cycles() - c0;
+    c0 = cycles();
+    for (int i = 0; i < n; i++){
+        uint32_t abs_value = values[i] < 0 ? -(uint32_t)values[i] : (uint32_t)values[i];
+        snprintf(a, sizeof(a), "%c%lu.%06lu", values[i] < 0 ? '-' : ' ', (unsigned long)(abs_value/1000000),
+                 (unsigned long)(abs_value % 1000000));
+        sink ^= a[0];
+    }
+    uint64_t c_int = cycles() - c0;
+    c0 = cycles();
+    for (int i = 0; i < n; i++){
+        snprintf(a, sizeof(a), "%11.6f", values[i]*1e-6);
+        sink ^= a[0];
+    }
+    uint64_t c_float = cycles() - c0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char *unit = "cycles/call";
+#else
+    const char *unit = "ns/call";
+#endif
+    printf("fmt_fixed:          %7.1f %s\n", (double)c_fmt/n, unit);
+    printf("snprintf %%lu.%%06lu: %7.1f %s\n", (double)c_int/n, unit);
+    printf("snprintf %%11.6f:    %7.1f %s\n", (double)c_float/n, unit);
+    free(values);
+    return errors != 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * \file        ubx_check.c
+ * \brief       Host check of the UBX parser of the tracker against the frames of ubx_sim.py.
+ * \details     Feeds a file written by ubx_sim.py --file to ubx_feed() byte by byte and, at the end
+ *              of each navigation epoch (NAV-POSLLH, NAV-STATUS, NAV-SOL and NAV-TIMEUTC merged),
+ *              compares the published fix with the values given to the generator: position,
+ *              UTC time and date (one epoch per second from --utc), fix and satellites used.
+ *              The exit status is the number of epochs that differ, or 1 without any epoch.
+ *
+ *              python3 ubx_sim.py --file epochs.bin --epochs 10 --lat 40.4168 --lon -3.7038 \
+ *                  --sv 9 --utc 2026-10-17T07:48:14
+ *              gcc -O2 -I../../src -o ubx_check ubx_check.c ../../src/ubx.c -lm
+ *              ./ubx_check epochs.bin 40.4168 -3.7038 9 2026-10-17T07:48:14
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#define _DEFAULT_SOURCE ///< timegm()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "ubx.h"
+
+#define CHECK_EPOCH_MASK ((1u << UBX_MSG_POSLLH) | (1u << UBX_MSG_STATUS) | (1u << UBX_MSG_SOL) | (1u << UBX_MSG_TIMEUTC))
+
+/**
+ * @brief Degrees to microdegrees as the generator (x10^7, rounded) and the parser (to 10^6, rounded) do.
+ *
+ */
+static int32_t check_microdeg(double deg)
+{
+    long long v = llround(deg*1e7);
+    return (int32_t)((v >= 0) ? (v + 5)/10 : (v - 5)/10);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 6){
+        fprintf(stderr, "usage: %s epochs.bin lat lon sv YYYY-MM-DDTHH:MM:SS\n", argv[0]);
+        return 2;
+    }
+    FILE *f = fopen(argv[1], "rb");
+    if (!f){
+        perror(argv[1]);
+        return 2;
+    }
+    int32_t lat = check_microdeg(atof(argv[2]));
+    int32_t lon = check_microdeg(atof(argv[3]));
+    uint8_t sv = (uint8_t)atoi(argv[4]);
+    struct tm tm = {0};
+    if (sscanf(argv[5], "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6){
+        fprintf(stderr, "%s: not YYYY-MM-DDTHH:MM:SS\n", argv[5]);
+        return 2;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon--;
+    time_t start = timegm(&tm);
+
+    ubx_parser_t ubx;
+    ubx_init(&ubx);
+    uint32_t epochs = 0, failures = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF){
+        ubx_fix_t fix;
+        if (!ubx_feed(&ubx, (uint8_t)c)) continue;
+        ubx_read(&ubx, &fix);
+        if (fix.epoch_mask != CHECK_EPOCH_MASK) continue; ///< The epoch is not complete yet
+
+        time_t t = start + epochs;
+        struct tm *utc = gmtime(&t);
+        uint32_t time_ms = (utc->tm_hour*3600u + utc->tm_min*60u + utc->tm_sec)*1000u;
+        uint32_t date = utc->tm_mday*10000u + (utc->tm_mon + 1)*100u + utc->tm_year % 100;
+        bool ok = fix.lat == lat && fix.lon == lon && fix.utc_valid && fix.time_ms == time_ms && fix.date == date
+                  && fix.num_sv == sv && fix.gps_fix == UBX_FIX_3D && fix.fix_ok;
+        printf("epoch %lu: lat %ld lon %ld time %lu ms date %06lu sv %u fix %u%s\n", (unsigned long)epochs,
+               (long)fix.lat, (long)fix.lon, (unsigned long)fix.time_ms, (unsigned long)fix.date, fix.num_sv, fix.gps_fix,
+               ok ? "" : " FAIL");
+        if (!ok){
+            printf("  expected lat %ld lon %ld time %lu ms date %06lu sv %u fix %u\n", (long)lat, (long)lon,
+                   (unsigned long)time_ms, (unsigned long)date, sv, UBX_FIX_3D);
+            failures++;
+        }
+        epochs++;
+    }
+    fclose(f);
+    printf("%lu epochs, %lu differ, %lu frames with a wrong checksum\n", (unsigned long)epochs,
+           (unsigned long)failures, (unsigned long)ubx.errors);
+    if (!epochs) return 1;
+    return (int)failures;
+}
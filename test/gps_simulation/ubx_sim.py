@@ -0,0 +1,114 @@
+import argparse
+import struct
+import time
+from datetime import datetime, timezone
+
+UBX_SYNC = b'\xb5\x62'
+UBX_CLASS_NAV = 0x01
+UBX_NAV_POSLLH = 0x02
+UBX_NAV_STATUS = 0x03
+UBX_NAV_SOL = 0x06
+UBX_NAV_TIMEUTC = 0x21
+
+def calculate_checksum(data):
+    """
+    Calcula el checksum Fletcher de 8 bits de UBX (clase, id, longitud y payload).
+    """
+    ck_a = 0
+    ck_b = 0
+    for byte in data:
+        ck_a = (ck_a + byte) & 0xFF
+        ck_b = (ck_b + ck_a) & 0xFF
+    return bytes([ck_a, ck_b])
+
+def get_ubx_frame(msg_class, msg_id, payload):
+    """
+    Genera una trama UBX: sincronismo, clase, id, longitud, payload y checksum.
+    """
+    body = struct.pack('<BBH', msg_class, msg_id, len(payload)) + payload
+    return UBX_SYNC + body + calculate_checksum(body)
+
+def get_nav_posllh(itow, latitude, longitude, height_msl=545.4, h_acc=2.5, v_acc=4.0):
+    """
+    Genera una trama NAV-POSLLH con la latitud y longitud en grados y las alturas y precisiones en metros.
+    """
+    payload = struct.pack('<IiiiiII', itow, round(longitude * 1e7), round(latitude * 1e7),
+                          round((height_msl + 46.9) * 1000), round(height_msl * 1000),
+                          round(h_acc * 1000), round(v_acc * 1000))
+    return get_ubx_frame(UBX_CLASS_NAV, UBX_NAV_POSLLH, payload)
+
+def get_nav_status(itow, gps_fix=3, fix_ok=True, ttff_ms=28000, msss=60000):
+    """
+    Genera una trama NAV-STATUS (gpsFix: 0 sin fix, 2 2D, 3 3D).
+    """
+    flags = 0x01 if fix_ok else 0x00
+    payload = struct.pack('<IBBBBII', itow, gps_fix, flags, 0, 0, ttff_ms, msss)
+    return get_ubx_frame(UBX_CLASS_NAV, UBX_NAV_STATUS, payload)
+
+def get_nav_sol(itow, gps_fix=3, num_sv=8):
+    """
+    Genera una trama NAV-SOL con el tipo de fix y los satélites usados (sin la posición ECEF).
+    """
+    flags = 0x0D if gps_fix >= 2 else 0x0C
+    payload = struct.pack('<IiHBBiiiIiiiIHBBI', itow, 0, 0, gps_fix, flags, 0, 0, 0, 2500, 0, 0, 0, 100,
+                          150, 0, num_sv, 0)
+    return get_ubx_frame(UBX_CLASS_NAV, UBX_NAV_SOL, payload)
+
+def get_nav_timeutc(itow, utc):
+    """
+    Genera una trama NAV-TIMEUTC con la fecha y hora UTC (validTOW, validWKN y validUTC).
+    """
+    payload = struct.pack('<IIiHBBBBBB', itow, 50, utc.microsecond * 1000, utc.year, utc.month,
+                          utc.day, utc.hour, utc.minute, utc.second, 0x07)
+    return get_ubx_frame(UBX_CLASS_NAV, UBX_NAV_TIMEUTC, payload)
+
+def get_epoch(latitude, longitude, utc, gps_fix=3, num_sv=8):
+    """
+    Genera las cuatro tramas de una época de navegación, con el mismo iTOW.
+    """
+    itow = ((utc.weekday() + 1) % 7 * 86400 + utc.hour * 3600 + utc.minute * 60 + utc.second) * 1000 + utc.microsecond // 1000
+    return (get_nav_posllh(itow, latitude, longitude) + get_nav_status(itow, gps_fix, gps_fix >= 2) +
+            get_nav_sol(itow, gps_fix, num_sv) + get_nav_timeutc(itow, utc))
+
+def main():
+    parser = argparse.ArgumentParser(description='Simulador de un receptor u-blox con salida UBX')
+    parser.add_argument('--port', default='/dev/serial0', help='Puerto serie hacia el tracker')
+    parser.add_argument('--baudrate', type=int, default=9600)
+    parser.add_argument('--file', help='Escribe las tramas en un fichero en lugar del puerto serie')
+    parser.add_argument('--epochs', type=int, default=10, help='Épocas escritas en el fichero')
+    parser.add_argument('--lat', type=float, default=37.7749)
+    parser.add_argument('--lon', type=float, default=-122.4194)
+    parser.add_argument('--sv', type=int, default=8, help='Satélites usados')
+    parser.add_argument('--utc', help='Hora UTC de la primera época del fichero, AAAA-MM-DDTHH:MM:SS (ahora por defecto)')
+    args = parser.parse_args()
+
+    if args.file:
+        # Tramas para las pruebas en el host, una época por segundo desde ahora o desde --utc
+        if args.utc:
+            utc = datetime.fromisoformat(args.utc).replace(tzinfo=timezone.utc)
+        else:
+            utc = datetime.now(timezone.utc).replace(microsecond=0)
+        with open(args.file, 'wb') as f:
+            for i in range(args.epochs):
+                f.write(get_epoch(args.lat, args.lon, utc.fromtimestamp(utc.timestamp() + i, timezone.utc),
+                                  num_sv=args.sv))
+        return
+
+    import serial
+    serial_port = serial.Serial(
+        port=args.port,
+        baudrate=args.baudrate,
+        timeout=1
+    )
+
+    try:
+        while True:
+            serial_port.write(get_epoch(args.lat, args.lon, datetime.now(timezone.utc), num_sv=args.sv))
+            time.sleep(1)
+    except KeyboardInterrupt:
+        print("Detenido por el usuario")
+    finally:
+        serial_port.close()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,226 @@
+/**
+ * \file        nmea_bench.c
+ * \brief       Host benchmark of the NMEA parser of the tracker against the previous strtok parser.
+ * \details     Generates a stream of GGA and RMC sentences with random positions, feeds it to
+ *              nmea_feed() byte by byte and to a copy of the previous gps_get_GPGGA() (buffered
+ *              line, strtok, sscanf and double math), and reports sentences per second and cycles
+ *              (or ns without a cycle counter) per byte of each one, on the GGA sentences that both
+ *              decode. The positions of both parsers are compared with the generated ones, and the
+ *              sentences with a flipped bit are counted: the 8 bit checksum misses only the flips
+ *              that change the framing (e.g. '.' to '*').
+ *
+ *              gcc -O2 -I../../src -o nmea_bench nmea_bench.c ../../src/nmea.c
+ *              ./nmea_bench [sentences]
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "nmea.h"
+
+#define BENCH_LINE 96 ///< Bytes of a sentence in the stream, with its CR/LF
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return (uint64_t)hi << 32 | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000u + ts.tv_nsec;
+#endif
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/**
+ * @brief Previous parser (gps_get_GPGGA() before the NMEA state machine), it edits the line.
+ *
+ */
+typedef struct{
+    uint8_t time_h, time_m, time_s;
+    double latitude, longitude;
+    uint8_t latitude_area, longitude_area;
+    uint8_t fix_quality, num_satellites;
+    uint16_t altitude;
+}legacy_t;
+
+static void legacy_gpgga(legacy_t *gps, char *buffer)
+{
+    if (strncmp(buffer, "$GPGGA", 6) != 0) return;
+    char *token = strtok(buffer, ",");
+    uint16_t field_index = 0;
+    while (token != NULL){
+        switch (field_index){
+        case 1:
+            gps->time_h = (token[0] - '0')*10 + (token[1] - '0');
+            gps->time_m = (token[2] - '0')*10 + (token[3] - '0');
+            gps->time_s = (token[4] - '0')*10 + (token[5] - '0');
+            break;
+        case 2:
+            if (strlen(token) >= 4){
+                double lat_deg, lat_min;
+                sscanf(token, "%2lf%lf", &lat_deg, &lat_min);
+                gps->latitude = lat_deg + lat_min/60.0;
+            }
+            break;
+        case 3:
+            gps->latitude_area = token[0];
+            if (gps->latitude_area == 'S') gps->latitude = -gps->latitude;
+            break;
+        case 4:
+            if (strlen(token) >= 5){
+                double lon_deg, lon_min;
+                sscanf(token, "%3lf%lf", &lon_deg, &lon_min);
+                gps->longitude = lon_deg + lon_min/60.0;
+            }
+            break;
+        case 5:
+            gps->longitude_area = token[0];
+            if (gps->longitude_area == 'W') gps->longitude = -gps->longitude;
+            break;
+        case 6:
+            gps->fix_quality = atoi(token);
+            break;
+        case 7:
+            gps->num_satellites = atoi(token);
+            break;
+        case 9:
+            gps->altitude = atof(token);
+            break;
+        }
+        token = strtok(NULL, ",");
+        field_index++;
+    }
+}
+
+/**
+ * @brief Append the checksum and CR/LF to a sentence.
+ *
+ */
+static int finish(char *line, int len)
+{
+    uint8_t cs = 0;
+    for (int i = 1; i < len; i++) cs ^= (uint8_t)line[i];
+    return len + sprintf(line + len, "*%02X\r\n", cs);
+}
+
+/**
+ * @brief Write a random sentence, GGA or RMC, and the position it carries in microdegrees.
+ *
+ */
+static int make_sentence(char *line, bool gga, int32_t *lat, int32_t *lon)
+{
+    uint32_t lat_min = rand() % (90*600000);    ///< Minutes x10^4
+    uint32_t lon_min = rand() % (180*600000);
+    char ns = (rand() & 1) ? 'N' : 'S';
+    char ew = (rand() & 1) ? 'E' : 'W';
+    *lat = (int32_t)((lat_min*10 + 3)/6)*(ns == 'S' ? -1 : 1);
+    *lon = (int32_t)((lon_min*10 + 3)/6)*(ew == 'W' ? -1 : 1);
+    int h = rand() % 24, m = rand() % 60, s = rand() % 60;
+    int len;
+    if (gga){
+        len = sprintf(line, "$GPGGA,%02d%02d%02d.000,%02u%02u.%04u,%c,%03u%02u.%04u,%c,1,%d,1.%02d,%d.%d,M,-34.2,M,,",
+                h, m, s, lat_min/600000, lat_min/10000 % 60, lat_min % 10000, ns,
+                lon_min/600000, lon_min/10000 % 60, lon_min % 10000, ew,
+                4 + rand() % 8, rand() % 100, rand() % 3000, rand() % 10);
+    }else{
+        len = sprintf(line, "$GNRMC,%02d%02d%02d.000,A,%02u%02u.%04u,%c,%03u%02u.%04u,%c,0.13,309.62,120598,,,A",
+                h, m, s, lat_min/600000, lat_min/10000 % 60, lat_min % 10000, ns,
+                lon_min/600000, lon_min/10000 % 60, lon_min % 10000, ew);
+    }
+    return finish(line, len);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = (argc > 1) ? atoi(argv[1]) : 200000;
+    char *stream = malloc((size_t)n*BENCH_LINE);
+    int *lens = malloc(n*sizeof(int));
+    int32_t *lat = malloc(n*sizeof(int32_t)), *lon = malloc(n*sizeof(int32_t));
+    size_t bytes = 0; ///< Bytes of the GGA sentences (even indexes)
+    srand(1);
+    for (int i = 0; i < n; i++){
+        lens[i] = make_sentence(stream + (size_t)i*BENCH_LINE, (i & 1) == 0, &lat[i], &lon[i]);
+        if ((i & 1) == 0) bytes += lens[i];
+    }
+
+    ///< Correctness: every sentence is published with the exact position
+    nmea_parser_t nmea;
+    nmea_fix_t fix;
+    int errors = 0;
+    nmea_init(&nmea);
+    for (int i = 0; i < n; i++){
+        const char *line = stream + (size_t)i*BENCH_LINE;
+        bool published = false;
+        for (int j = 0; j < lens[i]; j++) published |= nmea_feed(&nmea, line[j]);
+        nmea_read(&nmea, &fix);
+        if (!published || fix.lat != lat[i] || fix.lon != lon[i]) errors++;
+    }
+    ///< A flipped bit must be rejected by the checksum
+    int accepted = 0;
+    for (int i = 0; i < n; i++){
+        char line[BENCH_LINE];
+        memcpy(line, stream + (size_t)i*BENCH_LINE, lens[i]);
+        line[1 + rand() % (lens[i] - 6)] ^= 1 << (rand() % 7);
+        for (int j = 0; j < lens[i]; j++) accepted += nmea_feed(&nmea, line[j]);
+    }
+    printf("nmea: %d wrong positions, %d damaged sentences accepted, %lu errors counted\n",
+            errors, accepted, (unsigned long)nmea.errors);
+
+    ///< Throughput of the state machine, fed byte by byte as from the UART
+    nmea_init(&nmea);
+    double t0 = now_s();
+    uint64_t c0 = cycles();
+    for (int i = 0; i < n; i += 2){
+        const char *line = stream + (size_t)i*BENCH_LINE;
+        for (int j = 0; j < lens[i]; j++) nmea_feed(&nmea, line[j]);
+    }
+    uint64_t c_new = cycles() - c0;
+    double t_new = now_s() - t0;
+
+    ///< Previous parser: copy of the line to the buffer (as the UART handler did) and strtok
+    legacy_t legacy = {0};
+    char buffer[BENCH_LINE];
+    int legacy_errors = 0;
+    t0 = now_s();
+    c0 = cycles();
+    for (int i = 0; i < n; i += 2){
+        const char *line = stream + (size_t)i*BENCH_LINE;
+        int len = lens[i] - 2;
+        memcpy(buffer, line, len);
+        buffer[len] = '\0';
+        legacy_gpgga(&legacy, buffer);
+        if ((int32_t)(legacy.latitude*1000000) != lat[i]) legacy_errors++;
+    }
+    uint64_t c_old = cycles() - c0;
+    double t_old = now_s() - t0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char *unit = "cycles/byte";
+#else
+    const char *unit = "ns/byte";
+#endif
+    n = (n + 1)/2;
+    printf("%d GGA sentences, %lu bytes\n", n, (unsigned long)bytes);
+    printf("nmea_feed:    %10.0f sentences/s %7.2f %s\n", n/t_new, (double)c_new/bytes, unit);
+    printf("strtok (GGA): %10.0f sentences/s %7.2f %s, %d positions off by truncation\n",
+            n/t_old, (double)c_old/bytes, unit, legacy_errors);
+    free(stream);
+    free(lens);
+    free(lat);
+    free(lon);
+    return errors != 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * \file        log_dump.c
+ * \brief       Host reader of a dump of the record log region of the tracker.
+ * \details
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdlib.h>
+#include "log_dump.h"
+#include "record.h"
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void print_cdb(FILE *out, int32_t v, const char *sep)
+{
+    fprintf(out, "%s%ld.%02ld%s", v < 0 ? "-" : "", labs(v)/100, labs(v)%100, sep);
+}
+
+static void print_record(FILE *out, uint32_t index, const rec_t *r)
+{
+    fprintf(out, "%lu, %lu, %lu, ", (unsigned long)index, (unsigned long)r->time, (unsigned long)r->duration);
+    print_cdb(out, r->leq, ", ");
+    fprintf(out, "%s%ld.%06ld, %s%ld.%06ld", r->lat < 0 ? "-" : "", labs(r->lat)/1000000, labs(r->lat)%1000000,
+            r->lon < 0 ? "-" : "", labs(r->lon)/1000000, labs(r->lon)%1000000);
+    const int16_t levels[] = {r->levels.l5, r->levels.l10, r->levels.l50, r->levels.l90,
+                              r->levels.l95, r->levels.lmax, r->levels.lmin, r->levels.lpeak};
+    for (int i = 0; i < 8; i++){ ///< Empty columns for the fields the record does not have
+        fprintf(out, ", ");
+        if (r->flags & REC_F_STATS) print_cdb(out, levels[i], "");
+    }
+    for (int i = 0; i < REC_NUM_TW; i++){
+        fprintf(out, ", ");
+        if (r->flags & REC_F_TW) print_cdb(out, r->tw_max[i], "");
+    }
+    if (r->flags & REC_F_GPS) fprintf(out, ", %lu.%03lu, %s", (unsigned long)(r->ttff_ms/1000), (unsigned long)(r->ttff_ms%1000), r->gps_start ? "hot" : "cold");
+    else fprintf(out, ", , ");
+    fprintf(out, "\n");
+}
+
+uint32_t log_dump_csv(const uint8_t *flash, FILE *out)
+{
+    uint32_t records = 0;
+    int order[FLOG_NUM_SECTORS];
+    int opened = 0;
+    for (int s = 0; s < FLOG_NUM_SECTORS; s++){ ///< Opened sectors sorted by sequence number
+        const uint8_t *hdr = flash + s*FLOG_SECTOR_SIZE;
+        if (get_u32(hdr) != FLOG_MAGIC || get_u32(hdr + 8) == FLOG_FREE) continue;
+        int i = opened++;
+        while (i > 0 && get_u32(flash + order[i - 1]*FLOG_SECTOR_SIZE + 8) > get_u32(hdr + 8)){
+            order[i] = order[i - 1];
+            i--;
+        }
+        order[i] = s;
+    }
+
+    fprintf(out, "Index, Time, Duration, SPL, Latitude, Longitude, L5, L10, L50, L90, L95, Lmax, Lmin, Lpeak, LFmax, LSmax, LImax, TTFF, Start\n");
+    rec_t rec, prev;
+    bool valid = false;
+    for (int i = 0; i < opened; i++){
+        for (int p = 1; p < FLOG_PAGES; p++){
+            const uint8_t *page = flash + order[i]*FLOG_SECTOR_SIZE + p*FLOG_PAGE_SIZE;
+            uint32_t index = get_u32(page);
+            if (index == FLOG_FREE) break;
+            uint16_t crc = page[FLOG_CRC_OFFSET] | (uint16_t)page[FLOG_CRC_OFFSET + 1] << 8;
+            if (crc != FLOG_CRC_FREE && crc != rec_crc16(page, FLOG_CRC_OFFSET)){ ///< Not sealed: the page being written
+                fprintf(stderr, "page of record %lu has a wrong CRC\n", (unsigned long)index);
+                valid = false;
+                continue;
+            }
+            size_t len;
+            for (int pos = FLOG_PAGE_HEADER; pos < FLOG_CRC_OFFSET && page[pos] != FLOG_EMPTY; pos += len, index++){
+                if (!(len = rec_size(page + pos, FLOG_CRC_OFFSET - pos))){ ///< The rest of the page cannot be read
+                    fprintf(stderr, "record %lu cannot be read\n", (unsigned long)index);
+                    valid = false;
+                    break;
+                }
+                valid = rec_decode(page + pos, len, valid ? &prev : NULL, &rec);
+                if (!valid){
+                    fprintf(stderr, "record %lu is damaged\n", (unsigned long)index);
+                    continue;
+                }
+                print_record(out, index, &rec);
+                records++;
+                prev = rec;
+            }
+        }
+    }
+    return records;
+}
+
@@ -0,0 +1,39 @@
+/**
+ * \file        log_dump.h
+ * \brief       Host reader of a dump of the record log region of the tracker.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __LOG_DUMP_H__
+#define __LOG_DUMP_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+///< Layout of the log, as in flash_log.h
+#define FLOG_NUM_SECTORS 16
+#define FLOG_SECTOR_SIZE 4096
+#define FLOG_PAGE_SIZE 256
+#define FLOG_PAGES (FLOG_SECTOR_SIZE/FLOG_PAGE_SIZE)
+#define FLOG_MAGIC 0x32474F4C
+#define FLOG_FREE 0xFFFFFFFF
+#define FLOG_PAGE_HEADER 4
+#define FLOG_EMPTY 0xFF
+#define FLOG_CRC_OFFSET (FLOG_PAGE_SIZE - 2)
+#define FLOG_CRC_FREE 0xFFFF
+
+#define LOG_DUMP_SIZE (FLOG_NUM_SECTORS*FLOG_SECTOR_SIZE) ///< Bytes of the dump
+
+/**
+ * @brief Print the records of the dump as CSV, oldest first (from the opened sector with the lowest
+ * sequence number). The pages with a wrong CRC and the records that can not be read are reported in stderr.
+ *
+ * @param flash LOG_DUMP_SIZE bytes.
+ * @param out
+ * @return Records printed.
+ */
+uint32_t log_dump_csv(const uint8_t *flash, FILE *out);
+
+#endif // __LOG_DUMP_H__
@@ -0,0 +1,183 @@
+/**
+ * \file        record_decoder.c
+ * \brief       Host reference decoder of the record log of the tracker.
+ * \details     Reads a dump of the log region of the flash (the last FLOG_NUM_SECTORS sectors, e.g.
+ *              picotool save -r 0x101F0000 0x10200000 log.bin for a 2 MB flash) and prints the
+ *              records as CSV, oldest first. With -r it encodes and decodes random records
+ *              instead, and checks the round trip of the format; then it writes them in a log
+ *              image as the tracker does, and checks that log_dump_csv() reads them all and
+ *              drops the page with a flipped bit.
+ *
+ *              gcc -I../../src -o record_decoder record_decoder.c log_dump.c ../../src/record.c
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "record.h"
+#include "log_dump.h"
+
+static uint8_t flash[LOG_DUMP_SIZE];
+
+static int decode_dump(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f){
+        perror(path);
+        return 1;
+    }
+    size_t n = fread(flash, 1, sizeof(flash), f);
+    fclose(f);
+    if (n != sizeof(flash)){
+        fprintf(stderr, "%s: expected %u bytes\n", path, (unsigned)sizeof(flash));
+        return 1;
+    }
+    log_dump_csv(flash, stdout);
+    return 0;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> 8*i);
+}
+
+/**
+ * @brief Optional level of a random record: a whole number of steps from the Leq, or out of the range
+ * of a byte (saturated).
+ *
+ */
+static int16_t random_level(int16_t leq, int16_t *expected)
+{
+    int32_t steps = rand() % 301 - 150;
+    int32_t saturated = steps > REC_LEVEL_MAX ? REC_LEVEL_MAX : steps < -REC_LEVEL_MAX ? -REC_LEVEL_MAX : steps;
+    *expected = (int16_t)(leq + REC_LEVEL_STEP_CDB*saturated);
+    return (int16_t)(leq + REC_LEVEL_STEP_CDB*steps);
+}
+
+/**
+ * @brief Write a record in the log image as flog_append() does: a new page (absolute record) when it
+ * does not fit, the page before sealed with its CRC, one sector after the other.
+ *
+ */
+static void image_append(const rec_t *r, const rec_t *prev, uint32_t index, int *sector, int *page, int *pos)
+{
+    uint8_t buf[REC_MAX_SIZE];
+    size_t len = rec_encode(r, prev, buf);
+    if (!*pos || *pos + len > FLOG_CRC_OFFSET){
+        if (*pos){
+            uint8_t *old = flash + *sector*FLOG_SECTOR_SIZE + *page*FLOG_PAGE_SIZE;
+            uint16_t crc = rec_crc16(old, FLOG_CRC_OFFSET);
+            old[FLOG_CRC_OFFSET] = (uint8_t)crc;
+            old[FLOG_CRC_OFFSET + 1] = (uint8_t)(crc >> 8);
+            if (++*page == FLOG_PAGES){
+                *page = 1;
+                ++*sector;
+            }
+        }
+        if (*page == 1){
+            uint8_t *hdr = flash + *sector*FLOG_SECTOR_SIZE;
+            put_u32(hdr, FLOG_MAGIC);
+            put_u32(hdr + 4, 1);
+            put_u32(hdr + 8, *sector + 1);
+        }
+        put_u32(flash + *sector*FLOG_SECTOR_SIZE + *page*FLOG_PAGE_SIZE, index);
+        *pos = FLOG_PAGE_HEADER;
+        len = rec_encode(r, NULL, buf);
+    }
+    memcpy(flash + *sector*FLOG_SECTOR_SIZE + *page*FLOG_PAGE_SIZE + *pos, buf, len);
+    *pos += len;
+}
+
+/**
+ * @brief Encode and decode random records, absolute and deltas, then read them from a log image.
+ *
+ */
+static int round_trip(long count)
+{
+    rec_t prev = {0};
+    long in_image = 0;
+    int sector = 0, page = 1, pos = 0;
+    memset(flash, 0xFF, sizeof(flash));
+    srand(1);
+    for (long i = 0; i < count; i++){
+        rec_t r, expected;
+        memset(&r, 0, sizeof(r));
+        r.flags = rand() & (REC_F_STATS | REC_F_TW | REC_F_GPS);
+        r.leq = rand() % 14000;
+        r.lat = (int32_t)(rand() % 180000001) - 90000000;
+        r.lon = (int32_t)(rand() % 360000001) - 180000000;
+        r.time = (uint32_t)rand();
+        r.duration = (rand() & 1) ? REC_DEFAULT_DURATION : rand() % 3600;
+        expected = r;
+        int16_t *levels = &r.levels.l5, *expected_levels = &expected.levels.l5;
+        for (int j = 0; j < 8; j++){
+            if (r.flags & REC_F_STATS) levels[j] = random_level(r.leq, &expected_levels[j]);
+        }
+        for (int j = 0; j < REC_NUM_TW; j++){
+            if (r.flags & REC_F_TW) r.tw_max[j] = random_level(r.leq, &expected.tw_max[j]);
+        }
+        r.ttff_ms = expected.ttff_ms = (r.flags & REC_F_GPS) ? (uint32_t)rand() : 0;
+        r.gps_start = expected.gps_start = (r.flags & REC_F_GPS) ? rand() & 1 : 0;
+
+        uint8_t buf[REC_MAX_SIZE];
+        bool abs = (i % 10 == 0);
+        size_t len = rec_encode(&r, abs ? NULL : &prev, buf);
+        rec_t d;
+        if (rec_size(buf, sizeof(buf)) != len || rec_size(buf, len - 1)){
+            fprintf(stderr, "record %ld: wrong length\n", i);
+            return 1;
+        }
+        if (!rec_decode(buf, len, abs ? NULL : &prev, &d)){
+            fprintf(stderr, "record %ld: not decoded\n", i);
+            return 1;
+        }
+        uint32_t ref_duration = abs ? REC_DEFAULT_DURATION : prev.duration;
+        expected.flags |= (abs ? REC_F_ABS : 0) | ((r.duration != ref_duration) ? REC_F_DURATION : 0);
+        if (d.flags != expected.flags || d.leq != r.leq || d.lat != r.lat || d.lon != r.lon || d.time != r.time ||
+            d.duration != r.duration || memcmp(&d.levels, &expected.levels, sizeof(r.levels)) ||
+            memcmp(d.tw_max, expected.tw_max, sizeof(r.tw_max)) || d.ttff_ms != r.ttff_ms || d.gps_start != r.gps_start){
+            fprintf(stderr, "record %ld: decoded with other values\n", i);
+            return 1;
+        }
+        if (sector < FLOG_NUM_SECTORS - 1){ ///< The log image, until its last sector
+            image_append(&r, in_image ? &prev : NULL, (uint32_t)in_image, &sector, &page, &pos);
+            in_image++;
+        }
+        prev = r;
+    }
+    printf("%ld records OK\n", count);
+
+    FILE *null = fopen("/dev/null", "w");
+    uint32_t read = log_dump_csv(flash, null);
+    if (read != in_image){
+        fprintf(stderr, "log image: %lu of %ld records read\n", (unsigned long)read, in_image);
+        return 1;
+    }
+    if (in_image && (sector || page > 1)){ ///< A flipped bit in a sealed page drops that page only
+        uint8_t *first = flash + FLOG_PAGE_SIZE;
+        int records = 0;
+        for (size_t p = FLOG_PAGE_HEADER, len; p < FLOG_CRC_OFFSET && first[p] != FLOG_EMPTY; p += len, records++){
+            len = rec_size(first + p, FLOG_CRC_OFFSET - p);
+        }
+        first[FLOG_PAGE_HEADER + rand() % 8] ^= 1 << (rand() % 8);
+        uint32_t left = log_dump_csv(flash, null);
+        if (left != read - records){
+            fprintf(stderr, "log image with a flipped bit: %lu records read, expected %lu\n", (unsigned long)left, (unsigned long)(read - records));
+            return 1;
+        }
+    }
+    fclose(null);
+    printf("log image: %ld records OK, the page with a flipped bit dropped\n", in_image);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && !strcmp(argv[1], "-r")) return round_trip(atol(argv[2]));
+    if (argc == 2) return decode_dump(argv[1]);
+    fprintf(stderr, "usage: %s log.bin | -r count\n", argv[0]);
+    return 2;
+}
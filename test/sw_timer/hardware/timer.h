@@ -0,0 +1 @@
+#include "pico/stdlib.h"
@@ -0,0 +1,61 @@
+/**
+ * \file        stdlib.h
+ * \brief       Host shim of the Pico SDK for the test of the software timers: a simulated timer.
+ * \details     The time only advances when the test calls sim_advance(), which raises the interrupt
+ *              of the alarm when its target is reached, or at once if it is forced.
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#ifndef __SIM_STDLIB_H__
+#define __SIM_STDLIB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct{
+    volatile uint32_t alarm[4];
+    volatile uint32_t armed;
+    volatile uint32_t timerawl;
+    volatile uint32_t intr;
+    volatile uint32_t inte;
+    volatile uint32_t intf;
+}timer_hw_t;
+
+extern timer_hw_t *timer_hw;
+
+enum{TIMER_IRQ_0, TIMER_IRQ_1, TIMER_IRQ_2, TIMER_IRQ_3};
+
+typedef void (*irq_handler_t)(void);
+
+static inline uint32_t time_us_32(void)
+{
+    return timer_hw->timerawl;
+}
+
+static inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask)
+{
+    *addr |= mask;
+}
+
+static inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask)
+{
+    *addr &= ~mask;
+}
+
+void hardware_alarm_claim(unsigned int alarm_num);
+void irq_set_exclusive_handler(unsigned int num, irq_handler_t handler);
+void irq_set_enabled(unsigned int num, bool enabled);
+
+static inline uint32_t save_and_disable_interrupts(void)
+{
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status)
+{
+    (void)status;
+}
+
+#endif // __SIM_STDLIB_H__
@@ -0,0 +1,204 @@
+/**
+ * \file        sw_timer_test.c
+ * \brief       Host test of the software timers on a simulated clock.
+ * \details     The shims in this directory replace the timer of the Pico SDK: the time only advances
+ *              in sim_advance(), which runs the handler of the alarm at its target, or at once when
+ *              the interrupt is forced. Checked: one-shot and periodic timers never run early nor
+ *              later than their slack, the periods do not drift, a timer cancelled (also from a
+ *              callback) does not run, two timers within the slack share the wakeups, random
+ *              starts and cancels, and the wraparound of the 32 bit counter.
+ *
+ *              gcc -O2 -Wall -I. -I../../src -o sw_timer_test sw_timer_test.c ../../src/sw_timer.c
+ *              ./sw_timer_test [operations]
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "pico/stdlib.h"
+#include "sw_timer.h"
+
+#define TEST_TIMERS 16
+
+static timer_hw_t sim_timer;
+timer_hw_t *timer_hw = &sim_timer;
+static irq_handler_t sim_handler;
+static uint32_t sim_claimed;    ///< Alarms claimed since the reset of the timer
+static int failures;
+
+void hardware_alarm_claim(unsigned int alarm_num)
+{
+    sim_claimed |= 1u << alarm_num;
+}
+
+void irq_set_exclusive_handler(unsigned int num, irq_handler_t handler)
+{
+    if (num == TIMER_IRQ_0 + SWT_ALARM) sim_handler = handler;
+}
+
+void irq_set_enabled(unsigned int num, bool enabled)
+{
+    (void)num;
+    (void)enabled;
+}
+
+/**
+ * @brief Advance the simulated time by us, running the interrupts of the alarm on the way.
+ *
+ */
+static void sim_advance(uint32_t us)
+{
+    uint32_t end = sim_timer.timerawl + us;
+    const uint32_t bit = 1u << SWT_ALARM;
+    for (;;){
+        if (sim_timer.intf & bit){
+            sim_handler();
+            continue;
+        }
+        uint32_t wait = sim_timer.alarm[SWT_ALARM] - sim_timer.timerawl;
+        if ((sim_timer.inte & bit) && wait && wait <= end - sim_timer.timerawl){
+            sim_timer.timerawl = sim_timer.alarm[SWT_ALARM];
+            sim_timer.intr |= bit;
+            sim_handler();
+            continue;
+        }
+        sim_timer.timerawl = end;
+        return;
+    }
+}
+
+/**
+ * @brief Expected runs of a timer.
+ *
+ */
+typedef struct{
+    swt_timer_t timer;
+    uint32_t expected_us;   ///< Next expiration
+    uint32_t runs;
+    uint32_t cancel_after;  ///< Cancel itself after these runs, 0: never
+    swt_timer_t *victim;    ///< Cancelled by the callback, NULL: none
+}test_timer_t;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok){
+        failures++;
+        printf("FAIL %s at %lu us\n", what, (unsigned long)sim_timer.timerawl);
+    }
+}
+
+static void test_callback(swt_timer_t *timer)
+{
+    test_timer_t *t = timer->param;
+    int32_t late = (int32_t)(time_us_32() - t->expected_us);
+    check(late >= 0, "early");
+    check(late <= (int32_t)timer->slack_us, "later than the slack");
+    t->runs++;
+    t->expected_us = timer->expire_us;  ///< Next period, the same if it is a one-shot
+    if (t->victim) swt_cancel(t->victim);
+    if (t->cancel_after && t->runs == t->cancel_after) swt_cancel(timer);
+}
+
+static void test_start(test_timer_t *t, uint32_t delay_us, uint32_t period_us, uint32_t slack_us)
+{
+    t->expected_us = time_us_32() + delay_us;
+    swt_start(&t->timer, delay_us, period_us, slack_us);
+}
+
+static void test_reset(test_timer_t *t, int n, uint32_t now)
+{
+    sim_timer = (timer_hw_t){0};
+    sim_timer.timerawl = now;
+    sim_claimed = 0;
+    swt_init();
+    check(sim_claimed == 1u << SWT_ALARM, "alarm not claimed");
+    for (int i = 0; i < n; i++){
+        t[i] = (test_timer_t){0};
+        swt_timer_init(&t[i].timer, test_callback, &t[i]);
+    }
+}
+
+static void test_basic(uint32_t now)
+{
+    test_timer_t t[4];
+    test_reset(t, 4, now);
+    test_start(&t[0], 5000, 0, 0);          ///< One-shot, exact
+    test_start(&t[1], 1000, 1000, 0);       ///< Periodic, exact
+    test_start(&t[2], 0, 0, 0);             ///< As soon as possible
+    sim_advance(0);
+    check(t[2].runs == 1, "immediate timer");
+    sim_advance(1000000);
+    check(t[0].runs == 1 && !swt_active(&t[0].timer), "one-shot");
+    check(t[1].runs == 1000, "periodic drift");
+
+    t[1].cancel_after = t[1].runs + 3;      ///< Cancelled by its own callback
+    test_start(&t[3], 2500, 0, 0);
+    t[0].victim = &t[3].timer;              ///< Cancelled by the callback of another timer
+    test_start(&t[0], 2000, 0, 0);
+    sim_advance(100000);
+    check(t[1].runs == 1003 && !swt_active(&t[1].timer), "cancel from the own callback");
+    check(t[3].runs == 0 && !swt_active(&t[3].timer), "cancel from another callback");
+    check(swt_get_stats()->late_max_us == 0, "late without slack");
+}
+
+/**
+ * @brief Two 1 s timers 30 ms apart: with 50 ms of slack they share one wakeup per period.
+ *
+ */
+static void test_coalescing(uint32_t now)
+{
+    test_timer_t t[2];
+    uint32_t alone, shared;
+    for (int slack = 0; slack <= 1; slack++){
+        test_reset(t, 2, now);
+        test_start(&t[0], 1000000, 1000000, slack ? 50000 : 0);
+        test_start(&t[1], 1030000, 1000000, slack ? 50000 : 0);
+        sim_advance(100500000);
+        check(t[0].runs == 100 && t[1].runs == 100, "coalesced runs");
+        if (slack) shared = swt_get_stats()->wakeups;
+        else alone = swt_get_stats()->wakeups;
+    }
+    printf("Coalescing: %lu wakeups without slack, %lu with 50 ms\n", (unsigned long)alone, (unsigned long)shared);
+    check(shared <= alone/2 + 1, "coalescing");
+}
+
+/**
+ * @brief Random starts and cancels of TEST_TIMERS timers.
+ *
+ */
+static void test_random(uint32_t now, int n)
+{
+    test_timer_t t[TEST_TIMERS];
+    test_reset(t, TEST_TIMERS, now);
+    for (int i = 0; i < n; i++){
+        test_timer_t *r = &t[rand() % TEST_TIMERS];
+        if (rand() % 4 == 0){
+            swt_cancel(&r->timer);
+        }else{
+            uint32_t period = (rand() % 3 == 0) ? 100 + rand() % 20000 : 0;
+            test_start(r, rand() % 50000, period, rand() % 5000);
+        }
+        sim_advance(rand() % 10000);
+    }
+    for (int i = 0; i < TEST_TIMERS; i++) swt_cancel(&t[i].timer);
+    check((sim_timer.inte & 1u << SWT_ALARM) == 0, "alarm disabled without timers");
+    const swt_stats_t *s = swt_get_stats();
+    printf("Random from %lu: %lu wakeups, %lu callbacks, max %lu us late\n", (unsigned long)now,
+           (unsigned long)s->wakeups, (unsigned long)s->expirations, (unsigned long)s->late_max_us);
+}
+
+int main(int argc, char *argv[])
+{
+    int n = (argc > 1) ? atoi(argv[1]) : 100000;
+    srand(1);
+    const uint32_t starts[] = {0, 0xFFFF0000u}; ///< The second one wraps the 32 bit counter
+    for (unsigned int i = 0; i < sizeof(starts)/sizeof(starts[0]); i++){
+        test_basic(starts[i]);
+        test_coalescing(starts[i]);
+        test_random(starts[i], n);
+    }
+    printf("%d failures\n", failures);
+    return failures != 0;
+}
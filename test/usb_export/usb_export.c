@@ -0,0 +1,245 @@
+/**
+ * \file        usb_export.c
+ * \brief       Host client of the USB export of the tracker: pulls the record log and converts it to CSV.
+ * \details     Reads the log region chunk by chunk with the protocol of src/usb_export.h, retrying
+ *              the damaged or lost chunks. With a dump file, every chunk is appended to it, so an
+ *              interrupted export resumes from the size of the file. The throughput is reported.
+ *
+ *              gcc -I../../src -I../record_decoder -o usb_export usb_export.c \
+ *                  ../record_decoder/log_dump.c ../../src/record.c
+ *              ./usb_export /dev/ttyACM0 records.csv [log.bin]
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+#include "record.h"
+#include "log_dump.h"
+
+///< Protocol, as in src/usb_export.h
+#define UEXP_REQ_MAGIC 0xA5
+#define UEXP_RSP_MAGIC 0x5A
+#define UEXP_MAX_CHUNK 1024
+#define UEXP_CMD_INFO 1
+#define UEXP_CMD_READ 2
+#define UEXP_OK 0
+#define UEXP_ERR_BUSY 4
+#define UEXP_REQUEST_SIZE 12
+#define UEXP_RESPONSE_SIZE 16
+
+#define CLIENT_RETRIES 5 ///< Attempts of a chunk
+#define CLIENT_BUSY_WAITS 60 ///< Seconds to wait for a measurement to end, it takes 10 s after the fix
+#define CLIENT_TIMEOUT_MS 1000 ///< Time to wait for a response
+
+static int fd;
+static uint16_t seq;
+static uint8_t region[LOG_DUMP_SIZE];
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (uint16_t)p[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+/**
+ * @brief Read exactly n bytes before the deadline.
+ *
+ */
+static bool read_bytes(uint8_t *buf, size_t n, double deadline)
+{
+    size_t got = 0;
+    while (got < n){
+        if (now_s() > deadline) return false;
+        ssize_t r = read(fd, buf + got, n - got);
+        if (r > 0) got += r;
+    }
+    return true;
+}
+
+/**
+ * @brief Send a request and wait for its response. The bytes that are not a valid response header
+ * (text printed by the device, old responses) are skipped.
+ *
+ * @param cmd
+ * @param offset
+ * @param len
+ * @param payload Payload of the response, len bytes.
+ * @return Status of the response, -1 if there is no valid response.
+ */
+static int transact(uint8_t cmd, uint32_t offset, uint16_t len, uint8_t *payload)
+{
+    uint8_t req[UEXP_REQUEST_SIZE];
+    req[0] = UEXP_REQ_MAGIC;
+    req[1] = cmd;
+    put_u16(req + 2, ++seq);
+    put_u32(req + 4, offset);
+    put_u16(req + 8, len);
+    put_u16(req + 10, rec_crc16(req, 10));
+    if (write(fd, req, sizeof(req)) != sizeof(req)) return -1;
+
+    double deadline = now_s() + CLIENT_TIMEOUT_MS/1000.0;
+    uint8_t rsp[UEXP_RESPONSE_SIZE];
+    size_t have = 0;
+    while (read_bytes(rsp + have, sizeof(rsp) - have, deadline)){
+        if (rsp[0] != UEXP_RSP_MAGIC || rec_crc16(rsp, 14) != get_u16(rsp + 14)){ ///< Resynchronize
+            memmove(rsp, rsp + 1, sizeof(rsp) - 1);
+            have = sizeof(rsp) - 1;
+            continue;
+        }
+        uint16_t rlen = get_u16(rsp + 8);
+        if (rlen > UEXP_MAX_CHUNK) return -1;
+        uint8_t data[UEXP_MAX_CHUNK];
+        if (!read_bytes(data, rlen, deadline)) return -1;
+        if (get_u16(rsp + 2) != seq){ ///< Response of a previous request
+            have = 0;
+            continue;
+        }
+        if (rsp[10] != UEXP_OK) return rsp[10];
+        if (rlen != len || get_u32(rsp + 4) != offset || rec_crc16(data, rlen) != get_u16(rsp + 12)){
+            return -1;
+        }
+        memcpy(payload, data, rlen);
+        return UEXP_OK;
+    }
+    return -1;
+}
+
+/**
+ * @brief Send a request until it gets a valid response, up to CLIENT_RETRIES failures and
+ * CLIENT_BUSY_WAITS busy responses.
+ *
+ */
+static bool transact_retry(uint8_t cmd, uint32_t offset, uint16_t len, uint8_t *payload)
+{
+    int busy = 0;
+    for (int i = 0; i < CLIENT_RETRIES; i++){
+        int status = transact(cmd, offset, len, payload);
+        if (status == UEXP_OK) return true;
+        if (status == UEXP_ERR_BUSY){
+            if (++busy > CLIENT_BUSY_WAITS){
+                fprintf(stderr, "The device is still measuring after %d s\n", CLIENT_BUSY_WAITS);
+                return false;
+            }
+            if (busy == 1) fprintf(stderr, "The device is measuring, waiting\n");
+            sleep(1);
+            i--;
+            continue;
+        }
+        fprintf(stderr, "Chunk at %lu failed (%d), retrying\n", (unsigned long)offset, status);
+        tcflush(fd, TCIFLUSH);
+    }
+    return false;
+}
+
+static bool open_port(const char *path)
+{
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0){
+        perror(path);
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 1; ///< read() returns after 100 ms without bytes
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3 || argc > 4){
+        fprintf(stderr, "usage: %s tty out.csv [log.bin]\n", argv[0]);
+        return 2;
+    }
+    if (!open_port(argv[1])) return 1;
+
+    uint8_t info[16];
+    if (!transact_retry(UEXP_CMD_INFO, 0, sizeof(info), info)){
+        fprintf(stderr, "No answer from the device\n");
+        return 1;
+    }
+    if (get_u32(info) != LOG_DUMP_SIZE){
+        fprintf(stderr, "Unexpected log region of %lu bytes\n", (unsigned long)get_u32(info));
+        return 1;
+    }
+    printf("Device: %lu records\n", (unsigned long)get_u32(info + 8));
+
+    ///< Resume from the chunks already in the dump file
+    uint32_t offset = 0;
+    FILE *dump = NULL;
+    if (argc == 4){
+        FILE *f = fopen(argv[3], "rb");
+        if (f){
+            offset = fread(region, 1, sizeof(region), f)/UEXP_MAX_CHUNK*UEXP_MAX_CHUNK; ///< Drop a partial chunk
+            fclose(f);
+        }
+        dump = fopen(argv[3], offset ? "r+b" : "wb");
+        if (!dump){
+            perror(argv[3]);
+            return 1;
+        }
+        fseek(dump, offset, SEEK_SET);
+        if (offset) printf("Resuming at %lu\n", (unsigned long)offset);
+    }
+
+    uint32_t first = offset;
+    double start = now_s();
+    for (; offset < LOG_DUMP_SIZE; offset += UEXP_MAX_CHUNK){
+        if (!transact_retry(UEXP_CMD_READ, offset, UEXP_MAX_CHUNK, region + offset)){
+            fprintf(stderr, "Export stopped at %lu, run again to resume\n", (unsigned long)offset);
+            return 1;
+        }
+        if (dump){
+            fwrite(region + offset, 1, UEXP_MAX_CHUNK, dump);
+            fflush(dump);
+        }
+    }
+    double elapsed = now_s() - start;
+    printf("%lu bytes in %.3f s, %.1f kB/s\n", (unsigned long)(offset - first), elapsed,
+            (offset - first)/1024.0/(elapsed > 0 ? elapsed : 1));
+    if (dump) fclose(dump);
+
+    FILE *csv = fopen(argv[2], "w");
+    if (!csv){
+        perror(argv[2]);
+        return 1;
+    }
+    printf("%lu records written to %s\n", (unsigned long)log_dump_csv(region, csv), argv[2]);
+    fclose(csv);
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * \file        weighting_test.c
+ * \brief       Host check of the A and C weighting filters against the class 1 tolerances, and their throughput.
+ * \details     For each sample rate with coefficients, tones at the exact nominal frequencies of
+ *              one-third octaves from 10 Hz to 20 kHz go through weighting_init()/weighting_process()
+ *              in blocks of the microphone. The gain is measured on whole periods after the filter
+ *              settles (the amplitude of the bin of the tone), and its deviation from the design
+ *              goal of IEC 61672-1 Annex E is checked against the class 1 limits of its table 3.
+ *              Then reports cycles (or ns without a cycle counter) per sample of each curve.
+ *              The exit status is the number of frequencies out of tolerance.
+ *
+ *              gcc -O2 -Wall -I../../src -o weighting_test weighting_test.c ../../src/weighting.c -lm
+ *              ./weighting_test
+ * \author      MST_CDA
+ * \version     0.0.1
+ * \date        17/10/2026
+ * \copyright   Unlicensed
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "weighting.h"
+
+#define TEST_BLOCK 600          ///< MPHONE_BLOCK_SIZE: the filter runs on the blocks of the DMA
+#define TEST_AMPLITUDE 30000.0  ///< Q(SPL_AC_Q) codes, below the saturation of spl_remove_dc()
+#define TEST_SETTLE_S 0.5       ///< Transient of the 20.6 Hz poles, not measured
+#define TEST_MEASURE_S 0.5      ///< At least, rounded up to whole periods
+#define TEST_BENCH_S 4          ///< Samples of noise of the throughput, in seconds
+
+static const uint32_t test_rates[] = {48000, 44100};
+
+/**
+ * @brief Class 1 limits of IEC 61672-1:2013 table 3 at the nominal one-third octaves, in dB.
+ * INFINITY: no limit.
+ *
+ */
+static const struct{
+    double nominal;
+    double upper;
+    double lower;
+}test_limits[] = {
+    {10, 3.5, INFINITY}, {12.5, 3.0, INFINITY}, {16, 2.5, 4.5}, {20, 2.5, 2.5}, {25, 2.0, 2.0},
+    {31.5, 1.5, 1.5}, {40, 1.0, 1.0}, {50, 1.0, 1.0}, {63, 1.0, 1.0}, {80, 1.0, 1.0},
+    {100, 1.0, 1.0}, {125, 1.0, 1.0}, {160, 1.0, 1.0}, {200, 1.0, 1.0}, {250, 1.0, 1.0},
+    {315, 1.0, 1.0}, {400, 1.0, 1.0}, {500, 1.0, 1.0}, {630, 1.0, 1.0}, {800, 1.0, 1.0},
+    {1000, 0.7, 0.7}, {1250, 1.0, 1.0}, {1600, 1.0, 1.0}, {2000, 1.0, 1.0}, {2500, 1.0, 1.0},
+    {3150, 1.0, 1.0}, {4000, 1.0, 1.0}, {5000, 1.5, 1.5}, {6300, 1.5, 2.0}, {8000, 1.5, 2.5},
+    {10000, 2.0, 3.0}, {12500, 2.0, 5.0}, {16000, 2.5, 16.0}, {20000, 3.0, INFINITY},
+};
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return (uint64_t)hi << 32 | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000000u + ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Design goal of the curve (IEC 61672-1 Annex E), 0 dB at 1 kHz.
+ *
+ */
+static double goal_db(weighting_curve_t curve, double f)
+{
+    const double f1 = 20.598997, f2 = 107.65265, f3 = 737.86223, f4 = 12194.217;
+    double f_2 = f*f;
+    double c = 20*log10(f4*f4*f_2/((f_2 + f1*f1)*(f_2 + f4*f4)));
+    if (curve == WEIGHTING_C) return c + 0.062;
+    return c + 20*log10(f_2/sqrt((f_2 + f2*f2)*(f_2 + f3*f3))) + 2.000;
+}
+
+/**
+ * @brief Gain of the filter for a tone: amplitude of its bin on whole periods after the transient.
+ *
+ */
+static double measure_db(weighting_curve_t curve, uint32_t fs, double f)
+{
+    weighting_t w;
+    if (!weighting_init(&w, curve, fs)) return NAN;
+    uint32_t settle = (uint32_t)(TEST_SETTLE_S*fs);
+    uint32_t measure = (uint32_t)lround(ceil(TEST_MEASURE_S*f)*fs/f);
+    double re = 0, im = 0;
+    int32_t block[TEST_BLOCK];
+    for (uint32_t start = 0; start < settle + measure; start += TEST_BLOCK) {
+        for (uint32_t i = 0; i < TEST_BLOCK; i++) block[i] = (int32_t)lround(TEST_AMPLITUDE*sin(2*M_PI*f*(start + i)/fs));
+        weighting_process(&w, block, TEST_BLOCK);
+        for (uint32_t i = 0; i < TEST_BLOCK; i++) {
+            uint32_t n = start + i;
+            if (n < settle || n >= settle + measure) continue;
+            re += block[i]*cos(2*M_PI*f*n/fs);
+            im += block[i]*sin(2*M_PI*f*n/fs);
+        }
+    }
+    return 20*log10(2*sqrt(re*re + im*im)/measure/TEST_AMPLITUDE);
+}
+
+/**
+ * @brief Deviations of a curve at a sample rate, printed per frequency.
+ *
+ * @return Frequencies out of tolerance.
+ */
+static int check_curve(weighting_curve_t curve, uint32_t fs)
+{
+    int failures = 0;
+    double worst = 0;
+    printf("%c-weighting at %u Hz\n", weighting_letter(curve), (unsigned)fs);
+    for (size_t i = 0; i < sizeof(test_limits)/sizeof(test_limits[0]); i++) {
+        double f = 1000*pow(10, (double)((int)i - 20)/10); ///< Exact frequency of the nominal one
+        double goal = goal_db(curve, f);
+        double dev = measure_db(curve, fs, f) - goal;
+        bool ok = dev <= test_limits[i].upper && dev >= -test_limits[i].lower;
+        if (!ok) failures++;
+        if (isfinite(test_limits[i].lower) && fabs(dev) > fabs(worst)) worst = dev;
+        printf("  %7.1f Hz goal %7.2f dB deviation %+6.2f dB limits +%.1f/-%.1f %s\n",
+                test_limits[i].nominal, goal, dev, test_limits[i].upper, test_limits[i].lower, ok ? "" : "FAIL");
+    }
+    printf("  worst deviation with both limits %+.2f dB, %d out of tolerance\n", worst, failures);
+    return failures;
+}
+
+/**
+ * @brief Cycles per sample of the filter on noise, in the blocks of the microphone.
+ *
+ */
+static double bench_curve(weighting_curve_t curve, uint32_t fs)
+{
+    static int32_t noise[TEST_BLOCK], block[TEST_BLOCK];
+    weighting_t w;
+    weighting_init(&w, curve, fs);
+    srand(1);
+    for (int i = 0; i < TEST_BLOCK; i++) noise[i] = rand() % 20001 - 10000;
+    uint32_t blocks = TEST_BENCH_S*fs/TEST_BLOCK;
+    uint64_t total = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        for (int i = 0; i < TEST_BLOCK; i++) block[i] = noise[i];
+        uint64_t c0 = cycles();
+        weighting_process(&w, block, TEST_BLOCK);
+        total += cycles() - c0;
+    }
+    return (double)total/((uint64_t)blocks*TEST_BLOCK);
+}
+
+int main(void)
+{
+    int failures = 0;
+    for (size_t r = 0; r < sizeof(test_rates)/sizeof(test_rates[0]); r++) {
+        failures += check_curve(WEIGHTING_A, test_rates[r]);
+        failures += check_curve(WEIGHTING_C, test_rates[r]);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char *unit = "cycles/sample";
+#else
+    const char *unit = "ns/sample";
+#endif
+    for (size_t r = 0; r < sizeof(test_rates)/sizeof(test_rates[0]); r++) {
+        for (int curve = WEIGHTING_Z; curve <= WEIGHTING_C; curve++) {
+            printf("%c-weighting at %u Hz: %6.2f %s\n", weighting_letter(curve), (unsigned)test_rates[r],
+                    bench_curve(curve, test_rates[r]), unit);
+        }
+    }
+    printf("%d frequencies out of tolerance\n", failures);
+    return failures;
+}